@@ -46,8 +46,18 @@
 #include <cstdint>
 #endif
 
+#include <atomic>
+#include <chrono>
 #include <functional>
 #include <unordered_map>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 using std::function;
 using std::unordered_map;
@@ -77,6 +87,7 @@ class provider;
 class uar;
 class umem;
 class compchannel;
+class cmd_comp;
 struct modify_action;
 struct fwd_dst_desc;
 } // namespace dcmd
@@ -91,9 +102,18 @@ class flow_rule;
 class flow_action;
 class flow_rule_ex;
 class flow_matcher;
+class flow_rule_registry;
 class pd;
 class td;
 class uar_collection;
+class umem_arena;
+class mkey_cache;
+class umr_queue;
+class cmd_engine;
+class rss_table;
+class flow_table_switch;
+class flow_counter_bulk;
+class index_allocator;
 struct flow_table_attr;
 struct flow_group_attr;
 struct flow_rule_attr_ex;
@@ -196,6 +216,20 @@ public:
      * @retval Returns DPCP_OK on success.
      */
     status query(void* in, size_t in_sz, void* out, size_t& out_sz);
+    /**
+     * @brief Submits query of object to HW without waiting for the response
+     *
+     * @param [in]  in              Pointer to input structure describing object
+     * @param [in]  in_sz           Size of input structure in bytes
+     * @param [out] out             Buffer for operation result, valid after completion
+     *                              of @a cookie was polled from @a engine
+     * @param [in]  out_sz          Size of output buffer
+     * @param [in]  engine          Engine to complete query on
+     * @param [in]  cookie          Value returned by cmd_engine::poll() on completion
+     * @retval Returns DPCP_OK on success.
+     */
+    status query_async(void* in, size_t in_sz, void* out, size_t out_sz, cmd_engine& engine,
+                       uint64_t cookie);
     virtual status destroy();
 };
 
@@ -232,7 +266,8 @@ typedef dcmd::uar* uar;
 
 enum mkey_flags {
     MKEY_NONE = 0, // dummy flag
-    MKEY_ZERO_BASED = 1 << 0 // mkey address space starts at 0
+    MKEY_ZERO_BASED = 1 << 0, // mkey address space starts at 0
+    MKEY_UMR_ENABLED = 1 << 1 // klm_mkey translation can be modified by umr_queue
 };
 
 class mkey : public obj {
@@ -446,6 +481,95 @@ public:
     virtual status get_id(uint32_t& id); // override;
 };
 
+/**
+ * @brief struct klm_mkey_entry - Memory region of klm_mkey entry
+ *
+ */
+struct klm_mkey_entry {
+    mkey* m_key; // Memory Key the region belongs to
+    void* m_address; // Region address in the Memory Key address space
+    size_t m_length;
+};
+/**
+ * @brief class klm_mkey - Represent indirect Memory Key stitching arbitrary list of
+ * memory regions into one virtually contiguous memory region
+ *
+ * Entries of the same power of 2 size, not less than page, are translated by KSM,
+ * other lists by KLM.
+ *
+ * Application can create a dpcp::klm_mkey only via dpcp::adapter->create_klm_mkey().
+ */
+class klm_mkey : public indirect_mkey {
+    friend class adapter;
+    friend class umr_queue;
+    adapter* m_adapter;
+    std::vector<klm_mkey_entry> m_entries;
+    std::vector<mkey*> m_mkeys;
+    void* m_address;
+    size_t m_length;
+    mkey_flags m_flags;
+    uint32_t m_idx; // memory key index
+    uint32_t m_log_entity_sz; // KSM entity size, 0 for KLM
+
+public:
+    enum {
+        UMR_MAX_ENTRIES = 52 /**< Max entries of UMR inline translation and UMR enabled mkey */
+    };
+
+    klm_mkey(adapter* ad, void* addr, mkey_flags flags, size_t entries_num,
+             const klm_mkey_entry* entries);
+    virtual ~klm_mkey();
+    /**
+     * @brief Creates Memory Key
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status create();
+    /**
+     * @brief Returns virtual address of memory region.
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_address(void*& address); // override;
+    /**
+     * @brief Returns length of memory region, sum of entries length
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_length(size_t& len);
+    /**
+     * @brief Returns memory region flags
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_flags(mkey_flags& flags);
+    /**
+     * @brief Returns number of entries
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_mkeys_num(size_t& mkeys_num);
+    /**
+     * @brief Returns array of entries memory keys
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_mkeys_lst(mkey*& arr);
+    /**
+     * @brief Returns MKEY ID created by create()
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status get_id(uint32_t& id); // override;
+    /**
+     * @brief Returns true if entries are translated by KSM
+     */
+    inline bool is_ksm() const
+    {
+        return 0 != m_log_entity_sz;
+    }
+};
+
 enum reserved_mkey_type { MKEY_RESERVED_NONE = 0, MKEY_RESERVED_DUMP_AND_FILL = 1 };
 
 class reserved_mkey : public mkey {
@@ -688,6 +812,108 @@ public:
     status flush(cq& for_cq);
 };
 
+/*
+ * Helpers shared by the inline data path classes below (CQ poller, WQE builders).
+ * All HW descriptors are big-endian, so the byte swap is a no-op on BE hosts.
+ */
+inline uint16_t swap_be16(uint16_t val)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    return val;
+#elif defined(_MSC_VER)
+    return _byteswap_ushort(val);
+#else
+    return __builtin_bswap16(val);
+#endif
+}
+
+inline uint32_t swap_be32(uint32_t val)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    return val;
+#elif defined(_MSC_VER)
+    return _byteswap_ulong(val);
+#else
+    return __builtin_bswap32(val);
+#endif
+}
+
+inline uint64_t swap_be64(uint64_t val)
+{
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    return val;
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(val);
+#else
+    return __builtin_bswap64(val);
+#endif
+}
+
+/**
+ * @brief Orders reads of memory written by the device (e.g. CQE owner bit
+ * before the CQE body).
+ */
+inline void dma_rmb()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    asm volatile("" ::: "memory");
+#elif defined(__aarch64__)
+    asm volatile("dmb oshld" ::: "memory");
+#elif defined(_MSC_VER)
+    _ReadBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+/**
+ * @brief Orders writes to memory read by the device (e.g. WQE body before the
+ * DoorBell record).
+ */
+inline void dma_wmb()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    asm volatile("" ::: "memory");
+#elif defined(__aarch64__)
+    asm volatile("dmb oshst" ::: "memory");
+#elif defined(_MSC_VER)
+    _WriteBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+/**
+ * @brief Flushes posted MMIO writes (e.g. UAR/BlueFlame DoorBell).
+ */
+inline void mmio_wmb()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    asm volatile("sfence" ::: "memory");
+#elif defined(__aarch64__)
+    asm volatile("dsb st" ::: "memory");
+#elif defined(_MSC_VER)
+    _mm_sfence();
+#else
+    __sync_synchronize();
+#endif
+}
+
+/**
+ * @brief enum ring_alloc_mode - Memory backing CQ, RQ and SQ ring buffers
+ *
+ * Huge page modes fall back to regular pages when huge pages are not available.
+ * A ring is rounded up to whole huge pages, so huge pages back only rings of
+ * at least half the huge page size, smaller rings use regular pages.
+ * Small rings share huge pages through @ref adapter::enable_umem_arena with
+ * chunk of at least half the huge page size.
+ */
+enum ring_alloc_mode {
+    RING_ALLOC_DEFAULT = 0, /**< Regular pages */
+    RING_ALLOC_HUGEPAGE_2M, /**< 2MB huge pages */
+    RING_ALLOC_HUGEPAGE_1G, /**< 1GB huge pages */
+};
+
 /**
  * @brief enum cq_attr_use - set name for attributes which are valid and to be
  * used or modified
@@ -721,9 +947,24 @@ enum cq_flags {
     ATTR_CQ_PERIOD_MODE_FLAG, /**< 0: upon_event - cq_period timer restarts upon
                               event generation. 1: upon_cqe - cq_period timer
                               restarts upon completion generation */
+    ATTR_CQ_CQE_COMPRESSION_FLAG, /**< When set, HW may compress several CQEs
+                                  into mini CQEs, see cq_attr::mini_cqe_format.
+                                  cq_poller expands them back in place */
     ATTR_CQ_MAX_CNT_FLAG
 };
 
+/**
+ * @brief enum cq_mini_cqe_format - Content of mini CQE besides byte count,
+ * used with ATTR_CQ_CQE_COMPRESSION_FLAG
+ *
+ */
+enum cq_mini_cqe_format {
+    CQ_MINI_CQE_FORMAT_HASH = 0x0, /**< RSS hash result */
+    CQ_MINI_CQE_FORMAT_CSUM = 0x1, /**< Checksum */
+    CQ_MINI_CQE_FORMAT_CSUM_STRIDX = 0x3 /**< Checksum and stride index, requires
+                                           mini_cqe_resp_stride_index capability */
+};
+
 /**
  * @brief struct cq_moderation - Describes CQ Moderation attributes, (PRM,
  * sec.8.19.10, Table 171)
@@ -747,6 +988,8 @@ struct cq_attr {
     std::bitset<ATTR_CQ_MAX_CNT_FLAG> flags; /**< CQ flags */
     std::bitset<CQ_ATTR_MAX_CNT> cq_attr_use; /**< OR'd mask of attribute types
                                  which should be applied and use */
+    uint8_t mini_cqe_format; /**< Mini CQE format @ref cq_mini_cqe_format,
+                                valid with ATTR_CQ_CQE_COMPRESSION_FLAG */
 };
 
 #if !defined(__linux__)
@@ -784,6 +1027,10 @@ class cq : public obj {
 
     size_t m_cqe_num; // Number of CQEs in CQ, must be power of 2
     uint32_t m_cq_buf_sz_bytes; // CQ size in bytes, must be power of 2
+    size_t m_cq_buf_map_sz; // Page allocation size, 0 for heap allocation
+    umem_arena* m_arena; // Owner of CQ buffer and DoorBell record UMEM if set
+    uint64_t m_cq_buf_umem_offset;
+    uint64_t m_db_rec_umem_offset;
     uint32_t m_cq_buf_umem_id;
     uint32_t m_db_rec_umem_id;
     uint32_t m_cqn;
@@ -797,6 +1044,7 @@ class cq : public obj {
     status release_cq_buf(void* buf);
     status allocate_db_rec(uint32_t*& db_rec, size_t& sz);
     status release_db_rec(uint32_t* db_rec);
+    status alloc_from_arena(umem_arena* arena);
 
 public:
     virtual ~cq();
@@ -846,10 +1094,319 @@ public:
     {
         return m_cq_buf_sz_bytes;
     }
+    /**
+     * @brief Returns mini CQE format if CQE compression is enabled
+     *
+     * @retval Returns @ref cq_mini_cqe_format value.
+     */
+    inline uint8_t get_mini_cqe_format() const
+    {
+        return m_user_attr.mini_cqe_format;
+    }
 
     virtual status destroy();
 };
 
+/**
+ * @brief struct cqe64 - 64 bytes Completion Queue Element layout (PRM, CQE format)
+ *
+ * All multi-byte fields are big-endian as written by HW.
+ */
+struct cqe64 {
+    uint8_t tunneled_etc;
+    uint8_t rsvd0;
+    uint16_t wqe_id; /**< Striding RQ: index of the WQE */
+    uint8_t lro_tcppsh_abort_dupack;
+    uint8_t lro_min_ttl;
+    uint16_t lro_tcp_win;
+    uint32_t lro_ack_seq_num;
+    uint32_t rss_hash_result;
+    uint8_t rss_hash_type;
+    uint8_t ml_path;
+    uint8_t rsvd20[2];
+    uint16_t check_sum;
+    uint16_t slid;
+    uint32_t flags_rqpn;
+    uint8_t hds_ip_ext;
+    uint8_t l4_hdr_type_etc;
+    uint16_t vlan_info;
+    uint32_t srqn; /**< [31:24]: lro_num_seg, [23:0]: srqn */
+    uint32_t imm_inval_pkey;
+    uint8_t rsvd40[4];
+    uint32_t byte_cnt;
+    uint64_t timestamp;
+    uint32_t sop_drop_qpn;
+    uint16_t wqe_counter; /**< Striding RQ: index of the first consumed stride */
+    uint8_t signature;
+    uint8_t op_own;
+};
+
+static_assert(sizeof(cqe64) == CQE_SIZE, "cqe64 layout must match CQE_SIZE");
+
+/**
+ * @brief struct mini_cqe8 - Mini CQE of compressed CQE session, 8 of them
+ * share one CQE slot. All fields are big-endian.
+ */
+struct mini_cqe8 {
+    union {
+        uint32_t rx_hash_result; /**< CQ_MINI_CQE_FORMAT_HASH */
+        uint16_t checksum_stridx[2]; /**< CQ_MINI_CQE_FORMAT_CSUM(_STRIDX):
+                                        [0] checksum, [1] stride index */
+    };
+    uint32_t byte_cnt;
+};
+
+static constexpr uint32_t MINI_CQE_ARRAY_SIZE = CQE_SIZE / sizeof(mini_cqe8);
+
+/**
+ * @brief enum cqe_opcode - CQE opcode, stored in cqe64::op_own[7:4]
+ *
+ */
+enum cqe_opcode {
+    CQE_OPCODE_REQ = 0x0, /**< Send completion */
+    CQE_OPCODE_RESP_WR_IMM = 0x1,
+    CQE_OPCODE_RESP_SEND = 0x2, /**< Receive completion */
+    CQE_OPCODE_RESP_SEND_IMM = 0x3,
+    CQE_OPCODE_RESP_SEND_INV = 0x4,
+    CQE_OPCODE_RESIZE_CQ = 0x5,
+    CQE_OPCODE_REQ_ERR = 0xd, /**< Send completion with error */
+    CQE_OPCODE_RESP_ERR = 0xe, /**< Receive completion with error */
+    CQE_OPCODE_INVALID = 0xf /**< CQE was not written by HW yet */
+};
+
+enum {
+    CQE_OWNER_MASK = 0x1,
+    CQE_FORMAT_MASK = 0xc, /**< cqe64::op_own[3:2] */
+    CQE_FORMAT_COMPRESSED = 0xc, /**< Title CQE of compressed session */
+    CQE_STRIDES_MASK = 0x3fff0000, /**< Striding RQ: consumed strides in byte_cnt */
+    CQE_STRIDES_SHIFT = 16,
+    CQE_L2_OK = (1 << 0), /**< cqe64::hds_ip_ext bits */
+    CQE_L3_OK = (1 << 1),
+    CQE_L4_OK = (1 << 2),
+    CQE_VLAN_STRIPPED = (1 << 0), /**< cqe64::l4_hdr_type_etc bit */
+    CQE_FLOW_TAG_MASK = 0xffffff
+};
+
+/**
+ * @brief struct cq_completion - Decoded CQE in host byte order
+ *
+ */
+struct cq_completion {
+    uint64_t timestamp; /**< Raw HW timestamp */
+    uint32_t byte_cnt; /**< Byte count, for Striding RQ includes stride count */
+    uint32_t flow_tag; /**< Flow tag set by flow_action_tag */
+    uint32_t rss_hash; /**< RSS hash result */
+    uint16_t wqe_counter; /**< Index of the completed WQE, Striding RQ: first stride index */
+    uint16_t wqe_id; /**< Striding RQ: index of the WQE */
+    uint16_t vlan_tci; /**< Stripped VLAN tag, valid with CQE_VLAN_STRIPPED */
+    uint8_t opcode; /**< One of cqe_opcode */
+    uint8_t ip_ext; /**< CQE_L2_OK/CQE_L3_OK/CQE_L4_OK flags */
+    uint8_t l4_hdr_type_etc; /**< L3/L4 header types and CQE_VLAN_STRIPPED */
+    uint8_t rss_hash_type;
+    uint8_t syndrome; /**< Error syndrome, valid for error opcodes only */
+    uint8_t vendor_syndrome; /**< Vendor error syndrome, valid for error opcodes only */
+};
+
+/**
+ * @brief class cq_poller - Inline poller of the cq ring, only expansion of compressed
+ * CQE sessions is done out of line
+ *
+ * Tracks the consumer index and ownership bit of a cq returned by
+ * adapter::create_cq() and updates CQ DoorBell record once per polled burst.
+ * Poller is not thread safe, each cq should be polled by a single thread.
+ */
+class cq_poller {
+    cqe64* m_cqes;
+    volatile uint32_t* m_db_rec;
+    uint32_t m_cqe_mask;
+    uint32_t m_log_cqe_num;
+    uint32_t m_ci;
+    uint8_t m_mini_cqe_format;
+    bool m_striding_rq;
+
+public:
+    cq_poller()
+        : m_cqes(nullptr)
+        , m_db_rec(nullptr)
+        , m_cqe_mask(0)
+        , m_log_cqe_num(0)
+        , m_ci(0)
+        , m_mini_cqe_format(CQ_MINI_CQE_FORMAT_HASH)
+        , m_striding_rq(false)
+    {
+    }
+    /**
+     * @brief Attaches poller to the created cq
+     * @param [in] cq_obj      CQ to poll
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(cq& cq_obj)
+    {
+        void* buf = nullptr;
+        uint32_t* db_rec = nullptr;
+        uint32_t cqe_num = 0;
+
+        status ret = cq_obj.get_cq_buf(buf);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = cq_obj.get_dbrec(db_rec);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = cq_obj.get_cqe_num(cqe_num);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        return init(buf, db_rec, cqe_num, cq_obj.get_mini_cqe_format());
+    }
+    /**
+     * @brief Attaches poller to raw CQ ring
+     * @param [in] cq_buf      CQ buffer, cqe_num CQEs of CQE_SIZE bytes
+     * @param [in] db_rec      CQ DoorBell record
+     * @param [in] cqe_num     Number of CQEs, must be power of 2
+     * @param [in] mini_cqe_format  Mini CQE format if CQE compression is enabled
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(void* cq_buf, uint32_t* db_rec, uint32_t cqe_num,
+                       uint8_t mini_cqe_format = CQ_MINI_CQE_FORMAT_HASH)
+    {
+        if (nullptr == cq_buf || nullptr == db_rec || 0 == cqe_num ||
+            (cqe_num & (cqe_num - 1))) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        m_cqes = (cqe64*)cq_buf;
+        m_db_rec = db_rec;
+        m_cqe_mask = cqe_num - 1;
+        m_log_cqe_num = 0;
+        while ((1U << m_log_cqe_num) < cqe_num) {
+            m_log_cqe_num++;
+        }
+        m_ci = 0;
+        m_mini_cqe_format = mini_cqe_format;
+        return DPCP_OK;
+    }
+    /**
+     * @brief Tells that the CQ serves Striding RQ. Needed only to restore
+     * stride indexes of compressed CQEs without CQ_MINI_CQE_FORMAT_CSUM_STRIDX
+     * @param [in] striding_rq      True for Striding RQ
+     */
+    inline void set_striding_rq(bool striding_rq)
+    {
+        m_striding_rq = striding_rq;
+    }
+    /**
+     * @brief Returns next CQE owned by SW without consuming it
+     *
+     * @retval Returns CQE pointer or nullptr if CQ is empty.
+     */
+    inline cqe64* peek() const
+    {
+        cqe64* cqe = m_cqes + (m_ci & m_cqe_mask);
+        uint8_t op_own = cqe->op_own;
+        // HW flips the ownership bit on each pass over the ring
+        if (((op_own ^ (m_ci >> m_log_cqe_num)) & CQE_OWNER_MASK) ||
+            (CQE_OPCODE_INVALID == (op_own >> 4))) {
+            return nullptr;
+        }
+        // Do not read CQE body before ownership check
+        dma_rmb();
+        if (CQE_FORMAT_COMPRESSED == (op_own & CQE_FORMAT_MASK)) {
+            decompress(m_cqes, m_log_cqe_num, m_ci, m_mini_cqe_format, m_striding_rq);
+        }
+        return cqe;
+    }
+    /**
+     * @brief Expands compressed CQE session in place, so each session CQE slot
+     * holds a regular CQE owned by SW
+     * @param [in] cqes            CQ buffer
+     * @param [in] log_cqe_num     Log2 of CQEs number
+     * @param [in] ci              Consumer index of the session title CQE
+     * @param [in] mini_cqe_format Mini CQE format @ref cq_mini_cqe_format
+     * @param [in] striding_rq     True if CQ serves Striding RQ
+     *
+     * @retval Returns number of CQEs in the session.
+     */
+    static uint32_t decompress(cqe64* cqes, uint32_t log_cqe_num, uint32_t ci,
+                               uint8_t mini_cqe_format, bool striding_rq);
+    /**
+     * @brief Advances consumer index, DoorBell record is not updated
+     * @param [in] num      Number of consumed CQEs
+     */
+    inline void consume(uint32_t num = 1)
+    {
+        m_ci += num;
+    }
+    /**
+     * @brief Publishes consumer index to HW via CQ DoorBell record
+     */
+    inline void update_dbrec()
+    {
+        // CQEs must be read before HW may reuse them
+        dma_wmb();
+        *m_db_rec = swap_be32(m_ci & 0xffffff);
+    }
+    /**
+     * @brief Polls up to num CQEs and updates DoorBell record once
+     * @param [out] comps      Array of at least num decoded completions
+     * @param [in]  num        Max number of completions to poll
+     *
+     * @retval Returns number of polled completions.
+     */
+    inline uint32_t poll(cq_completion* comps, uint32_t num)
+    {
+        uint32_t polled = 0;
+        cqe64* cqe;
+
+        while (polled < num && (cqe = peek())) {
+            decode(*cqe, comps[polled++]);
+            m_ci++;
+        }
+        if (polled) {
+            update_dbrec();
+        }
+        return polled;
+    }
+    /**
+     * @brief Decodes CQE to host byte order completion
+     * @param [in]  cqe        CQE owned by SW
+     * @param [out] comp       Decoded completion
+     */
+    static inline void decode(const cqe64& cqe, cq_completion& comp)
+    {
+        comp.opcode = cqe.op_own >> 4;
+        comp.wqe_counter = swap_be16(cqe.wqe_counter);
+        comp.timestamp = swap_be64(cqe.timestamp);
+        comp.byte_cnt = swap_be32(cqe.byte_cnt);
+        comp.flow_tag = swap_be32(cqe.sop_drop_qpn) & CQE_FLOW_TAG_MASK;
+        comp.rss_hash = swap_be32(cqe.rss_hash_result);
+        comp.wqe_id = swap_be16(cqe.wqe_id);
+        comp.vlan_tci = swap_be16(cqe.vlan_info);
+        comp.ip_ext = cqe.hds_ip_ext;
+        comp.l4_hdr_type_etc = cqe.l4_hdr_type_etc;
+        comp.rss_hash_type = cqe.rss_hash_type;
+        comp.syndrome = 0;
+        comp.vendor_syndrome = 0;
+        if (comp.opcode == CQE_OPCODE_REQ_ERR || comp.opcode == CQE_OPCODE_RESP_ERR) {
+            // Error CQE reuses timestamp bytes for syndromes
+            const uint8_t* raw = (const uint8_t*)&cqe;
+            comp.vendor_syndrome = raw[54];
+            comp.syndrome = raw[55];
+        }
+    }
+    /**
+     * @brief Returns current consumer index
+     *
+     * @retval Returns consumer index.
+     */
+    inline uint32_t get_ci() const
+    {
+        return m_ci;
+    }
+};
+
 enum rq_state {
     RQ_RST = 0x0, /**< RQ in reset state */
     RQ_RDY = 0x1, /**< RQ in ready state */
@@ -908,6 +1465,16 @@ public:
      * @retval Returns DPCP_OK on success.
      */
     virtual status modify_state(rq_state new_state);
+    /**
+     * @brief Submits state change of RQ to @a engine
+     *
+     * @param [in] new_state The requested new state
+     * @param [in] engine    Engine running the command
+     * @param [in] cookie    Value returned by cmd_engine::poll() on completion
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status modify_state_async(rq_state new_state, cmd_engine& engine, uint64_t cookie);
     virtual status get_hw_buff_stride_sz(size_t& buff_stride_sz);
     virtual status get_hw_buff_stride_num(size_t& buff_stride_num);
     virtual status get_cqn(uint32_t& cqn);
@@ -930,6 +1497,10 @@ protected:
     dcmd::umem* m_db_rec_umem;
 
     uint32_t m_wq_buf_sz_bytes;
+    size_t m_wq_buf_map_sz; // Page allocation size, 0 for heap allocation
+    umem_arena* m_arena; // Owner of WQ buffer and DoorBell record UMEM if set
+    uint64_t m_wq_buf_umem_offset;
+    uint64_t m_db_rec_umem_offset;
     uint32_t m_wq_buf_umem_id;
     uint32_t m_db_rec_umem_id;
     rq_mem_type m_mem_type;
@@ -937,6 +1508,7 @@ protected:
     basic_rq(const adapter* ad, const rq_attr& attr);
     status allocate_wq_buf(void*& buf, size_t sz);
     status allocate_db_rec(uint32_t*& db_rec, size_t& sz);
+    status alloc_from_arena(umem_arena* arena);
     status init(const uar_t* rq_uar);
 
     virtual status create() = 0;
@@ -1021,49 +1593,443 @@ public:
 };
 
 /**
- * @brief class ibq_rq - Handles IBQ ReceiveQueue
+ * @brief struct striding_rq_pkt - Packet received to Striding RQ, the data
+ * stays in the WQE strides until striding_rq_iterator::release()
  *
  */
-class ibq_rq : public rq {
-    friend class adapter;
-    adapter* m_adapter;
+struct striding_rq_pkt {
+    void* data; /**< Packet address inside the WQE buffer */
+    uint32_t len; /**< Packet length in bytes */
+    uint16_t wqe_idx; /**< Index of the WQE the packet belongs to */
+    uint16_t strides; /**< Number of strides consumed by the packet */
+    cq_completion comp; /**< Completion of the packet */
+};
 
-    dpcp_ibq_protocol m_protocol;
-    uint32_t m_mkey;
+enum {
+    CQE_MPRQ_FILLER = (1U << 31), /**< Striding RQ: filler CQE, no packet */
+    CQE_MPRQ_LEN_MASK = 0xffff /**< Striding RQ: packet length in byte_cnt */
+};
 
-    ibq_rq(adapter* ad, rq_attr& attr);
+/**
+ * @brief class striding_rq_iterator - Header only, inline consumer of Striding RQ
+ *
+ * Converts Striding RQ completions into packets pointing to the strides,
+ * counts consumed and released strides per WQE and reposts WQEs in ring order
+ * once HW consumed all their strides and application released all packets.
+ * All WQEs must be filled before init(), WQE i scatters to
+ * strides_buf + i * stride_num * stride_sz.
+ * Iterator is not thread safe.
+ */
+class striding_rq_iterator {
+    uint8_t* m_strides_buf;
+    volatile uint32_t* m_db_rec;
+    std::vector<uint32_t> m_consumed;
+    std::vector<uint32_t> m_released;
+    uint32_t m_wqe_mask;
+    uint32_t m_stride_num;
+    uint32_t m_stride_sz;
+    uint32_t m_wqe_buf_sz;
+    uint32_t m_head; // Oldest WQE not reposted yet
+
+    inline void recycle()
+    {
+        uint32_t head = m_head;
+        uint32_t idx = head & m_wqe_mask;
 
-    status create();
-    status init(dpcp_ibq_protocol protocol, uint32_t mkey);
+        while (m_consumed[idx] == m_stride_num && m_released[idx] == m_stride_num) {
+            m_consumed[idx] = 0;
+            m_released[idx] = 0;
+            idx = ++head & m_wqe_mask;
+        }
+        if (head != m_head) {
+            m_head = head;
+            post();
+        }
+    }
 
-public:
-    virtual ~ibq_rq();
-    virtual status destroy();
+    inline void post()
+    {
+        // Producer counter is all outstanding WQEs ahead of the head
+        dma_wmb();
+        *m_db_rec = swap_be32((m_head + m_wqe_mask + 1) & 0xffff);
+    }
 
+public:
+    striding_rq_iterator()
+        : m_strides_buf(nullptr)
+        , m_db_rec(nullptr)
+        , m_wqe_mask(0)
+        , m_stride_num(0)
+        , m_stride_sz(0)
+        , m_wqe_buf_sz(0)
+        , m_head(0)
+    {
+    }
     /**
-     * @brief Returns how ibq extract the sequence number from the packet
-     * @param [out] protocol      how ibq extract the sequence number from the
-     * packet
+     * @brief Attaches iterator to the created Striding RQ and posts all WQEs
+     * @param [in] srq          Striding RQ
+     * @param [in] strides_buf  Packets buffer referenced by the RQ WQEs
      *
      * @retval Returns DPCP_OK on success.
      */
-    status get_ibq_protocol(dpcp_ibq_protocol& protocol);
-
-    status get_mkey(uint32_t& mkey);
-};
-
-/**
- * @brief Represent and handles TIR object
- *
- */
-enum {
-    TIR_ATTR_EXTEND = (1 << 0), /**< Special bit to extend flags field */
-    TIR_ATTR_LRO = (1 << 1),
-    TIR_ATTR_INLINE_RQN = (1 << 2),
-    TIR_ATTR_TRANSPORT_DOMAIN = (1 << 3),
-    TIR_ATTR_TLS = (1 << 4),
+    inline status init(striding_rq& srq, void* strides_buf)
+    {
+        uint32_t* db_rec = nullptr;
+        uint32_t wqe_num = 0;
+        size_t stride_num = 0;
+        size_t stride_sz = 0;
+
+        status ret = srq.get_dbrec(db_rec);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = srq.get_wqe_num(wqe_num);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = srq.get_hw_buff_stride_num(stride_num);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = srq.get_hw_buff_stride_sz(stride_sz);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        return init(db_rec, wqe_num, (uint32_t)stride_num, (uint32_t)stride_sz, strides_buf);
+    }
+    /**
+     * @brief Attaches iterator to raw Striding RQ resources and posts all WQEs
+     * @param [in] db_rec       RQ DoorBell record
+     * @param [in] wqe_num      Number of WQEs, must be power of 2
+     * @param [in] stride_num   Number of strides in WQE
+     * @param [in] stride_sz    Stride size in bytes
+     * @param [in] strides_buf  Packets buffer referenced by the RQ WQEs
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(uint32_t* db_rec, uint32_t wqe_num, uint32_t stride_num,
+                       uint32_t stride_sz, void* strides_buf)
+    {
+        if (nullptr == db_rec || nullptr == strides_buf || 0 == wqe_num ||
+            (wqe_num & (wqe_num - 1)) || 0 == stride_num || 0 == stride_sz) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        m_strides_buf = (uint8_t*)strides_buf;
+        m_db_rec = db_rec;
+        m_consumed.assign(wqe_num, 0);
+        m_released.assign(wqe_num, 0);
+        m_wqe_mask = wqe_num - 1;
+        m_stride_num = stride_num;
+        m_stride_sz = stride_sz;
+        m_wqe_buf_sz = stride_num * stride_sz;
+        m_head = 0;
+        post();
+        return DPCP_OK;
+    }
+    /**
+     * @brief Converts RQ completion to packet
+     * @param [in]  comp       Completion polled from the RQ CQ
+     * @param [out] pkt        Packet
+     *
+     * @retval Returns true if the completion carries a packet, false for filler
+     * and error completions.
+     */
+    inline bool next(const cq_completion& comp, striding_rq_pkt& pkt)
+    {
+        if (CQE_OPCODE_RESP_ERR == comp.opcode || CQE_OPCODE_REQ_ERR == comp.opcode) {
+            return false;
+        }
+        uint16_t wqe_idx = (uint16_t)(comp.wqe_id & m_wqe_mask);
+        uint16_t strides = (uint16_t)((comp.byte_cnt & CQE_STRIDES_MASK) >> CQE_STRIDES_SHIFT);
+
+        m_consumed[wqe_idx] += strides;
+        if (comp.byte_cnt & CQE_MPRQ_FILLER) {
+            // Filler strides are not passed to application
+            m_released[wqe_idx] += strides;
+            recycle();
+            return false;
+        }
+        pkt.data = m_strides_buf + (size_t)wqe_idx * m_wqe_buf_sz +
+            (size_t)comp.wqe_counter * m_stride_sz;
+        pkt.len = comp.byte_cnt & CQE_MPRQ_LEN_MASK;
+        pkt.wqe_idx = wqe_idx;
+        pkt.strides = strides;
+        pkt.comp = comp;
+        return true;
+    }
+    /**
+     * @brief Polls CQ and converts completions to packets
+     * @param [in]  poller     Poller of the Striding RQ CQ
+     * @param [out] pkts       Array of at least num packets
+     * @param [in]  num        Max number of packets
+     *
+     * @retval Returns number of received packets.
+     */
+    inline uint32_t poll(cq_poller& poller, striding_rq_pkt* pkts, uint32_t num)
+    {
+        uint32_t pkt_num = 0;
+        uint32_t polled = 0;
+        cqe64* cqe;
+
+        while (pkt_num < num && (cqe = poller.peek())) {
+            striding_rq_pkt& pkt = pkts[pkt_num];
+            cq_poller::decode(*cqe, pkt.comp);
+            poller.consume();
+            polled++;
+            if (next(pkt.comp, pkt)) {
+                pkt_num++;
+            }
+        }
+        if (polled) {
+            poller.update_dbrec();
+        }
+        return pkt_num;
+    }
+    /**
+     * @brief Releases packet strides, WQEs whose strides are all consumed
+     * and released are reposted
+     * @param [in] pkt         Packet returned by next() or poll()
+     */
+    inline void release(const striding_rq_pkt& pkt)
+    {
+        m_released[pkt.wqe_idx] += pkt.strides;
+        recycle();
+    }
+    /**
+     * @brief Returns number of strides of WQE that are not released yet
+     * @param [in] wqe_idx     WQE index
+     *
+     * @retval Returns number of held strides.
+     */
+    inline uint32_t get_held_strides(uint16_t wqe_idx) const
+    {
+        return m_consumed[wqe_idx & m_wqe_mask] - m_released[wqe_idx & m_wqe_mask];
+    }
+    /**
+     * @brief Returns number of reposted WQEs since init()
+     *
+     * @retval Returns reposted WQEs counter.
+     */
+    inline uint32_t get_reposted() const
+    {
+        return m_head;
+    }
+};
+
+/**
+ * @brief class ibq_rq - Handles IBQ ReceiveQueue
+ *
+ */
+class ibq_rq : public rq {
+    friend class adapter;
+    adapter* m_adapter;
+
+    dpcp_ibq_protocol m_protocol;
+    uint32_t m_mkey;
+
+    ibq_rq(adapter* ad, rq_attr& attr);
+
+    status create();
+    status init(dpcp_ibq_protocol protocol, uint32_t mkey);
+
+public:
+    virtual ~ibq_rq();
+    virtual status destroy();
+
+    /**
+     * @brief Returns how ibq extract the sequence number from the packet
+     * @param [out] protocol      how ibq extract the sequence number from the
+     * packet
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_ibq_protocol(dpcp_ibq_protocol& protocol);
+
+    status get_mkey(uint32_t& mkey);
+};
+
+enum {
+    RQT_MAX_SIZE = 0x8000, /**< Max number of RQT entries */
+};
+
+/**
+ * @brief Represent and handles RQ table (RQT) object, list of RQs used by
+ *        indirect TIR to spread received packets by hash.
+ */
+class rqt : public obj {
+public:
+    /**
+     * @brief RQT Object constructor, object is initialized but not created yet
+     *
+     * @param [in]  ctx          Pointer to adapter context
+     */
+    rqt(dcmd::ctx* ctx);
+    virtual ~rqt();
+    /**
+     * @brief Create RQT object
+     *
+     * Table size is a power of 2, entry i receives packets whose hash has the low
+     * log2(size) bits equal to i. RQ numbers are repeated up to the next power of 2,
+     * so RQs from the beginning of a list of other length get more traffic.
+     *
+     * @param [in]  rqns         RQ numbers
+     * @param [in]  max_size     Maximum number of entries up to RQT_MAX_SIZE, rounded up to
+     *                           a power of 2, 0 for size of rqns
+     */
+    status create(const std::vector<uint32_t>& rqns, uint32_t max_size = 0);
+    /**
+     * @brief Replace RQ numbers of the table, repeated up to a power of 2 as on create
+     *
+     * @param [in]  rqns         RQ numbers, up to max_size entries
+     */
+    status modify(const std::vector<uint32_t>& rqns);
+    /**
+     * @brief Query RQ numbers of the table
+     */
+    status query(std::vector<uint32_t>& rqns);
+    /**
+     * @brief Get RQT Number
+     */
+    inline uint32_t get_rqtn() const
+    {
+        return m_rqtn;
+    }
+    /**
+     * @brief Get maximum number of entries
+     */
+    inline uint32_t get_max_size() const
+    {
+        return m_max_size;
+    }
+
+private:
+    uint32_t m_rqtn;
+    uint32_t m_max_size;
+};
+
+/**
+ * @brief Represent and handles TIR object
+ *
+ */
+enum {
+    TIR_ATTR_EXTEND = (1 << 0), /**< Special bit to extend flags field */
+    TIR_ATTR_LRO = (1 << 1),
+    TIR_ATTR_INLINE_RQN = (1 << 2),
+    TIR_ATTR_TRANSPORT_DOMAIN = (1 << 3),
+    TIR_ATTR_TLS = (1 << 4),
     TIR_ATTR_NVMEOTCP_ZERO_COPY = (1 << 5),
     TIR_ATTR_NVMEOTCP_CRC = (1 << 6),
+    TIR_ATTR_RSS = (1 << 7), /**< Indirect dispatch to @ref rqt by hash of the packet */
+};
+
+/**
+ * @brief TIR RSS hash function
+ */
+enum tir_hash_fn {
+    TIR_HASH_FN_NONE = 0x0,
+    TIR_HASH_FN_XOR8 = 0x1, /**< Inverted XOR8 */
+    TIR_HASH_FN_TOEPLITZ = 0x2,
+};
+
+/**
+ * @brief TIR RSS hashed packet fields
+ */
+enum tir_hash_field {
+    TIR_HASH_FIELD_SRC_IP = (1 << 0),
+    TIR_HASH_FIELD_DST_IP = (1 << 1),
+    TIR_HASH_FIELD_L4_SPORT = (1 << 2),
+    TIR_HASH_FIELD_L4_DPORT = (1 << 3),
+    TIR_HASH_FIELD_IPSEC_SPI = (1 << 4),
+};
+
+enum tir_hash_l3_type {
+    TIR_HASH_L3_IPV4 = 0x0,
+    TIR_HASH_L3_IPV6 = 0x1,
+};
+
+enum tir_hash_l4_type {
+    TIR_HASH_L4_TCP = 0x0,
+    TIR_HASH_L4_UDP = 0x1,
+};
+
+enum {
+    TIR_TOEPLITZ_KEY_SIZE = 40,
+};
+
+/**
+ * @brief Software Toeplitz hash giving the same result as TIR RSS
+ *
+ * Lets the application predict the RQ picked by @ref rqt for a flow.
+ * Fields are hashed in network byte order in the TIR order:
+ * source address, destination address, source port, destination port.
+ */
+class toeplitz_hash {
+public:
+    toeplitz_hash();
+    /**
+     * @brief Precomputes lookup tables for @a key
+     *
+     * @param [in]  key          Toeplitz key, as in tir::attr::rss::toeplitz_key
+     * @param [in]  key_len      Key length in bytes
+     *
+     * @retval Returns DPCP_OK on success
+     */
+    status init(const uint8_t* key, size_t key_len = TIR_TOEPLITZ_KEY_SIZE);
+    /**
+     * @brief Hashes @a len bytes of @a data, up to get_max_len()
+     *
+     * Uses carry-less multiply when CPU supports it, lookup table otherwise.
+     */
+    uint32_t hash(const uint8_t* data, size_t len) const;
+    /**
+     * @brief Hashes @a data using byte lookup table only
+     */
+    uint32_t hash_lut(const uint8_t* data, size_t len) const;
+    /**
+     * @brief Hashes IPv4 tuple, all values in network byte order
+     *
+     * @param [in]  fields       Bitmask of @ref tir_hash_field as in TIR
+     */
+    uint32_t hash_ipv4(uint32_t src_ip, uint32_t dst_ip, uint16_t sport, uint16_t dport,
+                       uint32_t fields) const;
+    /**
+     * @brief Hashes IPv6 tuple, all values in network byte order
+     */
+    uint32_t hash_ipv6(const uint8_t* src_ip, const uint8_t* dst_ip, uint16_t sport,
+                       uint16_t dport, uint32_t fields) const;
+    /**
+     * @brief Max number of input bytes covered by the key
+     */
+    inline size_t get_max_len() const
+    {
+        return m_max_len;
+    }
+    /**
+     * @brief Returns true if carry-less multiply path is used
+     */
+    inline bool is_accelerated() const
+    {
+        return m_clmul;
+    }
+    /**
+     * @brief Reference bit by bit implementation
+     */
+    static uint32_t hash_generic(const uint8_t* key, size_t key_len, const uint8_t* data,
+                                 size_t len);
+    /**
+     * @brief Fills @a key with repeated 16 bit @a pattern
+     *
+     * Such key gives same hash after swapping addresses and ports,
+     * so both directions of a connection land on the same RQ.
+     */
+    static void make_symmetric_key(uint8_t* key, size_t key_len = TIR_TOEPLITZ_KEY_SIZE,
+                                   uint16_t pattern = 0x6d5a);
+
+private:
+    std::vector<uint32_t> m_lut; /**< 256 entries per input byte */
+    std::vector<uint64_t> m_clmul_keys; /**< Bit reversed key window per input dword */
+    size_t m_max_len;
+    bool m_clmul;
 };
 
 class tir : public forwardable_obj {
@@ -1083,6 +2049,15 @@ public:
             uint32_t crc_en : 1;
             uint32_t tag_buffer_table_id;
         } nvmeotcp;
+        struct {
+            uint32_t indirect_table : 24; /**< RQT number @ref rqt::get_rqtn */
+            uint32_t hash_fn : 4; /**< @ref tir_hash_fn */
+            uint32_t symmetric : 1; /**< Same hash for both directions of a flow */
+            uint32_t l3_prot_type : 1; /**< @ref tir_hash_l3_type */
+            uint32_t l4_prot_type : 1; /**< @ref tir_hash_l4_type */
+            uint32_t selected_fields; /**< Bitmask of @ref tir_hash_field */
+            uint8_t toeplitz_key[TIR_TOEPLITZ_KEY_SIZE];
+        } rss;
     };
 
 public:
@@ -1100,6 +2075,14 @@ public:
      * @param [in]  tir_attr     Object attributies
      */
     status create(const tir::attr& tir_attr);
+    /**
+     * @brief Submits creation of TIR object to @a engine
+     *
+     * @param [in]  tir_attr     Object attributies
+     * @param [in]  engine       Engine running the command
+     * @param [in]  cookie       Value returned by cmd_engine::poll() on completion
+     */
+    status create_async(const tir::attr& tir_attr, cmd_engine& engine, uint64_t cookie);
     /**
      * @brief Modify TIR object in HW
      */
@@ -1367,7 +2350,25 @@ public:
      *
      * @retval Returns @ref dpcp::status with the status code.
      */
-    status remove_flow_group(std::weak_ptr<flow_group>& group);
+    virtual status remove_flow_group(std::weak_ptr<flow_group>& group);
+    /**
+     * @brief Get number of flow indexes taken by flow groups.
+     *
+     * @param [out] used: flow indexes of the table taken by flow groups.
+     * @param [out] size: number of flow indexes in the table.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    virtual status get_occupancy(uint32_t& used, uint32_t& size) const;
+    /**
+     * @brief Redirect packets missed all rules of created flow table.
+     *
+     * @param [in] table: Flow table to forward missed packets to, nullptr
+     *                    restores default miss action.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    virtual status set_table_miss(std::shared_ptr<flow_table> table);
     /**
      * @brief Get forward type
      */
@@ -1467,6 +2468,8 @@ enum flow_group_match_criteria_enable {
 struct flow_group_attr {
     uint32_t start_flow_index; /**< The first flow rule included in the group.*/
     uint32_t end_flow_index; /**< The last flow rule included in the group.*/
+    uint32_t num_flows; /**< If not 0 the flow table places a group of num_flows rules,
+                             start_flow_index and end_flow_index are ignored. */
     uint8_t match_criteria_enable; /**< Bit-mask representing which of the headers and parameters in
                                         match_criteria are used in defining the Flow,
                                         @ref flow_group_match_criteria_enable. */
@@ -1476,6 +2479,7 @@ struct flow_group_attr {
     flow_group_attr()
         : start_flow_index(0)
         , end_flow_index(0)
+        , num_flows(0)
         , match_criteria_enable(0)
     {
     }
@@ -1497,7 +2501,7 @@ protected:
     flow_group_attr m_attr;
     std::weak_ptr<const flow_table> m_table;
     bool m_is_initialized;
-    std::unordered_set<std::shared_ptr<flow_rule_ex>> m_rules;
+    std::shared_ptr<flow_rule_registry> m_rules; /**< Rules of the group indexed by match value */
     std::shared_ptr<flow_matcher> m_matcher;
 
 public:
@@ -1540,10 +2544,26 @@ public:
      * @param [in] attr: flow rule attr.
      * @param [out] rule: flow rule object.
      *
+     * @note: Match value of the rule should be unique in the group, in groups of kernel
+     *        tables match value and priority of the rule.
+     *
      * @retval Returns @ref dpcp::status with the status code.
      */
     virtual status add_flow_rule(const flow_rule_attr_ex& attr,
                                  std::weak_ptr<flow_rule_ex>& rule) = 0;
+    /**
+     * @brief Add batch of flow rules to group and create them in HW.
+     *
+     * @param [in] attrs: flow rules attr.
+     * @param [in] num: number of flow rules in attrs.
+     * @param [out] rules: created flow rules, in order of attrs.
+     *
+     * @note: On failure none of the batch rules is left in the group.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    virtual status add_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                  std::vector<std::weak_ptr<flow_rule_ex>>& rules);
     /**
      * @brief Remove flow rule from group.
      *
@@ -1551,7 +2571,46 @@ public:
      *
      * @retval Returns @ref dpcp::status with the status code.
      */
-    status remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule);
+    virtual status remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule);
+    /**
+     * @brief Get flow indexes of the table that belong to the group.
+     *
+     * @param [out] start: first flow index of the group.
+     * @param [out] end: last flow index of the group.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    status get_flow_index_range(uint32_t& start, uint32_t& end) const;
+    /**
+     * @brief Get number of flow rules in the group.
+     *
+     * @param [out] used: flow rules in the group.
+     * @param [out] size: number of flow indexes of the group.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    status get_occupancy(uint32_t& used, uint32_t& size) const;
+    /**
+     * @brief Find flow rule by match value.
+     *
+     * @param [in] match: match value, only fields of the group match criteria are compared.
+     * @param [out] rule: flow rule.
+     * @param [in] priority: flow rule priority, compared only in groups of kernel tables.
+     *
+     * @retval Returns @ref dpcp::status with the status code,
+     *         DPCP_ERR_INVALID_PARAM if no rule of the group has the match value.
+     */
+    status find_flow_rule(const match_params_ex& match, std::weak_ptr<flow_rule_ex>& rule,
+                          uint16_t priority = 0) const;
+    /**
+     * @brief Remove flow rule by match value.
+     *
+     * @param [in] match: match value, only fields of the group match criteria are compared.
+     * @param [in] priority: flow rule priority, compared only in groups of kernel tables.
+     *
+     * @retval Returns @ref dpcp::status with the status code.
+     */
+    status remove_flow_rule_by_match(const match_params_ex& match, uint16_t priority = 0);
     /**
      * @brief Get group match criteria.
      *
@@ -1705,6 +2764,10 @@ class flow_action_generator {
 private:
     dcmd::ctx* m_ctx;
     const adapter_hca_capabilities* m_caps;
+    std::mutex m_cache_lock;
+    std::unordered_multimap<uint64_t, std::weak_ptr<flow_action>>
+        m_action_cache; /**< Shared actions, key is hash of the PRM in buffer */
+    size_t m_cache_purge_size;
 
 public:
     /**
@@ -1734,6 +2797,9 @@ public:
      * @param [in] attr: Reformat action attributes.
      *
      * @retval flow_action action pointer or nullptr.
+     *
+     * @note: Reformat actions with identical attributes share one HW object, the object is
+     *        released with the last reference. Thread-safe.
      */
     std::shared_ptr<flow_action> create_reformat(flow_action_reformat_attr& attr);
     /**
@@ -1742,6 +2808,9 @@ public:
      * @param [in] attr: Reformat action attributes.
      *
      * @retval flow_action action pointer or nullptr.
+     *
+     * @note: Modify actions with identical attributes share one HW object, the object is
+     *        released with the last reference. Thread-safe.
      */
     std::shared_ptr<flow_action> create_modify(flow_action_modify_attr& attr);
     /**
@@ -1750,10 +2819,26 @@ public:
      * @retval flow_action action pointer or nullptr.
      */
     std::shared_ptr<flow_action> create_reparse();
+    /**
+     * @brief Create flow action counter, packets matched on the flow rule are counted
+     *        by counter @a index of @a bulk.
+     *
+     * @param [in] bulk: Flow counter bulk, should be valid while the action is used.
+     * @param [in] index: Counter index in the bulk @ref flow_counter_bulk::alloc_counter.
+     *
+     * @retval flow_action action pointer or nullptr.
+     */
+    std::shared_ptr<flow_action> create_counter(flow_counter_bulk& bulk, uint32_t index);
 
 private:
     // Should be created only by @ref class adapter
     flow_action_generator(dcmd::ctx* ctx, const adapter_hca_capabilities* caps);
+    template <class FA>
+    std::shared_ptr<flow_action> get_cached_action(FA* action, status (FA::*create)());
+};
+
+enum {
+    FLOW_INDEX_AUTO = 0xFFFFFFFF /**< Flow index of the rule is chosen by the flow group */
 };
 
 /**
@@ -1764,7 +2849,8 @@ struct flow_rule_attr_ex {
     match_params_ex match_value; /*< flow rule match value, should be same fields as the masks
                                      provided to flow_group. */
     uint32_t flow_index; /*< The location of the rule on the flow table,
-                             index 0 will matched first. */
+                             index 0 will matched first, @ref FLOW_INDEX_AUTO to place
+                             the rule on a free index of the flow group. */
     std::vector<std::shared_ptr<flow_action>> actions; /* Flow actions to perform on the packet
                                                           when rule matched */
 
@@ -1782,10 +2868,14 @@ struct flow_rule_attr_ex {
  * from different threads unless thread-safety measures were taken by the application.
  */
 class flow_rule_ex : public obj {
-    typedef unordered_map<std::type_index, std::shared_ptr<flow_action>> action_map_t;
+    friend class flow_rule_registry;
+    friend class flow_table_switch;
 
 protected:
+    typedef unordered_map<std::type_index, std::shared_ptr<flow_action>> action_map_t;
+
     match_params_ex m_match_value;
+    uint16_t m_priority;
     bool m_is_initialized;
     std::weak_ptr<const flow_table> m_table;
     std::weak_ptr<const flow_group> m_group;
@@ -1830,11 +2920,32 @@ public:
      * @retval Returns DPCP_OK on success.
      */
     virtual status create() = 0;
+    /**
+     * @brief Submits creation of flow rule HW object to @a engine.
+     *
+     * @param [in] engine Engine running the command
+     * @param [in] cookie Value returned by cmd_engine::poll() on completion
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status create_async(cmd_engine& engine, uint64_t cookie);
+    /**
+     * @brief Replace flow actions of created flow rule in place.
+     *
+     * @note: The rule keeps matching packets during the update, match value and
+     *        flow index are not changed.
+     *
+     * @param [in] actions: new flow actions.
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    virtual status modify(const std::vector<std::shared_ptr<flow_action>>& actions) = 0;
     virtual ~flow_rule_ex() = default;
 
-private:
+protected:
     // Help functions
-    bool verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions);
+    bool verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions,
+                             action_map_t& action_map);
 };
 
 struct match_params {
@@ -2034,6 +3145,15 @@ public:
      */
     status create(const dek::attr& dek_attr);
 
+    /**
+     * @brief Submits creation of DEK object to @a engine
+     *
+     * @param [in] dek_attr Object attributies, the key must be valid until completion
+     * @param [in] engine   Engine running the command
+     * @param [in] cookie   Value returned by cmd_engine::poll() on completion
+     */
+    status create_async(const dek::attr& dek_attr, cmd_engine& engine, uint64_t cookie);
+
     /**
      * @brief Modify DEK object in HW
      */
@@ -2137,6 +3257,8 @@ struct flow_table_type_capabilities {
     uint32_t max_flow_table_level;
     uint8_t max_log_num_of_flow_table; /**< Maximum log number of Flow Table that can be created */
     uint8_t max_log_num_of_flow_rule; /**< Maximum log number of Flow Rules that can be created */
+    bool is_flow_action_counter_supported; /**< When set, Flow Rules can count packets with
+                                                @ref flow_counter_bulk */
     bool is_flow_action_reparse_supported; /**< When set, this Flow Table type supports Flow Table
                                                 Entries with reparse indication or Rule Table
                                                 Context(RTC) with always reparse mode.
@@ -2255,6 +3377,14 @@ typedef struct adapter_hca_capabilities {
                                                        parser_graph_node_attr.header_length_field_mask,
                                                        For example, value 5 indicates bits[4:0]
                                                        are valid*/
+    bool cqe_compression; /**< If set, CQE compression is supported */
+    bool mini_cqe_resp_stride_index; /**< If set, CQ_MINI_CQE_FORMAT_CSUM_STRIDX is supported */
+    uint16_t cqe_compression_timeout; /**< Max time in usec HW holds compressed CQE session */
+    uint16_t cqe_compression_max_num; /**< Max number of CQEs in compressed CQE session */
+    uint8_t max_lso_cap; /**< Log2 of max LSO message size, 0 if LSO is not supported */
+    bool reg_umr_sq; /**< UMR WQEs may be posted on Ethernet SQ */
+    uint8_t flow_counter_bulk_alloc; /**< Bit i is set if bulk of 128 << i flow counters is
+                                          supported */
     bool is_flow_table_caps_supported; /**< Capability to query flow table HCH.cap */
     flow_table_capabilities flow_table_caps; /**< Flow table from type receive capabilities */
     nvmeotcp_capabilities nvmeotcp_caps; /**< NVMe/TCP capabilities flags */
@@ -2284,6 +3414,7 @@ struct sq_attr {
     uint32_t wqe_num; // Number of WQEs in SQ, must be power of 2
     uint32_t wqe_sz; // WQE size, in bytes
     uint32_t user_index;
+    bool reg_umr; // Allow UMR WQEs on the SQ
 };
 
 class sq : public obj {
@@ -2303,6 +3434,16 @@ public:
      * @retval Returns DPCP_OK on success.
      */
     virtual status modify_state(sq_state new_state);
+    /**
+     * @brief Submits state change of SQ to @a engine
+     *
+     * @param [in] new_state The requested new state
+     * @param [in] engine    Engine running the command
+     * @param [in] cookie    Value returned by cmd_engine::poll() on completion
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status modify_state_async(sq_state new_state, cmd_engine& engine, uint64_t cookie);
     /**
      * @brief Returns SQ WQEe size in bytes
      * @param [out] wq_sz      SQ WQE size in bytes
@@ -2343,6 +3484,10 @@ private:
     size_t m_wqe_sz; // WQE size, i.e. number of DS (16B) in each SQ WQE, must be
                      // power of 2
     uint32_t m_wq_buf_sz_bytes;
+    size_t m_wq_buf_map_sz; // Page allocation size, 0 for heap allocation
+    umem_arena* m_arena; // Owner of WQ buffer and DoorBell record UMEM if set
+    uint64_t m_wq_buf_umem_offset;
+    uint64_t m_db_rec_umem_offset;
     uint32_t m_wq_buf_umem_id;
     uint32_t m_db_rec_umem_id;
     uint32_t m_pp_idx; // Packet Pacing index
@@ -2354,6 +3499,7 @@ private:
     status init(const uar_t* sq_uar);
     status allocate_wq_buf(void*& buf, size_t sz);
     status allocate_db_rec(uint32_t*& db_rec, size_t& sz);
+    status alloc_from_arena(umem_arena* arena);
 
 public:
     virtual ~pp_sq();
@@ -2405,21 +3551,1323 @@ public:
     virtual status destroy();
 };
 
+#define SEND_WQE_BB 64 /**< Send WQE Basic Block size in bytes */
+
 /**
- * @brief: Header tunneling type for parser graph node sampling.
- *
- * The same parser node can be used for parsing a header that
- * will be in an outer part of a tunnel or in inner of a tunnel.
- * Those are the indicators which of the options will be sampled.
+ * @brief Send WQE Control Segment
  */
-enum parse_graph_flow_match_sample_tunnel_mode {
-    PARSE_GRAPH_FLOW_MATCH_SAMPLE_TUNNEL_OUTER = 0x0, /**< The outer part of the tunneled header. */
-    PARSE_GRAPH_FLOW_MATCH_SAMPLE_TUNNEL_INNER = 0x1, /**< The inner part of the tunneled header. */
-    PARSE_GRAPH_FLOW_MATCH_SAMPLE_TUNNEL_FIRST = 0x2 /**< Not a tunneled header. */
+struct wqe_ctrl_seg {
+    uint32_t opmod_idx_opcode;
+    uint32_t qpn_ds;
+    uint8_t signature;
+    uint8_t rsvd[2];
+    uint8_t fm_ce_se;
+    uint32_t imm;
 };
 
 /**
- * @brief: Length mode of parser graph node.
+ * @brief Send WQE Ethernet Segment
+ */
+struct wqe_eth_seg {
+    uint32_t swp_offs;
+    uint8_t cs_flags;
+    uint8_t swp_flags;
+    uint16_t mss;
+    uint32_t metadata;
+    uint16_t inline_hdr_sz; // VLAN insert type for HW VLAN insertion
+    uint8_t inline_hdr[2]; // VLAN TCI for HW VLAN insertion
+};
+
+/**
+ * @brief Send WQE Data Segment
+ */
+struct wqe_data_seg {
+    uint32_t byte_count;
+    uint32_t lkey;
+    uint64_t addr;
+};
+
+enum {
+    WQE_DS_SZ = 16, /**< WQE is built of 16 bytes Data Segments (DS) */
+    WQE_DS_MAX = 63, /**< Max DS number in one WQE */
+    WQE_OPCODE_SEND = 0x0a,
+    WQE_OPCODE_TSO = 0x0e,
+    WQE_OPCODE_UMR = 0x25,
+    WQE_OPCODE_ENHANCED_MPSW = 0x29,
+    WQE_CTRL_CQ_UPDATE = (2 << 2),
+    WQE_ETH_L3_CSUM = (1 << 6),
+    WQE_ETH_L4_CSUM = (1 << 7),
+    WQE_ETH_INSERT_VLAN = (1 << 15),
+    WQE_ETH_INLINE_HDR_SZ = 18, /**< L2 header with VLAN tag */
+    WQE_ETH_VLAN_HDR_SZ = 4,
+    WQE_ETH_ADDRS_SZ = 12, /**< Destination and source MAC addresses */
+};
+
+/**
+ * @brief class wq_batch - DoorBell batching policy of sq_poster and rq_poster
+ *
+ * DoorBell is rung once batch_sz WQEs are posted, on explicit flush() or by
+ * flush_expired() when the oldest pending WQE waits longer than the timeout.
+ */
+class wq_batch {
+protected:
+    typedef std::chrono::steady_clock clock;
+
+    clock::time_point m_first_pending;
+    clock::duration m_timeout;
+    uint32_t m_batch_sz;
+    uint32_t m_pending;
+
+    wq_batch()
+        : m_first_pending()
+        , m_timeout(clock::duration::zero())
+        , m_batch_sz(1)
+        , m_pending(0)
+    {
+    }
+
+    inline status set_batch(uint32_t batch_sz, uint32_t flush_timeout_us)
+    {
+        if (0 == batch_sz) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        m_batch_sz = batch_sz;
+        m_timeout = std::chrono::microseconds(flush_timeout_us);
+        m_pending = 0;
+        return DPCP_OK;
+    }
+    /**
+     * @brief Accounts posted WQE
+     *
+     * @retval Returns true if DoorBell should be rung.
+     */
+    inline bool add_pending()
+    {
+        if (0 == m_pending && clock::duration::zero() != m_timeout) {
+            m_first_pending = clock::now();
+        }
+        return ++m_pending >= m_batch_sz;
+    }
+    inline bool is_expired() const
+    {
+        return m_pending && clock::duration::zero() != m_timeout &&
+            clock::now() - m_first_pending >= m_timeout;
+    }
+
+public:
+    /**
+     * @brief Returns number of posted WQEs not announced to HW yet
+     *
+     * @retval Returns pending WQEs number.
+     */
+    inline uint32_t get_pending() const
+    {
+        return m_pending;
+    }
+};
+
+/**
+ * @brief class sq_poster - Header only, inline poster of pp_sq WQEs
+ *
+ * WQEs are written in place at get_wqe(), post() accounts them and every
+ * batch is announced with one barrier, one DoorBell record update and one
+ * 64 bit write of the last WQE control segment to the UAR/BlueFlame register.
+ * Poster doesn't track SQ free space, use completion wqe_counter for that.
+ * Poster is not thread safe.
+ */
+class sq_poster : public wq_batch {
+    uint8_t* m_wq_buf;
+    volatile uint32_t* m_db_rec;
+    volatile uint64_t* m_bf_reg;
+    const uint64_t* m_last_ctrl;
+    uint32_t m_wqebb_mask;
+    uint32_t m_pi; // Producer index in WQEBBs
+
+public:
+    sq_poster()
+        : m_wq_buf(nullptr)
+        , m_db_rec(nullptr)
+        , m_bf_reg(nullptr)
+        , m_last_ctrl(nullptr)
+        , m_wqebb_mask(0)
+        , m_pi(0)
+    {
+    }
+    /**
+     * @brief Attaches poster to the created pp_sq
+     * @param [in] sq                Send Queue
+     * @param [in] batch_sz          Number of WQEs per DoorBell
+     * @param [in] flush_timeout_us  Max delay of pending WQEs for flush_expired(),
+     *                               0 - disabled
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(pp_sq& sq, uint32_t batch_sz = 1, uint32_t flush_timeout_us = 0)
+    {
+        void* wq_buf = nullptr;
+        uint32_t* db_rec = nullptr;
+        uint64_t* bf_reg = nullptr;
+        uint32_t wqe_num = 0;
+
+        status ret = sq.get_wq_buf(wq_buf);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = sq.get_dbrec(db_rec);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = sq.get_bf_reg(bf_reg);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = sq.get_wqe_num(wqe_num);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        // Send counter is the second word of the DoorBell record
+        return init(wq_buf, wqe_num, db_rec + 1, bf_reg, batch_sz, flush_timeout_us);
+    }
+    /**
+     * @brief Attaches poster to raw SQ resources
+     * @param [in] wq_buf            SQ buffer
+     * @param [in] wqebb_num         Number of WQEBBs in SQ, must be power of 2
+     * @param [in] db_rec            Send counter of SQ DoorBell record
+     * @param [in] bf_reg            UAR/BlueFlame register
+     * @param [in] batch_sz          Number of WQEs per DoorBell
+     * @param [in] flush_timeout_us  Max delay of pending WQEs for flush_expired(),
+     *                               0 - disabled
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(void* wq_buf, uint32_t wqebb_num, uint32_t* db_rec, uint64_t* bf_reg,
+                       uint32_t batch_sz = 1, uint32_t flush_timeout_us = 0)
+    {
+        if (nullptr == wq_buf || nullptr == db_rec || nullptr == bf_reg || 0 == wqebb_num ||
+            (wqebb_num & (wqebb_num - 1))) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        m_wq_buf = (uint8_t*)wq_buf;
+        m_db_rec = db_rec;
+        m_bf_reg = bf_reg;
+        m_last_ctrl = nullptr;
+        m_wqebb_mask = wqebb_num - 1;
+        m_pi = 0;
+        return set_batch(batch_sz, flush_timeout_us);
+    }
+    /**
+     * @brief Returns WQEBB address relative to the producer index
+     * @param [in] idx       WQEBB offset from the producer index
+     *
+     * @retval Returns WQEBB address.
+     */
+    inline void* get_wqe(uint32_t idx = 0) const
+    {
+        return m_wq_buf + (size_t)((m_pi + idx) & m_wqebb_mask) * SEND_WQE_BB;
+    }
+    /**
+     * @brief Returns 16 bytes WQE segment address relative to the producer index,
+     * wrapping around the ring
+     * @param [in] ds        Segment offset from the producer index
+     *
+     * @retval Returns segment address.
+     */
+    inline uint8_t* get_ds(uint32_t ds) const
+    {
+        return (uint8_t*)get_wqe(ds / (SEND_WQE_BB / WQE_DS_SZ)) +
+            (ds % (SEND_WQE_BB / WQE_DS_SZ)) * WQE_DS_SZ;
+    }
+    /**
+     * @brief Returns producer index in WQEBBs, used in WQE control segment
+     *
+     * @retval Returns producer index.
+     */
+    inline uint32_t get_pi() const
+    {
+        return m_pi;
+    }
+    /**
+     * @brief Returns number of WQEBBs in SQ ring
+     *
+     * @retval Returns SQ ring size in WQEBBs.
+     */
+    inline uint32_t get_wqebb_num() const
+    {
+        return m_wqebb_mask + 1;
+    }
+    /**
+     * @brief Posts WQE written at get_wqe(), rings DoorBell if batch is full
+     * @param [in] wqebb_num    Number of WQEBBs the WQE occupies
+     */
+    inline void post(uint32_t wqebb_num = 1)
+    {
+        m_last_ctrl = (const uint64_t*)get_wqe();
+        m_pi += wqebb_num;
+        if (add_pending()) {
+            flush();
+        }
+    }
+    /**
+     * @brief Rings DoorBell for all pending WQEs
+     */
+    inline void flush()
+    {
+        if (0 == m_pending) {
+            return;
+        }
+        // WQEs must be written before DoorBell record
+        dma_wmb();
+        *m_db_rec = swap_be32(m_pi & 0xffff);
+        // DoorBell record must be written before UAR
+        mmio_wmb();
+        *m_bf_reg = *m_last_ctrl;
+        mmio_wmb();
+        m_pending = 0;
+    }
+    /**
+     * @brief Rings DoorBell if pending WQEs wait longer than flush timeout.
+     * Should be called from the application idle/poll loop.
+     */
+    inline void flush_expired()
+    {
+        if (is_expired()) {
+            flush();
+        }
+    }
+};
+
+/**
+ * @brief class rq_poster - Header only, inline poster of regular_rq WQEs
+ *
+ * Same batching as sq_poster, RQ needs only DoorBell record update.
+ * Poster is not thread safe.
+ */
+class rq_poster : public wq_batch {
+    uint8_t* m_wq_buf;
+    volatile uint32_t* m_db_rec;
+    uint32_t m_wqe_mask;
+    uint32_t m_stride_sz;
+    uint32_t m_pi;
+
+public:
+    rq_poster()
+        : m_wq_buf(nullptr)
+        , m_db_rec(nullptr)
+        , m_wqe_mask(0)
+        , m_stride_sz(0)
+        , m_pi(0)
+    {
+    }
+    /**
+     * @brief Attaches poster to the created regular_rq
+     * @param [in] rq                Receive Queue
+     * @param [in] batch_sz          Number of WQEs per DoorBell
+     * @param [in] flush_timeout_us  Max delay of pending WQEs for flush_expired(),
+     *                               0 - disabled
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(regular_rq& rq, uint32_t batch_sz = 1, uint32_t flush_timeout_us = 0)
+    {
+        void* wq_buf = nullptr;
+        uint32_t* db_rec = nullptr;
+        uint32_t wqe_num = 0;
+        uint32_t stride_sz = 0;
+
+        status ret = rq.get_wq_buf(wq_buf);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = rq.get_dbrec(db_rec);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = rq.get_wqe_num(wqe_num);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        ret = rq.get_wq_stride_sz(stride_sz);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        return init(wq_buf, wqe_num, stride_sz, db_rec, batch_sz, flush_timeout_us);
+    }
+    /**
+     * @brief Attaches poster to raw RQ resources
+     * @param [in] wq_buf            RQ buffer
+     * @param [in] wqe_num           Number of WQEs in RQ, must be power of 2
+     * @param [in] stride_sz         RQ WQE size in bytes
+     * @param [in] db_rec            RQ DoorBell record
+     * @param [in] batch_sz          Number of WQEs per DoorBell
+     * @param [in] flush_timeout_us  Max delay of pending WQEs for flush_expired(),
+     *                               0 - disabled
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(void* wq_buf, uint32_t wqe_num, uint32_t stride_sz, uint32_t* db_rec,
+                       uint32_t batch_sz = 1, uint32_t flush_timeout_us = 0)
+    {
+        if (nullptr == wq_buf || nullptr == db_rec || 0 == stride_sz || 0 == wqe_num ||
+            (wqe_num & (wqe_num - 1))) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        m_wq_buf = (uint8_t*)wq_buf;
+        m_db_rec = db_rec;
+        m_wqe_mask = wqe_num - 1;
+        m_stride_sz = stride_sz;
+        m_pi = 0;
+        return set_batch(batch_sz, flush_timeout_us);
+    }
+    /**
+     * @brief Returns WQE address relative to the producer index
+     * @param [in] idx       WQE offset from the producer index
+     *
+     * @retval Returns WQE address.
+     */
+    inline void* get_wqe(uint32_t idx = 0) const
+    {
+        return m_wq_buf + (size_t)((m_pi + idx) & m_wqe_mask) * m_stride_sz;
+    }
+    /**
+     * @brief Returns producer index in WQEs
+     *
+     * @retval Returns producer index.
+     */
+    inline uint32_t get_pi() const
+    {
+        return m_pi;
+    }
+    /**
+     * @brief Posts WQE written at get_wqe(), rings DoorBell if batch is full
+     */
+    inline void post()
+    {
+        m_pi++;
+        if (add_pending()) {
+            flush();
+        }
+    }
+    /**
+     * @brief Updates DoorBell record for all pending WQEs
+     */
+    inline void flush()
+    {
+        if (0 == m_pending) {
+            return;
+        }
+        dma_wmb();
+        *m_db_rec = swap_be32(m_pi & 0xffff);
+        m_pending = 0;
+    }
+    /**
+     * @brief Updates DoorBell record if pending WQEs wait longer than flush
+     * timeout. Should be called from the application idle/poll loop.
+     */
+    inline void flush_expired()
+    {
+        if (is_expired()) {
+            flush();
+        }
+    }
+};
+
+/**
+ * @brief Fills Send WQE Control Segment
+ * @param [out] cseg     Control Segment
+ * @param [in] pi        SQ producer index of the WQE
+ * @param [in] opcode    WQE opcode
+ * @param [in] sqn       SQ number
+ * @param [in] ds        WQE size in 16 bytes segments
+ * @param [in] signal    Request CQE for the WQE
+ */
+inline void set_wqe_ctrl_seg(wqe_ctrl_seg* cseg, uint32_t pi, uint8_t opcode, uint32_t sqn,
+                             uint32_t ds, bool signal)
+{
+    cseg->opmod_idx_opcode = swap_be32(((pi & 0xffff) << 8) | opcode);
+    cseg->qpn_ds = swap_be32((sqn << 8) | ds);
+    cseg->signature = 0;
+    cseg->rsvd[0] = 0;
+    cseg->rsvd[1] = 0;
+    cseg->fm_ce_se = signal ? WQE_CTRL_CQ_UPDATE : 0;
+    cseg->imm = 0;
+}
+
+/**
+ * @brief enum eth_wqe_flags - Compile time features of eth_wqe_builder
+ */
+enum eth_wqe_flags {
+    ETH_WQE_INLINE_L2 = (1 << 0), /**< Inline L2 header into Ethernet Segment */
+    ETH_WQE_CSUM = (1 << 1), /**< L3 and L4 checksum offload */
+    ETH_WQE_VLAN_INSERT = (1 << 2), /**< Insert VLAN tag, by SW if L2 header is inlined */
+};
+
+/**
+ * @brief struct eth_wqe_sge - Packet fragment
+ */
+struct eth_wqe_sge {
+    uint64_t addr;
+    uint32_t len;
+    uint32_t lkey; /**< direct_mkey::get_id() of the registered memory */
+};
+
+/**
+ * @brief struct eth_wqe_desc - Packet to send
+ */
+struct eth_wqe_desc {
+    const eth_wqe_sge* sge;
+    uint32_t sge_num;
+    uint16_t vlan_tci;
+    bool signal; /**< Request CQE for this WQE */
+};
+
+/**
+ * @brief class eth_wqe_builder - Builds Ethernet send WQEs in place in SQ ring
+ *
+ * FLAGS is a mask of eth_wqe_flags, disabled features are compiled out.
+ * With ETH_WQE_INLINE_L2 the first sge must hold at least WQE_ETH_INLINE_HDR_SZ
+ * bytes, or WQE_ETH_ADDRS_SZ + 2 bytes with ETH_WQE_VLAN_INSERT.
+ */
+template <uint32_t FLAGS> class eth_wqe_builder {
+    uint32_t m_sqn;
+
+public:
+    eth_wqe_builder()
+        : m_sqn(0)
+    {
+    }
+    /**
+     * @brief Takes SQ number from the created pp_sq
+     * @param [in] sq    Send Queue
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(pp_sq& sq)
+    {
+        return sq.get_id(m_sqn);
+    }
+    inline void init(uint32_t sqn)
+    {
+        m_sqn = sqn;
+    }
+    /**
+     * @brief Returns WQEBBs the WQE may occupy, to check SQ room before post()
+     * @param [in] sge_num   Number of packet fragments
+     *
+     * @retval Returns max WQEBBs number.
+     */
+    static inline uint32_t get_max_wqebb_num(uint32_t sge_num)
+    {
+        uint32_t ds = 2 + sge_num + ((FLAGS & ETH_WQE_INLINE_L2) ? 1 : 0);
+        return (ds + (SEND_WQE_BB / WQE_DS_SZ) - 1) / (SEND_WQE_BB / WQE_DS_SZ);
+    }
+    /**
+     * @brief Builds WQE at the SQ producer index and posts it
+     * @param [in] sp    SQ poster
+     * @param [in] desc  Packet to send
+     *
+     * @retval Returns number of posted WQEBBs, 0 if packet doesn't fit FLAGS.
+     */
+    inline uint32_t post(sq_poster& sp, const eth_wqe_desc& desc)
+    {
+        const eth_wqe_sge* sge = desc.sge;
+        const eth_wqe_sge* sge_end = desc.sge + desc.sge_num;
+        uint32_t skip = 0;
+        uint32_t ds = 2;
+
+        wqe_eth_seg* eseg = (wqe_eth_seg*)sp.get_ds(1);
+        eseg->swp_offs = 0;
+        eseg->cs_flags = (FLAGS & ETH_WQE_CSUM) ? (WQE_ETH_L3_CSUM | WQE_ETH_L4_CSUM) : 0;
+        eseg->swp_flags = 0;
+        eseg->mss = 0;
+        eseg->metadata = 0;
+        if (FLAGS & ETH_WQE_INLINE_L2) {
+            if (0 == desc.sge_num) {
+                return 0;
+            }
+            const uint8_t* hdr = (const uint8_t*)(uintptr_t)sge->addr;
+            uint8_t* inl = sp.get_ds(ds++);
+            eseg->inline_hdr_sz = swap_be16(WQE_ETH_INLINE_HDR_SZ);
+            memcpy(eseg->inline_hdr, hdr, sizeof(eseg->inline_hdr));
+            if (FLAGS & ETH_WQE_VLAN_INSERT) {
+                const uint32_t addrs_tail = WQE_ETH_ADDRS_SZ - sizeof(eseg->inline_hdr);
+                uint16_t vlan[2] = {swap_be16(0x8100), swap_be16(desc.vlan_tci)};
+
+                skip = WQE_ETH_INLINE_HDR_SZ - WQE_ETH_VLAN_HDR_SZ;
+                if (sge->len < skip) {
+                    return 0;
+                }
+                memcpy(inl, hdr + sizeof(eseg->inline_hdr), addrs_tail);
+                memcpy(inl + addrs_tail, vlan, sizeof(vlan));
+                memcpy(inl + addrs_tail + sizeof(vlan), hdr + WQE_ETH_ADDRS_SZ,
+                       skip - WQE_ETH_ADDRS_SZ);
+            } else {
+                skip = WQE_ETH_INLINE_HDR_SZ;
+                if (sge->len < skip) {
+                    return 0;
+                }
+                memcpy(inl, hdr + sizeof(eseg->inline_hdr), WQE_DS_SZ);
+            }
+        } else if (FLAGS & ETH_WQE_VLAN_INSERT) {
+            uint16_t tci = swap_be16(desc.vlan_tci);
+            eseg->inline_hdr_sz = swap_be16(WQE_ETH_INSERT_VLAN);
+            memcpy(eseg->inline_hdr, &tci, sizeof(tci));
+        } else {
+            eseg->inline_hdr_sz = 0;
+        }
+
+        for (; sge < sge_end; sge++) {
+            if (sge->len == skip) {
+                skip = 0;
+                continue;
+            }
+            wqe_data_seg* dseg = (wqe_data_seg*)sp.get_ds(ds++);
+            dseg->byte_count = swap_be32(sge->len - skip);
+            dseg->lkey = swap_be32(sge->lkey);
+            dseg->addr = swap_be64(sge->addr + skip);
+            skip = 0;
+        }
+
+        set_wqe_ctrl_seg((wqe_ctrl_seg*)sp.get_wqe(), sp.get_pi(), WQE_OPCODE_SEND, m_sqn, ds,
+                         desc.signal);
+
+        uint32_t wqebb_num = (ds + (SEND_WQE_BB / WQE_DS_SZ) - 1) / (SEND_WQE_BB / WQE_DS_SZ);
+        sp.post(wqebb_num);
+        return wqebb_num;
+    }
+};
+
+/**
+ * @brief struct lso_wqe_desc - Large send to be segmented by HW
+ */
+struct lso_wqe_desc {
+    const void* hdr; /**< L2/L3/L4 headers template of the first segment */
+    uint16_t hdr_len;
+    uint16_t mss; /**< Payload size of every segment but the last one */
+    const eth_wqe_sge* sge; /**< Payload */
+    uint32_t sge_num;
+    bool signal; /**< Request CQE for this WQE */
+};
+
+/**
+ * @brief class lso_wqe_builder - Builds TSO/LSO WQEs in place in SQ ring
+ *
+ * Headers are inlined into Ethernet Segment, HW replicates them for every MSS
+ * sized segment of payload and updates length, IP ID, TCP sequence and checksums.
+ */
+class lso_wqe_builder {
+    uint32_t m_sqn;
+    uint32_t m_max_msg_sz;
+
+public:
+    lso_wqe_builder()
+        : m_sqn(0)
+        , m_max_msg_sz(0)
+    {
+    }
+    /**
+     * @brief Takes SQ number from the created pp_sq and LSO limit from HCA caps
+     * @param [in] sq    Send Queue
+     * @param [in] caps  HCA capabilities from adapter::get_hca_capabilities()
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_NO_SUPPORT if LSO is not supported.
+     */
+    inline status init(pp_sq& sq, const adapter_hca_capabilities& caps)
+    {
+        uint32_t sqn = 0;
+        status ret = sq.get_id(sqn);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        return init(sqn, caps.max_lso_cap);
+    }
+    inline status init(uint32_t sqn, uint8_t max_lso_cap)
+    {
+        if (0 == max_lso_cap) {
+            return DPCP_ERR_NO_SUPPORT;
+        }
+        if (max_lso_cap > 31) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        m_sqn = sqn;
+        m_max_msg_sz = 1U << max_lso_cap;
+        return DPCP_OK;
+    }
+    /**
+     * @brief Returns max LSO message size, headers included
+     */
+    inline uint32_t get_max_msg_sz() const
+    {
+        return m_max_msg_sz;
+    }
+    /**
+     * @brief Returns WQEBBs the WQE occupies, to check SQ room before post()
+     * @param [in] hdr_len   Inlined headers length
+     * @param [in] sge_num   Number of payload fragments
+     *
+     * @retval Returns WQEBBs number.
+     */
+    static inline uint32_t get_wqebb_num(uint32_t hdr_len, uint32_t sge_num)
+    {
+        uint32_t ds = 2 + (hdr_len + WQE_DS_SZ - 1 - 2) / WQE_DS_SZ + sge_num;
+        return (ds + (SEND_WQE_BB / WQE_DS_SZ) - 1) / (SEND_WQE_BB / WQE_DS_SZ);
+    }
+    /**
+     * @brief Builds LSO WQE at the SQ producer index and posts it
+     * @param [in] sp    SQ poster
+     * @param [in] desc  Large send
+     *
+     * @retval Returns number of posted WQEBBs, 0 if send exceeds WQE or LSO limits.
+     */
+    inline uint32_t post(sq_poster& sp, const lso_wqe_desc& desc)
+    {
+        const uint8_t* hdr = (const uint8_t*)desc.hdr;
+        uint32_t hdr_ds = (desc.hdr_len + WQE_DS_SZ - 1 - 2) / WQE_DS_SZ;
+        uint32_t ds = 2 + hdr_ds + desc.sge_num;
+        uint64_t msg_sz = desc.hdr_len;
+        uint32_t i;
+
+        for (i = 0; i < desc.sge_num; i++) {
+            msg_sz += desc.sge[i].len;
+        }
+        if (desc.hdr_len < 2 || 0 == desc.mss || ds > WQE_DS_MAX || msg_sz > m_max_msg_sz) {
+            return 0;
+        }
+
+        wqe_eth_seg* eseg = (wqe_eth_seg*)sp.get_ds(1);
+        eseg->swp_offs = 0;
+        eseg->cs_flags = WQE_ETH_L3_CSUM | WQE_ETH_L4_CSUM;
+        eseg->swp_flags = 0;
+        eseg->mss = swap_be16(desc.mss);
+        eseg->metadata = 0;
+        eseg->inline_hdr_sz = swap_be16(desc.hdr_len);
+        memcpy(eseg->inline_hdr, hdr, sizeof(eseg->inline_hdr));
+
+        // Rest of headers continues in the next segments, which may wrap the ring
+        uint32_t off = sizeof(eseg->inline_hdr);
+        for (i = 0; i < hdr_ds; i++, off += WQE_DS_SZ) {
+            uint32_t len = desc.hdr_len - off;
+            memcpy(sp.get_ds(2 + i), hdr + off, len < WQE_DS_SZ ? len : (uint32_t)WQE_DS_SZ);
+        }
+
+        for (i = 0; i < desc.sge_num; i++) {
+            wqe_data_seg* dseg = (wqe_data_seg*)sp.get_ds(2 + hdr_ds + i);
+            dseg->byte_count = swap_be32(desc.sge[i].len);
+            dseg->lkey = swap_be32(desc.sge[i].lkey);
+            dseg->addr = swap_be64(desc.sge[i].addr);
+        }
+
+        set_wqe_ctrl_seg((wqe_ctrl_seg*)sp.get_wqe(), sp.get_pi(), WQE_OPCODE_TSO, m_sqn, ds,
+                         desc.signal);
+
+        uint32_t wqebb_num = (ds + (SEND_WQE_BB / WQE_DS_SZ) - 1) / (SEND_WQE_BB / WQE_DS_SZ);
+        sp.post(wqebb_num);
+        return wqebb_num;
+    }
+};
+
+/**
+ * @brief class empw_session - Enhanced Multi-Packet Send WQE (eMPW) builder
+ *
+ * Packs many packets into one WQE: short packets are inlined, others are
+ * referenced by data segments. Session is closed when max packets or max WQE
+ * size is reached or the WQE would cross the end of SQ ring, then the next
+ * add() opens a new session. WQE is posted on close(), so SQ must have room
+ * for get_max_wqebb_num() WQEBBs at the producer index while session is open.
+ * All packets of a session share checksum offload setting.
+ */
+class empw_session {
+    enum {
+        DATA_INLINE = (1U << 31),
+        INLINE_BCNT_SZ = 4,
+    };
+
+    uint8_t* m_wqe;
+    uint32_t m_sqn;
+    uint32_t m_max_pkts;
+    uint32_t m_inline_max;
+    uint32_t m_ds;
+    uint32_t m_ds_max;
+    uint32_t m_pkts;
+    uint8_t m_cs_flags;
+
+    inline void open(sq_poster& sp)
+    {
+        uint32_t ring_ds =
+            (sp.get_wqebb_num() - (sp.get_pi() & (sp.get_wqebb_num() - 1))) *
+            (SEND_WQE_BB / WQE_DS_SZ);
+
+        m_wqe = (uint8_t*)sp.get_wqe();
+        m_ds_max = ring_ds < WQE_DS_MAX ? ring_ds : (uint32_t)WQE_DS_MAX;
+        m_ds = 2;
+        m_pkts = 0;
+
+        wqe_eth_seg* eseg = (wqe_eth_seg*)(m_wqe + WQE_DS_SZ);
+        memset(eseg, 0, sizeof(*eseg));
+        eseg->cs_flags = m_cs_flags;
+    }
+
+public:
+    empw_session()
+        : m_wqe(nullptr)
+        , m_sqn(0)
+        , m_max_pkts(0)
+        , m_inline_max(0)
+        , m_ds(0)
+        , m_ds_max(0)
+        , m_pkts(0)
+        , m_cs_flags(0)
+    {
+    }
+    /**
+     * @brief Takes SQ number from the created pp_sq and sets session limits
+     * @param [in] sq            Send Queue
+     * @param [in] max_pkts      Max packets per WQE
+     * @param [in] inline_max    Max length of inlined packet, 0 - no inlining
+     * @param [in] csum          Enable L3 and L4 checksum offload
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    inline status init(pp_sq& sq, uint32_t max_pkts, uint32_t inline_max, bool csum)
+    {
+        uint32_t sqn = 0;
+        status ret = sq.get_id(sqn);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        return init(sqn, max_pkts, inline_max, csum);
+    }
+    inline status init(uint32_t sqn, uint32_t max_pkts, uint32_t inline_max, bool csum)
+    {
+        // Inlined packet must fit into one WQE with control and Ethernet segments
+        if (0 == max_pkts ||
+            inline_max > (WQE_DS_MAX - 2) * WQE_DS_SZ - INLINE_BCNT_SZ) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        m_wqe = nullptr;
+        m_sqn = sqn;
+        m_max_pkts = max_pkts;
+        m_inline_max = inline_max;
+        m_cs_flags = csum ? (WQE_ETH_L3_CSUM | WQE_ETH_L4_CSUM) : 0;
+        return DPCP_OK;
+    }
+    /**
+     * @brief Returns WQEBBs an open session may occupy
+     *
+     * @retval Returns max WQEBBs number.
+     */
+    static inline uint32_t get_max_wqebb_num()
+    {
+        return (WQE_DS_MAX + (SEND_WQE_BB / WQE_DS_SZ) - 1) / (SEND_WQE_BB / WQE_DS_SZ);
+    }
+    /**
+     * @brief Returns true if session is open
+     */
+    inline bool is_open() const
+    {
+        return nullptr != m_wqe;
+    }
+    /**
+     * @brief Adds packet to the session, closes full session and opens new one
+     * @param [in] sp    SQ poster
+     * @param [in] pkt   Packet, inlined if shorter than inline_max
+     *
+     * @retval Returns false for empty packet.
+     */
+    inline bool add(sq_poster& sp, const eth_wqe_sge& pkt)
+    {
+        if (0 == pkt.len) {
+            return false;
+        }
+        bool inl = pkt.len <= m_inline_max;
+        uint32_t ds_num = inl ? (INLINE_BCNT_SZ + pkt.len + WQE_DS_SZ - 1) / WQE_DS_SZ : 1;
+
+        if (m_wqe && (m_pkts == m_max_pkts || m_ds + ds_num > m_ds_max)) {
+            close(sp);
+        }
+        if (!m_wqe) {
+            open(sp);
+        }
+        if (m_ds + ds_num > m_ds_max) {
+            // Near the ring end only pointer fits into new session
+            inl = false;
+            ds_num = 1;
+        }
+
+        uint8_t* seg = m_wqe + m_ds * WQE_DS_SZ;
+        if (inl) {
+            *(uint32_t*)seg = swap_be32(pkt.len | DATA_INLINE);
+            memcpy(seg + INLINE_BCNT_SZ, (const void*)(uintptr_t)pkt.addr, pkt.len);
+        } else {
+            wqe_data_seg* dseg = (wqe_data_seg*)seg;
+            dseg->byte_count = swap_be32(pkt.len);
+            dseg->lkey = swap_be32(pkt.lkey);
+            dseg->addr = swap_be64(pkt.addr);
+        }
+        m_ds += ds_num;
+        m_pkts++;
+        return true;
+    }
+    /**
+     * @brief Closes session and posts its WQE
+     * @param [in] sp        SQ poster
+     * @param [in] signal    Request CQE for the WQE
+     *
+     * @retval Returns number of posted WQEBBs, 0 if no session is open.
+     */
+    inline uint32_t close(sq_poster& sp, bool signal = false)
+    {
+        if (!m_wqe) {
+            return 0;
+        }
+        set_wqe_ctrl_seg((wqe_ctrl_seg*)m_wqe, sp.get_pi(), WQE_OPCODE_ENHANCED_MPSW, m_sqn, m_ds,
+                         signal);
+
+        uint32_t wqebb_num = (m_ds + (SEND_WQE_BB / WQE_DS_SZ) - 1) / (SEND_WQE_BB / WQE_DS_SZ);
+        m_wqe = nullptr;
+        sp.post(wqebb_num);
+        return wqebb_num;
+    }
+};
+
+/**
+ * @brief class umr_queue - Modifies translation of UMR enabled klm_mkeys by posting
+ * UMR WQEs on the own SQ, without firmware commands
+ *
+ * Application can create a dpcp::umr_queue only via dpcp::adapter->create_umr_queue().
+ * Modified mkey may be used after its completion is polled.
+ */
+class umr_queue {
+    friend class adapter;
+    adapter* m_adapter;
+    cq* m_cq;
+    tis* m_tis;
+    pp_sq* m_sq;
+    sq_poster m_sp;
+    cq_poller m_cp;
+    std::vector<uint64_t> m_cookies; // per WQEBB index of posted WQE
+    std::vector<uint32_t> m_wqebbs;
+    uint32_t m_sqn;
+    uint32_t m_sq_ci; // WQEBBs completed
+
+    umr_queue(adapter* ad);
+    status init(uint32_t depth);
+
+public:
+    virtual ~umr_queue();
+    /**
+     * @brief Posts UMR WQE replacing translation of klm_mkey
+     * @param [in] mk          klm_mkey created with MKEY_UMR_ENABLED flag
+     * @param [in] address     New Virtual Address, ignored for zero based mkey
+     * @param [in] entries_num Number of entries, up to klm_mkey::UMR_MAX_ENTRIES
+     * @param [in] entries     New entries, KSM mkey entries keep the entity size
+     * @param [in] cookie      Value returned by poll() on completion
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_NO_MEMORY if the queue is full.
+     */
+    status rebind(klm_mkey& mk, void* address, size_t entries_num,
+                  const klm_mkey_entry entries[], uint64_t cookie);
+    /**
+     * @brief Polls completed rebinds
+     * @param [out]    cookies Cookies of completed rebinds
+     * @param [in,out] num     Max number of completions, on return number of polled
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_MODIFY if the last polled rebind failed,
+     * the queue can't be used after that.
+     */
+    status poll(uint64_t* cookies, uint32_t& num);
+    /**
+     * @brief Returns number of WQEBBs of rebinds waiting for completion
+     */
+    inline uint32_t get_outstanding() const
+    {
+        return m_sp.get_pi() - m_sq_ci;
+    }
+
+    umr_queue(umr_queue const&) = delete;
+    void operator=(umr_queue const&) = delete;
+};
+
+/**
+ * @brief Completion of command submitted to @ref cmd_engine
+ */
+struct cmd_completion {
+    uint64_t cookie; /**< Cookie passed on submit */
+    status ret; /**< Result of the command */
+};
+
+/**
+ * @brief class cmd_engine - Executes control path commands asynchronously
+ *
+ * Object queries are posted on DevX asynchronous command channel. DevX has no
+ * asynchronous create/modify, so other commands are run by worker threads of the engine.
+ * Both kinds of completions are reported by poll(), get_fd() is readable while
+ * completions are pending, so many commands may be submitted and harvested in batch.
+ *
+ * Application can create a dpcp::cmd_engine only via dpcp::adapter->create_cmd_engine().
+ * Objects and buffers referenced by a command must be valid until its completion is polled.
+ */
+class cmd_engine {
+    friend class adapter;
+    struct query_ctx {
+        void* out;
+        size_t out_sz;
+        uint64_t cookie;
+    };
+    typedef std::pair<std::function<status()>, uint64_t> cmd_t;
+
+    dcmd::ctx* m_ctx;
+    dcmd::cmd_comp* m_comp;
+    std::vector<std::thread> m_workers;
+    std::mutex m_lock;
+    std::condition_variable m_cv;
+    std::deque<cmd_t> m_cmds;
+    std::deque<cmd_completion> m_done;
+    unordered_map<uint64_t, query_ctx> m_queries; // by wr_id of posted queries
+    std::vector<uint8_t> m_resp; // fits the largest posted query response
+    uint64_t m_wr_id;
+    uint32_t m_outstanding;
+    bool m_stop;
+
+    cmd_engine(dcmd::ctx* ctx);
+    status init(uint32_t num_workers);
+    void worker();
+
+public:
+    virtual ~cmd_engine();
+    /**
+     * @brief Submits command to be run by worker thread
+     * @param [in] cmd    Command, returned status is reported on completion
+     * @param [in] cookie Value returned by poll() on completion
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status submit(std::function<status()> cmd, uint64_t cookie);
+    /**
+     * @brief Submits general DevX command
+     * @param [in]  in     Command input
+     * @param [in]  in_sz  Size of command input in bytes
+     * @param [out] out    Command output, valid after completion was polled
+     * @param [in]  out_sz Size of command output in bytes
+     * @param [in]  cookie Value returned by poll() on completion
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status exec_async(const void* in, size_t in_sz, void* out, size_t out_sz, uint64_t cookie);
+    /**
+     * @brief Posts query of DevX object, used by @ref obj::query_async
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status post_query(dcmd::obj* handle, const void* in, size_t in_sz, void* out, size_t out_sz,
+                      uint64_t cookie);
+    /**
+     * @brief Polls completed commands
+     * @param [out]    comps Completions, in order of completion
+     * @param [in,out] num   Max number of completions, on return number of polled
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status poll(cmd_completion* comps, uint32_t& num);
+    /**
+     * @brief Returns file descriptor readable while completions are pending
+     */
+    int get_fd() const;
+    /**
+     * @brief Returns number of submitted commands which completion wasn't polled
+     */
+    uint32_t get_outstanding();
+
+    cmd_engine(cmd_engine const&) = delete;
+    void operator=(cmd_engine const&) = delete;
+};
+
+/**
+ * @brief Move of RSS hash bucket to RQ
+ */
+struct rss_bucket_move {
+    uint32_t bucket; /**< Bucket, hash result % table size */
+    uint32_t rqn; /**< RQ number receiving packets of the bucket */
+};
+
+/**
+ * @brief Class rss_table - RSS indirection table manager.
+ *
+ * Owns RQT of num_buckets entries mapped onto a set of RQs, to be referenced by TIR
+ * @ref tir::attr::rss::indirect_table. Buckets start spread round robin over the RQs.
+ * Application accounts per bucket load by hash result reported in the CQE, then moves
+ * buckets between RQs at runtime, each rewrite takes one RQT modify command and steering
+ * rules are not touched.
+ *
+ * Loads may be added from any thread, other methods should be serialized by the application.
+ * Application can create a dpcp::rss_table only via dpcp::adapter->create_rss_table().
+ */
+class rss_table {
+    friend class adapter;
+
+    rqt m_rqt;
+    std::vector<uint32_t> m_rqns; // RQs of the table
+    std::vector<uint32_t> m_map; // bucket to index in m_rqns
+    std::unique_ptr<std::atomic<uint64_t>[]> m_loads;
+    uint32_t m_mask;
+
+    rss_table(dcmd::ctx* ctx);
+    status init(const std::vector<uint32_t>& rqns, uint32_t num_buckets);
+    status apply(const std::vector<uint32_t>& map);
+
+public:
+    virtual ~rss_table();
+    /**
+     * @brief Adds load of a packet to its bucket
+     *
+     * @param [in] hash    RSS hash result of the packet
+     * @param [in] load    Packets or bytes, up to the application
+     */
+    inline void add_load(uint32_t hash, uint64_t load)
+    {
+        m_loads[hash & m_mask].fetch_add(load, std::memory_order_relaxed);
+    }
+    /**
+     * @brief Returns load of a bucket
+     */
+    inline uint64_t get_bucket_load(uint32_t bucket) const
+    {
+        return m_loads[bucket & m_mask].load(std::memory_order_relaxed);
+    }
+    /**
+     * @brief Returns loads of RQs, in order of RQs given on creation
+     */
+    void get_rq_loads(std::vector<uint64_t>& loads) const;
+    /**
+     * @brief Clears loads of all buckets
+     */
+    void reset_loads();
+    /**
+     * @brief Returns RQ number of a bucket
+     */
+    inline uint32_t get_bucket_rqn(uint32_t bucket) const
+    {
+        return m_rqns[m_map[bucket & m_mask]];
+    }
+    /**
+     * @brief Moves buckets to RQs of the table with one RQT modify
+     *
+     * @param [in] moves    Buckets and their new RQ numbers
+     *
+     * @retval Returns DPCP_OK on success, on failure the mapping is not changed.
+     */
+    status move_buckets(const std::vector<rss_bucket_move>& moves);
+    /**
+     * @brief Moves heaviest buckets from most to least loaded RQs with one RQT modify
+     *
+     * @param [in]  max_moves    Maximum number of buckets to move
+     * @param [out] moved        Number of buckets moved
+     *
+     * @retval Returns DPCP_OK on success, on failure the mapping is not changed.
+     */
+    status rebalance(uint32_t max_moves, uint32_t& moved);
+    /**
+     * @brief Returns number of buckets
+     */
+    inline uint32_t get_size() const
+    {
+        return m_mask + 1;
+    }
+    /**
+     * @brief Returns RQT to be referenced by TIR
+     */
+    inline rqt& get_rqt()
+    {
+        return m_rqt;
+    }
+
+    rss_table(rss_table const&) = delete;
+    void operator=(rss_table const&) = delete;
+};
+
+/**
+ * @brief Class flow_table_switch - Double buffered flow table.
+ *
+ * Keeps active flow table, which receives traffic from parent flow rule forward action
+ * or from parent flow table miss, and shadow flow table of the same attributes.
+ * Application builds complete new ruleset in the shadow table while traffic hits the
+ * active one, then commit() redirects the parent to the shadow table with one modify
+ * command, so no packet sees partially built ruleset. Previous active table with its
+ * groups and rules is destroyed in the background by @ref cmd_engine when given.
+ *
+ * Application can create a dpcp::flow_table_switch only via
+ * dpcp::adapter->create_flow_table_switch().
+ */
+class flow_table_switch {
+    friend class adapter;
+
+    adapter* m_adapter;
+    flow_table_attr m_attr;
+    std::shared_ptr<flow_table> m_active;
+    std::shared_ptr<flow_table> m_shadow;
+    std::weak_ptr<flow_rule_ex> m_parent_rule;
+    std::weak_ptr<flow_table> m_parent_table;
+
+    flow_table_switch(adapter* ad);
+    status init(const flow_table_attr& attr);
+    status create_table(std::shared_ptr<flow_table>& table);
+    status redirect_rule(const std::shared_ptr<flow_rule_ex>& rule,
+                         const std::shared_ptr<flow_table>& table);
+
+public:
+    virtual ~flow_table_switch();
+    /**
+     * @brief Returns flow table receiving the traffic
+     */
+    inline std::shared_ptr<flow_table> get_active() const
+    {
+        return m_active;
+    }
+    /**
+     * @brief Returns shadow flow table, creates it on first call after commit
+     *
+     * @param [out] table: Created flow table to be filled with groups and rules
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status get_shadow(std::shared_ptr<flow_table>& table);
+    /**
+     * @brief Switches tables by forward action of created flow @a rule
+     *
+     * @note: Forward action of @a rule must have active table as destination.
+     */
+    status set_parent(std::weak_ptr<flow_rule_ex> rule);
+    /**
+     * @brief Switches tables by miss action of created flow @a table
+     *
+     * @note: Miss of @a table is forwarded to active table by this call.
+     */
+    status set_parent(std::shared_ptr<flow_table> table);
+    /**
+     * @brief Redirects traffic of the parent to shadow table which becomes active
+     *
+     * @param [in] engine: If not nullptr previous active table is destroyed by
+     *                     engine worker, completion is polled with @a cookie
+     * @param [in] cookie: Value returned by cmd_engine::poll() on completion
+     *
+     * @retval Returns DPCP_OK on success, on failure traffic stays on active table.
+     */
+    status commit(cmd_engine* engine = nullptr, uint64_t cookie = 0);
+    /**
+     * @brief Destroys shadow table with all its groups and rules
+     */
+    void discard_shadow();
+
+    flow_table_switch(flow_table_switch const&) = delete;
+    void operator=(flow_table_switch const&) = delete;
+};
+
+/**
+ * @brief Traffic counted by flow counter
+ */
+struct flow_counter_stats {
+    uint64_t packets;
+    uint64_t octets;
+};
+
+/**
+ * @brief Class flow_counter_bulk - Flow counters allocated by one HW object.
+ *
+ * Counter of the bulk is attached to flow rule by @ref flow_action_generator::create_counter,
+ * any range of the bulk is read by one query command. In refresh mode a background thread
+ * reads the whole bulk periodically and get_stats() returns the last snapshot without
+ * issuing commands.
+ *
+ * Application can create a dpcp::flow_counter_bulk only via
+ * dpcp::adapter->create_flow_counter_bulk().
+ */
+class flow_counter_bulk : public obj {
+    friend class adapter;
+
+    uint32_t m_num;
+    uint32_t m_base_id;
+    std::unique_ptr<index_allocator> m_indexes;
+    std::mutex m_indexes_lock;
+    std::vector<flow_counter_stats> m_snapshot;
+    std::mutex m_snapshot_lock;
+    std::thread m_refresh_thread;
+    std::mutex m_refresh_lock;
+    std::condition_variable m_refresh_cv;
+    bool m_refresh_stop;
+
+    flow_counter_bulk(dcmd::ctx* ctx);
+    status init(uint32_t num, uint8_t bulk_alloc);
+    void refresh(std::chrono::milliseconds period);
+
+public:
+    virtual ~flow_counter_bulk();
+    /**
+     * @brief Takes free counter of the bulk
+     *
+     * @param [out] index           Counter index in the bulk
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_OUT_OF_RANGE when all are taken.
+     */
+    status alloc_counter(uint32_t& index);
+    /**
+     * @brief Returns counter taken by alloc_counter()
+     */
+    status release_counter(uint32_t index);
+    /**
+     * @brief Returns HW id of counter @a index
+     */
+    status get_counter_id(uint32_t index, uint32_t& id) const;
+    /**
+     * @brief Returns number of counters in the bulk
+     */
+    inline uint32_t get_size() const
+    {
+        return m_num;
+    }
+    /**
+     * @brief Reads @a num counters from @a first with one command
+     *
+     * @param [in]  first           Index of first counter
+     * @param [in]  num             Number of counters
+     * @param [out] stats           Array of @a num counters
+     * @param [in]  clear           Resets read counters when set, range of several counters
+     *                              must start and end at index aligned to 4 then
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status query(uint32_t first, uint32_t num, flow_counter_stats* stats, bool clear = false);
+    /**
+     * @brief Starts reading all counters of the bulk every @a period
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status start_refresh(std::chrono::milliseconds period);
+    /**
+     * @brief Stops periodic refresh, last snapshot stays available
+     */
+    void stop_refresh();
+    /**
+     * @brief Copies @a num counters from @a first of the last refresh snapshot
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_NOT_APPLIED before first refresh.
+     */
+    status get_stats(uint32_t first, uint32_t num, flow_counter_stats* stats);
+};
+
+/**
+ * @brief: Header tunneling type for parser graph node sampling.
+ *
+ * The same parser node can be used for parsing a header that
+ * will be in an outer part of a tunnel or in inner of a tunnel.
+ * Those are the indicators which of the options will be sampled.
+ */
+enum parse_graph_flow_match_sample_tunnel_mode {
+    PARSE_GRAPH_FLOW_MATCH_SAMPLE_TUNNEL_OUTER = 0x0, /**< The outer part of the tunneled header. */
+    PARSE_GRAPH_FLOW_MATCH_SAMPLE_TUNNEL_INNER = 0x1, /**< The inner part of the tunneled header. */
+    PARSE_GRAPH_FLOW_MATCH_SAMPLE_TUNNEL_FIRST = 0x2 /**< Not a tunneled header. */
+};
+
+/**
+ * @brief: Length mode of parser graph node.
  *
  * Defines the mode in which header length is calculated.
  */
@@ -2690,6 +5138,11 @@ private:
     adapter_hca_capabilities* m_external_hca_caps;
     std::vector<cap_cb_fn> m_caps_callbacks;
     bool m_opened;
+    ring_alloc_mode m_ring_alloc_mode;
+    int m_device_numa_node;
+    int m_numa_node;
+    umem_arena* m_umem_arena;
+    mkey_cache* m_mkey_cache;
     flow_action_generator m_flow_action_generator;
     std::shared_ptr<flow_table> m_root_table_arr[flow_table_type::FT_END];
     status prepare_basic_rq(basic_rq& srq);
@@ -2738,6 +5191,64 @@ public:
 
     void* get_ibv_context();
 
+    /**
+     * @brief Sets memory backing ring buffers of CQs, RQs and SQs created afterwards
+     *
+     * @param [in] mode         Ring allocation mode
+     *
+     * @note: Huge pages are used only for rings or UMEM arena chunks of at least half
+     *        the huge page size, see @ref ring_alloc_mode.
+     */
+    inline void set_ring_alloc_mode(ring_alloc_mode mode)
+    {
+        m_ring_alloc_mode = mode;
+    }
+    inline ring_alloc_mode get_ring_alloc_mode() const
+    {
+        return m_ring_alloc_mode;
+    }
+
+    /**
+     * @brief Returns NUMA node the device is attached to
+     *
+     * @retval Returns NUMA node or -1 if unknown.
+     */
+    inline int get_device_numa_node() const
+    {
+        return m_device_numa_node;
+    }
+
+    /**
+     * @brief Sets NUMA node of ring buffers of CQs, RQs and SQs created afterwards,
+     * NUMA placement is skipped by default. @ref get_device_numa_node() is the usual choice.
+     * DoorBell records are placed along with the rings only by the UMEM arena.
+     *
+     * @param [in] numa_node    NUMA node, -1 to skip NUMA placement
+     */
+    inline void set_numa_node(int numa_node)
+    {
+        m_numa_node = numa_node;
+    }
+    inline int get_numa_node() const
+    {
+        return m_numa_node;
+    }
+
+    /**
+     * @brief Carves ring buffers and DoorBell records of CQs, RQs and SQs created afterwards
+     * out of shared UMEM registered chunks instead of registering memory per Queue.
+     * Chunks use ring allocation mode and NUMA node set at the time of the call.
+     *
+     * @param [in] chunk_sz     Size of registered chunk, larger rings get own chunk
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status enable_umem_arena(size_t chunk_sz = 4 * 1024 * 1024);
+    inline bool is_umem_arena_enabled() const
+    {
+        return nullptr != m_umem_arena;
+    }
+
     /**
      * @brief Get real time for device (supported starting from ConnextX6)
      *
@@ -2803,6 +5314,68 @@ public:
      */
     status create_pattern_mkey(void* address, mkey_flags flags, size_t stride_num, size_t bb_num,
                                pattern_mkey_bb bb_arr[], pattern_mkey*& mkey);
+    /**
+     * @brief Creates and returns klm_mkey
+     *
+     * @param [in]  address         Virtual Address of the stitched memory region
+     * @param [in]  flags           Flags
+     * @param [in]  entries_num     Number of entries
+     * @param [in]  entries         Memory regions in order of the stitched memory region
+     * @param [out] mkey            On Success created klm_mkey
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_klm_mkey(void* address, mkey_flags flags, size_t entries_num,
+                           const klm_mkey_entry entries[], klm_mkey*& mkey);
+    /**
+     * @brief Creates and returns umr_queue
+     *
+     * @param [in]  depth           Number of WQEBBs of UMR SQ, must be power of 2
+     * @param [out] uq              On Success created umr_queue
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_umr_queue(uint32_t depth, umr_queue*& uq);
+    /**
+     * @brief Creates and returns cmd_engine
+     *
+     * @param [in]  num_workers     Number of threads running create/modify commands
+     * @param [out] engine          On Success created cmd_engine
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_cmd_engine(uint32_t num_workers, cmd_engine*& engine);
+    /**
+     * @brief Creates and returns rss_table
+     *
+     * @param [in]  rqns            RQ numbers to spread packets over
+     * @param [in]  num_buckets     Number of RQT entries, power of 2 not less than RQs
+     * @param [out] table           On Success created rss_table
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_rss_table(const std::vector<uint32_t>& rqns, uint32_t num_buckets,
+                            rss_table*& table);
+    /**
+     * @brief Creates and returns flow_table_switch with created active flow table
+     *
+     * @param [in]  attr            Attributes of active and shadow flow tables
+     * @param [out] table_switch    On Success created flow_table_switch
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_flow_table_switch(const flow_table_attr& attr,
+                                    flow_table_switch*& table_switch);
+    /**
+     * @brief Creates and returns flow_counter_bulk
+     *
+     * @param [in]  num             Number of counters, 1 or power of 2 from 128 to 16384
+     * @param [out] bulk            On Success created flow_counter_bulk
+     *
+     * @retval      Returns DPCP_OK on success, DPCP_ERR_NO_SUPPORT if the bulk size is
+     *              not in adapter_hca_capabilities::flow_counter_bulk_alloc
+     */
+    status create_flow_counter_bulk(uint32_t num, flow_counter_bulk*& bulk);
     /**
      * @brief Creates and returns reserved_mkey
      *
@@ -2840,6 +5413,45 @@ public:
      */
     status create_extern_mkey(void* address, size_t length, uint32_t id, extern_mkey*& mkey);
 
+    /**
+     * @brief Enables registration cache used by get_cached_mkey()
+     *
+     * @param [in]  max_unused      Number of unreferenced registrations kept before
+     *                              the least recently used ones are deregistered
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status enable_mkey_cache(size_t max_unused = 1024);
+    /**
+     * @brief Returns Memory Key of the region, registering it only if no cached
+     * registration contains the region
+     *
+     * Returns cached direct_mkey on exact match or ref_mkey for a sub-range of it.
+     * The key must be released with put_cached_mkey() and mustn't be deleted.
+     *
+     * @param [in]  address         Virtual Address
+     * @param [in]  length          Address Length in bytes
+     * @param [in]  flags           Flags
+     * @param [out] mkey            On Success referenced Memory Key
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status get_cached_mkey(void* address, size_t length, mkey_flags flags, mkey*& mkey);
+    /**
+     * @brief Releases Memory Key returned by get_cached_mkey()
+     *
+     * @retval      Returns DPCP_OK on success, DPCP_ERR_INVALID_PARAM if the key
+     *              is not referenced
+     */
+    status put_cached_mkey(mkey* mkey);
+    /**
+     * @brief Drops cached registrations overlapping the region, must be called
+     * before the memory is unmapped. Referenced ones are deregistered on the last put.
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status invalidate_cached_mkeys(void* address, size_t length);
+
     /**
      * @brief Creates and returns CQ
      *
@@ -2894,6 +5506,17 @@ public:
      */
     status create_tir(const tir::attr& tir_attr, tir*& tir_obj);
 
+    /**
+     * @brief Creates and returns DPCP RQT
+     *
+     * @param [in]  rqns            RQ numbers of the table
+     * @param [out] rqt_obj         Pointer to RQT object on success
+     * @param [in]  max_size        Maximum number of entries, see @ref rqt::create
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status create_rqt(const std::vector<uint32_t>& rqns, rqt*& rqt_obj, uint32_t max_size = 0);
+
     /**
      * @brief Creates and returns DPCP TIS
      *
@@ -2945,6 +5568,16 @@ public:
 
     status query_eqn(uint32_t& eqn, uint32_t cpu_vector = 0);
 
+    /**
+     * @brief Returns EventQueue number of completion vector local to the CPU
+     *
+     * @param [out] eqn         EventQueue number
+     * @param [in] cpu          CPU which handles the CQ completions
+     *
+     * @retval      Returns DPCP_OK on success
+     */
+    status query_eqn_by_cpu(uint32_t& eqn, uint32_t cpu);
+
     status get_hca_caps_frequency_khz(uint32_t& freq); // TODO: Deprecate.
 
     /**
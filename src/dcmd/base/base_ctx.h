@@ -39,9 +39,11 @@
 namespace dcmd {
 
 class obj;
+class cmd_comp;
 class uar;
 class umem;
 class flow;
+class flow_matcher;
 class action_fwd;
 
 class base_ctx {
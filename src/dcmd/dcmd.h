@@ -70,6 +70,7 @@ extern "C" {
 enum {
     DCMD_EOK = 0, /* */
     DCMD_EIO = 5, /* errno */
+    DCMD_EAGAIN = 11, /* errno */
     DCMD_EINVAL = 22, /* errno */
     DCMD_ENOTSUP = 134 /* errno */
 };
@@ -154,6 +155,13 @@ struct modify_action {
     } src;
 };
 
+struct flow_matcher_desc {
+    struct flow_match_parameters* match_criteria;
+    uint16_t priority;
+};
+
+class flow_matcher;
+
 struct flow_desc {
     struct flow_match_parameters* match_criteria;
     struct flow_match_parameters* match_value;
@@ -165,6 +173,7 @@ struct flow_desc {
     dcmd::obj_desc modify_acttions_obj_desc;
     modify_action* modify_actions;
     size_t num_of_actions;
+    flow_matcher* matcher; /* Shared matcher, match_criteria and priority are ignored if set */
 
     flow_desc()
         : match_criteria()
@@ -177,6 +186,7 @@ struct flow_desc {
         , modify_acttions_obj_desc()
         , modify_actions()
         , num_of_actions()
+        , matcher()
     {
     }
 };
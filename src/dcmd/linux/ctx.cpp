@@ -29,6 +29,8 @@
  */
 
 #include <string>
+#include <fstream>
+#include <climits>
 
 #include <utils/os.h>
 #include "dcmd/dcmd.h"
@@ -92,6 +94,19 @@ obj* ctx::create_obj(struct obj_desc* desc)
     return obj_ptr;
 }
 
+cmd_comp* ctx::create_cmd_comp()
+{
+    cmd_comp* comp_ptr = nullptr;
+
+    try {
+        comp_ptr = new cmd_comp(m_handle);
+    } catch (...) {
+        return nullptr;
+    }
+
+    return comp_ptr;
+}
+
 uar* ctx::create_uar(struct uar_desc* desc)
 {
 
@@ -134,6 +149,19 @@ flow* ctx::create_flow(struct flow_desc* desc)
     return obj_ptr;
 }
 
+flow_matcher* ctx::create_flow_matcher(struct flow_matcher_desc* desc)
+{
+    flow_matcher* obj_ptr = nullptr;
+
+    try {
+        obj_ptr = new flow_matcher(m_handle, desc);
+    } catch (...) {
+        return nullptr;
+    }
+
+    return obj_ptr;
+}
+
 int ctx::query_eqn(uint32_t cpu_num, uint32_t& eqn)
 {
     int ret = mlx5dv_devx_query_eqn(m_handle, cpu_num, &eqn);
@@ -141,6 +169,82 @@ int ctx::query_eqn(uint32_t cpu_num, uint32_t& eqn)
     return (ret ? DCMD_EIO : DCMD_EOK);
 }
 
+int ctx::get_numa_node()
+{
+    int node = -1;
+    std::ifstream is(std::string(m_handle->device->ibdev_path) + "/device/numa_node");
+
+    if (is.good()) {
+        is >> node;
+    }
+    log_trace("get_numa_node: %s node: %d\n", m_handle->device->name, node);
+    return node;
+}
+
+/* Checks if cpu is in the list formatted as "0-3,8,10-11" */
+static bool is_cpu_in_list(const std::string& list, uint32_t cpu)
+{
+    const char* p = list.c_str();
+
+    while (*p) {
+        char* end = nullptr;
+        unsigned long first = strtoul(p, &end, 10);
+        unsigned long last = first;
+        if (end == p) {
+            break;
+        }
+        if ('-' == *end) {
+            p = end + 1;
+            last = strtoul(p, &end, 10);
+        }
+        if (cpu >= first && cpu <= last) {
+            return true;
+        }
+        p = (',' == *end) ? end + 1 : end;
+    }
+    return false;
+}
+
+int ctx::query_comp_vector(uint32_t cpu, uint32_t& vector)
+{
+    static const std::string comp_irq_name = "mlx5_comp";
+    std::string dev_path = std::string(m_handle->device->ibdev_path) + "/device";
+    char link[PATH_MAX] = {};
+
+    if (m_handle->num_comp_vectors <= 0) {
+        return DCMD_ENOTSUP;
+    }
+    // Completion vector IRQs are listed as mlx5_comp<vector>@pci:<address> in /proc/interrupts
+    ssize_t len = readlink(dev_path.c_str(), link, sizeof(link) - 1);
+    if (len > 0) {
+        const char* bdf = strrchr(link, '/');
+        std::string pci_addr = std::string("@pci:") + (bdf ? bdf + 1 : link);
+        std::ifstream irqs("/proc/interrupts");
+        std::string line;
+
+        while (std::getline(irqs, line)) {
+            size_t pos = line.find(comp_irq_name);
+            if (std::string::npos == pos || std::string::npos == line.find(pci_addr, pos)) {
+                continue;
+            }
+            unsigned long irq = strtoul(line.c_str(), nullptr, 10);
+            unsigned long vec = strtoul(line.c_str() + pos + comp_irq_name.size(), nullptr, 10);
+            std::ifstream is("/proc/irq/" + std::to_string(irq) + "/smp_affinity_list");
+            std::string cpu_list;
+            if ((is >> cpu_list) && is_cpu_in_list(cpu_list, cpu) &&
+                vec < (unsigned long)m_handle->num_comp_vectors) {
+                vector = (uint32_t)vec;
+                log_trace("query_comp_vector: cpu: %u vector: %u irq: %lu\n", cpu, vector, irq);
+                return DCMD_EOK;
+            }
+        }
+    }
+    // IRQ affinity is not visible, spread CPUs over vectors
+    vector = cpu % (uint32_t)m_handle->num_comp_vectors;
+    log_trace("query_comp_vector: cpu: %u vector: %u\n", cpu, vector);
+    return DCMD_EOK;
+}
+
 int ctx::hca_iseg_mapping()
 {
     int ret = 0;
@@ -47,6 +47,7 @@ public:
     void* get_context();
     int exec_cmd(const void* in, size_t inlen, void* out, size_t outlen);
     obj* create_obj(struct obj_desc* desc);
+    cmd_comp* create_cmd_comp();
     uar* create_uar(struct uar_desc* desc);
     umem* create_umem(struct umem_desc* desc);
     ibv_mr* ibv_reg_mem_reg_iova(struct ibv_pd* verbs_pd, void* addr, size_t length, uint64_t iova,
@@ -55,7 +56,10 @@ public:
                             unsigned int access);
     int ibv_dereg_mem_reg(struct ibv_mr* umem);
     flow* create_flow(struct flow_desc* desc);
+    flow_matcher* create_flow_matcher(struct flow_matcher_desc* desc);
     int query_eqn(uint32_t cpu_num, uint32_t& eqn);
+    int get_numa_node();
+    int query_comp_vector(uint32_t cpu, uint32_t& vector);
     int hca_iseg_mapping();
     uint64_t get_real_time();
     int create_ibv_pd(void* ibv_pd, uint32_t& pdn);
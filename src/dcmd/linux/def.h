@@ -45,6 +45,8 @@ typedef struct mlx5dv_devx_umem* umem_handle;
 typedef struct mlx5dv_devx_uar* uar_handle;
 typedef struct ibv_flow* flow_handle;
 typedef struct ibv_cq* cq_handle;
+typedef struct mlx5dv_devx_cmd_comp* cmd_comp_handle;
+typedef struct mlx5dv_devx_async_cmd_hdr cmd_comp_hdr;
 /*
  * Packet Pacing
  */
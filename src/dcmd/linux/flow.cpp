@@ -35,27 +35,65 @@
 
 using namespace dcmd;
 
-flow::flow(ctx_handle handle, struct flow_desc* desc)
+static struct mlx5dv_flow_matcher* create_matcher(ctx_handle handle,
+                                                  struct flow_match_parameters* match_criteria,
+                                                  uint16_t priority)
 {
-    struct ibv_flow* ib_flow;
-    struct mlx5dv_flow_matcher* matcher = NULL;
     struct mlx5dv_flow_matcher_attr matcher_attr;
 
     memset(&matcher_attr, 0, sizeof(matcher_attr));
     matcher_attr.type = IBV_FLOW_ATTR_NORMAL;
     matcher_attr.flags = 0;
-    matcher_attr.priority = desc->priority;
+    matcher_attr.priority = priority;
     // Only outer header for now!!!
     matcher_attr.match_criteria_enable = 1
         << MLX5_CREATE_FLOW_GROUP_IN_MATCH_CRITERIA_ENABLE_OUTER_HEADERS;
-    matcher_attr.match_mask = (struct mlx5dv_flow_match_parameters*)desc->match_criteria;
+    matcher_attr.match_mask = (struct mlx5dv_flow_match_parameters*)match_criteria;
     matcher_attr.comp_mask = MLX5DV_FLOW_MATCHER_MASK_FT_TYPE;
     matcher_attr.ft_type = MLX5_IB_UAPI_FLOW_TABLE_TYPE_NIC_RX;
 
-    matcher = mlx5dv_create_flow_matcher(handle, &matcher_attr);
-    if (NULL == matcher) {
+    return mlx5dv_create_flow_matcher(handle, &matcher_attr);
+}
+
+flow_matcher::flow_matcher(ctx_handle handle, struct flow_matcher_desc* desc)
+    : m_handle(nullptr)
+{
+    if (!handle || !desc) {
+        throw DCMD_EINVAL;
+    }
+
+    m_handle = create_matcher(handle, desc->match_criteria, desc->priority);
+    log_trace("flow_matcher(%p) priority: %u errno=%d\n", m_handle, desc->priority, errno);
+    if (NULL == m_handle) {
         throw DCMD_ENOTSUP;
     }
+}
+
+flow_matcher::~flow_matcher()
+{
+    if (m_handle) {
+        mlx5dv_destroy_flow_matcher(m_handle);
+        m_handle = nullptr;
+    }
+}
+
+flow::flow(ctx_handle handle, struct flow_desc* desc)
+    : m_handle(nullptr)
+    , m_matcher(nullptr)
+{
+    struct ibv_flow* ib_flow;
+    struct mlx5dv_flow_matcher* matcher = NULL;
+
+    // Matcher is created per flow unless the shared one is provided
+    if (desc->matcher) {
+        matcher = desc->matcher->get_handle();
+    } else {
+        matcher = create_matcher(handle, desc->match_criteria, desc->priority);
+        if (NULL == matcher) {
+            throw DCMD_ENOTSUP;
+        }
+        m_matcher = matcher;
+    }
 
     size_t num_actions = (desc->flow_id ? (desc->num_dst_obj + 1) : desc->num_dst_obj);
     num_actions += desc->modify_actions ? 1 : 0;
@@ -74,6 +112,9 @@ flow::flow(ctx_handle handle, struct flow_desc* desc)
             handle, sizeof(modify_action) * desc->num_of_actions, (uint64_t*)desc->modify_actions,
             MLX5_IB_UAPI_FLOW_TABLE_TYPE_NIC_RX);
         if (!actions_attr[i].action) {
+            if (m_matcher) {
+                mlx5dv_destroy_flow_matcher(m_matcher);
+            }
             throw DCMD_ENOTSUP;
         }
         i++;
@@ -86,10 +127,11 @@ flow::flow(ctx_handle handle, struct flow_desc* desc)
     ib_flow = mlx5dv_create_flow(matcher, (struct mlx5dv_flow_match_parameters*)desc->match_value,
                                  num_actions, actions_attr);
     if (NULL == ib_flow) {
-        mlx5dv_destroy_flow_matcher(matcher);
+        if (m_matcher) {
+            mlx5dv_destroy_flow_matcher(m_matcher);
+        }
         throw DCMD_ENOTSUP;
     }
-    m_matcher = matcher;
     m_handle = ib_flow;
 }
 
@@ -98,6 +140,8 @@ flow::~flow()
     if (m_handle) {
         ibv_destroy_flow(m_handle);
         m_handle = nullptr;
+    }
+    if (m_matcher) {
         mlx5dv_destroy_flow_matcher(m_matcher);
         m_matcher = nullptr;
     }
@@ -30,6 +30,10 @@
 
 #include <string>
 #include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include "utils/os.h"
 #include "dcmd/dcmd.h"
 
@@ -95,3 +99,119 @@ int obj::modify(struct obj_desc* desc)
               desc->in, desc->inlen, desc->out, desc->outlen, errno, ret);
     return (ret ? DCMD_EIO : DCMD_EOK);
 }
+
+int obj::query_async(struct obj_desc* desc, uint64_t wr_id, cmd_comp& comp)
+{
+
+    if (!desc) {
+        return DCMD_EINVAL;
+    }
+
+    int ret = mlx5dv_devx_obj_query_async(m_handle, desc->in, desc->inlen, desc->outlen, wr_id,
+                                          comp.get_handle());
+    log_trace("obj::query_async(%p) in: %p in_sz: %ld out_sz: %ld wr_id: %llx errno=%d ret=%d\n",
+              m_handle, desc->in, desc->inlen, desc->outlen, (unsigned long long)wr_id, errno, ret);
+    return (ret ? DCMD_EIO : DCMD_EOK);
+}
+
+cmd_comp::cmd_comp(ctx_handle handle)
+    : m_handle(nullptr)
+    , m_event_fd(-1)
+    , m_fd(-1)
+{
+    struct epoll_event ev = {};
+
+    if (!handle) {
+        throw DCMD_EINVAL;
+    }
+
+    m_handle = mlx5dv_devx_create_cmd_comp(handle);
+    if (NULL == m_handle) {
+        log_error("create_cmd_comp failed errno=%d\n", errno);
+        throw DCMD_ENOTSUP;
+    }
+    // Responses are harvested without blocking, waiting is done on get_fd()
+    int flags = fcntl(m_handle->fd, F_GETFL);
+    bool ok = (flags >= 0) && (0 == fcntl(m_handle->fd, F_SETFL, flags | O_NONBLOCK));
+    if (ok) {
+        m_event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        m_fd = epoll_create1(EPOLL_CLOEXEC);
+        ok = (m_event_fd >= 0) && (m_fd >= 0);
+    }
+    if (ok) {
+        ev.events = EPOLLIN;
+        ev.data.fd = m_handle->fd;
+        ok = (0 == epoll_ctl(m_fd, EPOLL_CTL_ADD, m_handle->fd, &ev));
+    }
+    if (ok) {
+        ev.data.fd = m_event_fd;
+        ok = (0 == epoll_ctl(m_fd, EPOLL_CTL_ADD, m_event_fd, &ev));
+    }
+    if (!ok) {
+        log_error("cmd_comp setup failed errno=%d\n", errno);
+        cleanup();
+        throw DCMD_EIO;
+    }
+    log_trace("cmd_comp(%p) fd: %d event_fd: %d\n", m_handle, m_fd, m_event_fd);
+}
+
+void cmd_comp::cleanup()
+{
+    if (m_fd >= 0) {
+        close(m_fd);
+        m_fd = -1;
+    }
+    if (m_event_fd >= 0) {
+        close(m_event_fd);
+        m_event_fd = -1;
+    }
+    if (m_handle) {
+        mlx5dv_devx_destroy_cmd_comp(m_handle);
+        m_handle = nullptr;
+    }
+}
+
+cmd_comp::~cmd_comp()
+{
+    cleanup();
+}
+
+int cmd_comp::get_fd()
+{
+    return m_fd;
+}
+
+int cmd_comp::get_comp(cmd_comp_hdr* resp, size_t resp_len)
+{
+    if (!resp || resp_len < sizeof(*resp)) {
+        return DCMD_EINVAL;
+    }
+
+    int ret = mlx5dv_devx_get_async_cmd_comp(m_handle, resp, resp_len);
+    if (EAGAIN == ret) {
+        return DCMD_EAGAIN;
+    }
+    if (ret) {
+        log_error("get_async_cmd_comp ret=%d\n", ret);
+        return DCMD_EIO;
+    }
+    return DCMD_EOK;
+}
+
+int cmd_comp::notify()
+{
+    uint64_t val = 1;
+
+    return (sizeof(val) == write(m_event_fd, &val, sizeof(val)) ? DCMD_EOK : DCMD_EIO);
+}
+
+int cmd_comp::ack_notify()
+{
+    uint64_t val = 0;
+
+    // Nothing to read is not an error: the counter was already reset
+    if (read(m_event_fd, &val, sizeof(val)) < 0 && EAGAIN != errno) {
+        return DCMD_EIO;
+    }
+    return DCMD_EOK;
+}
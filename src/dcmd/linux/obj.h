@@ -35,6 +35,33 @@
 
 namespace dcmd {
 
+/*
+ * Completion channel for asynchronous DevX commands.
+ * get_fd() becomes readable when either an asynchronous command response
+ * is queued on the channel or notify() was called; both are level triggered.
+ */
+class cmd_comp {
+public:
+    cmd_comp(ctx_handle handle);
+    virtual ~cmd_comp();
+
+    cmd_comp_handle get_handle()
+    {
+        return m_handle;
+    }
+    int get_fd();
+    int get_comp(cmd_comp_hdr* resp, size_t resp_len);
+    int notify();
+    int ack_notify();
+
+private:
+    void cleanup();
+
+    cmd_comp_handle m_handle;
+    int m_event_fd;
+    int m_fd;
+};
+
 class obj : public base_obj {
 public:
     obj()
@@ -46,6 +73,7 @@ public:
 
     int query(struct obj_desc* desc);
     int modify(struct obj_desc* desc);
+    int query_async(struct obj_desc* desc, uint64_t wr_id, cmd_comp& comp);
 
     uintptr_t get_handle()
     {
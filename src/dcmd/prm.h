@@ -1224,7 +1224,8 @@ struct mlx5_ifc_cmd_hca_cap_bits {
     u8 reserved_at_2e0[0x7];
     u8 max_qp_mcg[0x19];
 
-    u8 reserved_at_300[0x18];
+    u8 reserved_at_300[0x10];
+    u8 flow_counter_bulk_alloc[0x8];
     u8 log_max_mcg[0x8];
 
     u8 reserved_at_320[0x3];
@@ -8113,7 +8114,8 @@ struct mlx5_ifc_alloc_flow_counter_in_bits {
     u8 reserved_at_20[0x10];
     u8 op_mod[0x10];
 
-    u8 reserved_at_40[0x40];
+    u8 reserved_at_40[0x38];
+    u8 flow_counter_bulk[0x8];
 };
 
 struct mlx5_ifc_add_vxlan_udp_dport_out_bits {
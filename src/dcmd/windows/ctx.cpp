@@ -77,6 +77,19 @@ obj* ctx::create_obj(struct obj_desc* desc)
     return obj_ptr;
 }
 
+cmd_comp* ctx::create_cmd_comp()
+{
+    cmd_comp* comp_ptr = nullptr;
+
+    try {
+        comp_ptr = new cmd_comp(m_handle);
+    } catch (...) {
+        return nullptr;
+    }
+
+    return comp_ptr;
+}
+
 uar* ctx::create_uar(struct uar_desc* desc)
 {
     uar* obj_ptr = nullptr;
@@ -116,6 +129,19 @@ flow* ctx::create_flow(struct flow_desc* desc)
     return obj_ptr;
 }
 
+flow_matcher* ctx::create_flow_matcher(struct flow_matcher_desc* desc)
+{
+    flow_matcher* obj_ptr = nullptr;
+
+    try {
+        obj_ptr = new flow_matcher(m_handle, desc);
+    } catch (...) {
+        return nullptr;
+    }
+
+    return obj_ptr;
+}
+
 int ctx::query_eqn(uint32_t cpu_num, uint32_t& eqn)
 {
     int ret = devx_query_eqn(m_handle, cpu_num, &eqn);
@@ -123,6 +149,18 @@ int ctx::query_eqn(uint32_t cpu_num, uint32_t& eqn)
     return (ret ? DCMD_EIO : DCMD_EOK);
 }
 
+int ctx::get_numa_node()
+{
+    return -1;
+}
+
+int ctx::query_comp_vector(uint32_t cpu, uint32_t& vector)
+{
+    UNUSED(cpu);
+    UNUSED(vector);
+    return DCMD_ENOTSUP;
+}
+
 int ctx::hca_iseg_mapping()
 {
     uint32_t cb_iseg;
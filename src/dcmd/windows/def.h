@@ -207,6 +207,14 @@ typedef struct mlx5dv_devx_umem* umem_handle;
 typedef struct mlx5dv_devx_uar* uar_handle;
 typedef struct devx_obj_handle* flow_handle;
 typedef devx_pp_handle pp_handle;
+typedef void* cmd_comp_handle;
+#pragma warning(push)
+#pragma warning(disable : 4200)
+typedef struct {
+    uint64_t wr_id;
+    uint8_t out_data[0];
+} cmd_comp_hdr;
+#pragma warning(pop)
 
 inline uint32_t get_pp_index(pp_handle* pp)
 {
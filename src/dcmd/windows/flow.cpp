@@ -34,6 +34,19 @@
 
 using namespace dcmd;
 
+flow_matcher::flow_matcher(ctx_handle handle, struct flow_matcher_desc* desc)
+    : m_handle(nullptr)
+{
+    UNUSED(handle);
+    UNUSED(desc);
+    // Rules carry their match criteria on Windows
+    throw DCMD_ENOTSUP;
+}
+
+flow_matcher::~flow_matcher()
+{
+}
+
 flow::flow(ctx_handle handle, struct flow_desc* desc)
 {
     if (!desc->num_dst_obj) {
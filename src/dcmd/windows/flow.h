@@ -38,6 +38,20 @@
 
 namespace dcmd {
 
+class flow_matcher {
+public:
+    flow_matcher(ctx_handle handle, struct flow_matcher_desc* desc);
+    virtual ~flow_matcher();
+
+    struct mlx5dv_flow_matcher* get_handle()
+    {
+        return m_handle;
+    }
+
+private:
+    struct mlx5dv_flow_matcher* m_handle;
+};
+
 class flow : public base_flow {
 public:
     flow()
@@ -90,3 +90,52 @@ int obj::modify(struct obj_desc* desc)
         mlx5dv_devx_obj_modify(m_ctx_handle, (void*)desc->in, desc->inlen, desc->out, desc->outlen);
     return (ret ? DCMD_EIO : DCMD_EOK);
 }
+
+int obj::query_async(struct obj_desc* desc, uint64_t wr_id, cmd_comp& comp)
+{
+    UNUSED(desc);
+    UNUSED(wr_id);
+    UNUSED(comp);
+    return DCMD_ENOTSUP;
+}
+
+cmd_comp::cmd_comp(ctx_handle handle)
+    : m_handle(nullptr)
+    , m_event_fd(-1)
+    , m_fd(-1)
+{
+    UNUSED(handle);
+    // DevX asynchronous command completion is not exposed on Windows
+    throw DCMD_ENOTSUP;
+}
+
+void cmd_comp::cleanup()
+{
+}
+
+cmd_comp::~cmd_comp()
+{
+    cleanup();
+}
+
+int cmd_comp::get_fd()
+{
+    return m_fd;
+}
+
+int cmd_comp::get_comp(cmd_comp_hdr* resp, size_t resp_len)
+{
+    UNUSED(resp);
+    UNUSED(resp_len);
+    return DCMD_ENOTSUP;
+}
+
+int cmd_comp::notify()
+{
+    return DCMD_ENOTSUP;
+}
+
+int cmd_comp::ack_notify()
+{
+    return DCMD_ENOTSUP;
+}
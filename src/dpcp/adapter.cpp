@@ -487,6 +487,12 @@ static void store_hca_flow_table_nic_receive_caps(adapter_hca_capabilities* exte
     log_trace("Capability - flow_table_caps.receive.max_log_num_of_flow_rule: %d\n",
               external_hca_caps->flow_table_caps.receive.max_log_num_of_flow_rule);
 
+    external_hca_caps->flow_table_caps.receive.is_flow_action_counter_supported =
+        DEVX_GET(query_hca_cap_out, caps_map.find(MLX5_CAP_FLOW_TABLE)->second,
+                 capability.flow_table_nic_cap.flow_table_properties_nic_receive.flow_counter);
+    log_trace("Capability - flow_table_caps.receive.is_flow_action_counter_supported: %d\n",
+              external_hca_caps->flow_table_caps.receive.is_flow_action_counter_supported);
+
     external_hca_caps->flow_table_caps.receive.is_flow_action_reparse_supported =
         DEVX_GET(query_hca_cap_out, caps_map.find(MLX5_CAP_FLOW_TABLE)->second,
                  capability.flow_table_nic_cap.flow_table_properties_nic_receive.reparse);
@@ -616,6 +622,77 @@ static void store_hca_nvmeotcp_caps(adapter_hca_capabilities* external_hca_caps,
     }
 }
 
+static void store_hca_cqe_compression_caps(adapter_hca_capabilities* external_hca_caps,
+                                           const caps_map_t& caps_map)
+{
+    void* hcattr = caps_map.find(MLX5_CAP_GENERAL)->second;
+
+    external_hca_caps->cqe_compression =
+        DEVX_GET(query_hca_cap_out, hcattr, capability.cmd_hca_cap.cqe_compression);
+    log_trace("Capability - cqe_compression: %d\n", external_hca_caps->cqe_compression);
+
+    external_hca_caps->mini_cqe_resp_stride_index =
+        DEVX_GET(query_hca_cap_out, hcattr, capability.cmd_hca_cap.mini_cqe_resp_stride_index);
+    log_trace("Capability - mini_cqe_resp_stride_index: %d\n",
+              external_hca_caps->mini_cqe_resp_stride_index);
+
+    external_hca_caps->cqe_compression_timeout =
+        DEVX_GET(query_hca_cap_out, hcattr, capability.cmd_hca_cap.cqe_compression_timeout);
+    log_trace("Capability - cqe_compression_timeout: %d\n",
+              external_hca_caps->cqe_compression_timeout);
+
+    external_hca_caps->cqe_compression_max_num =
+        DEVX_GET(query_hca_cap_out, hcattr, capability.cmd_hca_cap.cqe_compression_max_num);
+    log_trace("Capability - cqe_compression_max_num: %d\n",
+              external_hca_caps->cqe_compression_max_num);
+}
+
+static void store_hca_lso_caps(adapter_hca_capabilities* external_hca_caps,
+                               const caps_map_t& caps_map)
+{
+    caps_map_t::const_iterator iter = caps_map.find(MLX5_CAP_ETHERNET_OFFLOADS);
+    void* hcattr;
+
+    if (iter == caps_map.end()) {
+        log_fatal("Incorrect caps_map object\n");
+        return;
+    }
+
+    hcattr = DEVX_ADDR_OF(query_hca_cap_out, iter->second, capability);
+
+    external_hca_caps->max_lso_cap =
+        DEVX_GET(per_protocol_networking_offload_caps, hcattr, max_lso_cap);
+    log_trace("Capability - max_lso_cap: %d\n", external_hca_caps->max_lso_cap);
+}
+
+static void store_hca_flow_counter_bulk_alloc_caps(adapter_hca_capabilities* external_hca_caps,
+                                                   const caps_map_t& caps_map)
+{
+    external_hca_caps->flow_counter_bulk_alloc =
+        DEVX_GET(query_hca_cap_out, caps_map.find(MLX5_CAP_GENERAL)->second,
+                 capability.cmd_hca_cap.flow_counter_bulk_alloc);
+    log_trace("Capability - flow_counter_bulk_alloc: 0x%x\n",
+              external_hca_caps->flow_counter_bulk_alloc);
+}
+
+static void store_hca_reg_umr_sq_caps(adapter_hca_capabilities* external_hca_caps,
+                                      const caps_map_t& caps_map)
+{
+    caps_map_t::const_iterator iter = caps_map.find(MLX5_CAP_ETHERNET_OFFLOADS);
+    void* hcattr;
+
+    if (iter == caps_map.end()) {
+        log_fatal("Incorrect caps_map object\n");
+        return;
+    }
+
+    hcattr = DEVX_ADDR_OF(query_hca_cap_out, iter->second, capability);
+
+    external_hca_caps->reg_umr_sq =
+        DEVX_GET(per_protocol_networking_offload_caps, hcattr, reg_umr_sq);
+    log_trace("Capability - reg_umr_sq: %d\n", external_hca_caps->reg_umr_sq);
+}
+
 static const std::vector<cap_cb_fn> caps_callbacks = {
     store_hca_device_frequency_khz_caps,
     store_hca_tls_caps,
@@ -633,6 +710,10 @@ static const std::vector<cap_cb_fn> caps_callbacks = {
     store_hca_flow_table_nic_receive_caps,
     store_hca_crypto_caps,
     store_hca_nvmeotcp_caps,
+    store_hca_cqe_compression_caps,
+    store_hca_lso_caps,
+    store_hca_reg_umr_sq_caps,
+    store_hca_flow_counter_bulk_alloc_caps,
 };
 
 status pd_devx::create()
@@ -688,6 +769,47 @@ status td::create()
     return ret;
 }
 
+void* alloc_ring_buf(ring_alloc_mode mode, int numa_node, size_t sz, size_t& map_sz)
+{
+    size_t page_sz = get_page_size();
+    size_t len = sz;
+    void* buf = nullptr;
+
+    map_sz = 0;
+    if (RING_ALLOC_DEFAULT != mode) {
+        size_t huge_sz = (RING_ALLOC_HUGEPAGE_1G == mode) ? (1UL << 30) : (1UL << 21);
+        // Ring is rounded up to whole huge pages, do not waste more than half of the page.
+        if (sz >= huge_sz / 2) {
+            buf = page_alloc(len, huge_sz, numa_node);
+            if (buf) {
+                map_sz = len;
+                return buf;
+            }
+            log_trace("Huge pages are not available for %zd bytes ring, use regular pages\n",
+                      sz);
+        }
+    }
+    if (numa_node >= 0) {
+        buf = page_alloc(len, page_sz, numa_node);
+        if (buf) {
+            map_sz = len;
+            return buf;
+        }
+    }
+    // Registered memory must be aligned and multiple of page-size.
+    buf = ::aligned_alloc(page_sz, (sz + page_sz - 1) & ~(page_sz - 1));
+    return buf;
+}
+
+void free_ring_buf(void* buf, size_t map_sz)
+{
+    if (map_sz) {
+        page_free(buf, map_sz);
+    } else {
+        ::aligned_free(buf);
+    }
+}
+
 adapter::adapter(dcmd::device* dev, dcmd::ctx* ctx)
     : m_dcmd_dev(dev)
     , m_dcmd_ctx(ctx)
@@ -703,6 +825,11 @@ adapter::adapter(dcmd::device* dev, dcmd::ctx* ctx)
     , m_external_hca_caps(nullptr)
     , m_caps_callbacks(caps_callbacks)
     , m_opened(false)
+    , m_ring_alloc_mode(RING_ALLOC_DEFAULT)
+    , m_device_numa_node(-1)
+    , m_numa_node(-1)
+    , m_umem_arena(nullptr)
+    , m_mkey_cache(nullptr)
     , m_flow_action_generator(m_dcmd_ctx, m_external_hca_caps)
 {
     for (auto cap_type : s_supported_cap_types) {
@@ -711,6 +838,28 @@ adapter::adapter(dcmd::device* dev, dcmd::ctx* ctx)
 
     query_hca_caps();
     set_external_hca_caps();
+
+    m_device_numa_node = m_dcmd_ctx->get_numa_node();
+}
+
+status adapter::enable_umem_arena(size_t chunk_sz)
+{
+    if (m_umem_arena) {
+        return DPCP_OK;
+    }
+    umem_arena* arena =
+        new (std::nothrow) umem_arena(m_dcmd_ctx, chunk_sz, m_ring_alloc_mode, m_numa_node);
+    if (nullptr == arena) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = arena->init();
+    if (DPCP_OK != ret) {
+        delete arena;
+        return ret;
+    }
+    m_umem_arena = arena;
+    log_trace("UMEM arena enabled chunk_sz: 0x%zx\n", chunk_sz);
+    return DPCP_OK;
 }
 
 status adapter::set_pd(uint32_t pdn, void* ibv_pd)
@@ -875,6 +1024,26 @@ status adapter::create_tir(const tir::attr& tir_attr, tir*& tir_obj)
     return DPCP_OK;
 }
 
+status adapter::create_rqt(const std::vector<uint32_t>& rqns, rqt*& rqt_obj, uint32_t max_size)
+{
+    status ret = DPCP_OK;
+    rqt* _rqt_obj = nullptr;
+
+    _rqt_obj = new (std::nothrow) rqt(get_ctx());
+    if (nullptr == _rqt_obj) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    ret = _rqt_obj->create(rqns, max_size);
+    if (DPCP_OK != ret) {
+        delete _rqt_obj;
+        return DPCP_ERR_CREATE;
+    }
+    rqt_obj = _rqt_obj;
+
+    return DPCP_OK;
+}
+
 status adapter::create_tis(const tis::attr& tis_attr, tis*& tis_obj)
 {
     status ret = DPCP_OK;
@@ -978,6 +1147,111 @@ status adapter::create_reserved_mkey(reserved_mkey_type type, void* address, siz
     return DPCP_OK;
 }
 
+status adapter::create_klm_mkey(void* addr, mkey_flags flags, size_t entries_num,
+                                const klm_mkey_entry entries[], klm_mkey*& kmk)
+{
+    if (0 == entries_num || nullptr == entries) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    for (size_t i = 0; i < entries_num; i++) {
+        if (nullptr == entries[i].m_key || 0 == entries[i].m_length ||
+            entries[i].m_length > UINT32_MAX) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+    }
+    kmk = new (std::nothrow) klm_mkey(this, addr, flags, entries_num, entries);
+    log_trace("klm mkey: %p\n", kmk);
+    if (nullptr == kmk) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    // Create MKey
+    status ret = kmk->create();
+    if (DPCP_OK != ret) {
+        delete kmk;
+        return DPCP_ERR_CREATE;
+    }
+
+    return DPCP_OK;
+}
+
+status adapter::create_umr_queue(uint32_t depth, umr_queue*& uq)
+{
+    if (m_is_caps_available && !m_external_hca_caps->reg_umr_sq) {
+        log_error("UMR on SQ is not supported\n");
+        return DPCP_ERR_NO_SUPPORT;
+    }
+    uq = new (std::nothrow) umr_queue(this);
+    if (nullptr == uq) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = uq->init(depth);
+    if (DPCP_OK != ret) {
+        delete uq;
+        uq = nullptr;
+    }
+    return ret;
+}
+
+status adapter::create_cmd_engine(uint32_t num_workers, cmd_engine*& engine)
+{
+    engine = new (std::nothrow) cmd_engine(m_dcmd_ctx);
+    if (nullptr == engine) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = engine->init(num_workers);
+    if (DPCP_OK != ret) {
+        delete engine;
+        engine = nullptr;
+    }
+    return ret;
+}
+
+status adapter::create_rss_table(const std::vector<uint32_t>& rqns, uint32_t num_buckets,
+                                 rss_table*& table)
+{
+    table = new (std::nothrow) rss_table(m_dcmd_ctx);
+    if (nullptr == table) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = table->init(rqns, num_buckets);
+    if (DPCP_OK != ret) {
+        delete table;
+        table = nullptr;
+    }
+    return ret;
+}
+
+status adapter::create_flow_table_switch(const flow_table_attr& attr,
+                                         flow_table_switch*& table_switch)
+{
+    table_switch = new (std::nothrow) flow_table_switch(this);
+    if (nullptr == table_switch) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = table_switch->init(attr);
+    if (DPCP_OK != ret) {
+        delete table_switch;
+        table_switch = nullptr;
+    }
+    return ret;
+}
+
+status adapter::create_flow_counter_bulk(uint32_t num, flow_counter_bulk*& bulk)
+{
+    bulk = new (std::nothrow) flow_counter_bulk(m_dcmd_ctx);
+    if (nullptr == bulk) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    // Bulk sizes are not limited if capabilities are unknown
+    status ret =
+        bulk->init(num, m_is_caps_available ? m_external_hca_caps->flow_counter_bulk_alloc : 0xFF);
+    if (DPCP_OK != ret) {
+        delete bulk;
+        bulk = nullptr;
+    }
+    return ret;
+}
+
 status adapter::create_ref_mkey(mkey* parent, void* address, size_t length, ref_mkey*& mkey)
 {
     mkey = new (std::nothrow) ref_mkey(this, address, length);
@@ -1002,6 +1276,43 @@ status adapter::create_extern_mkey(void* address, size_t length, uint32_t id, ex
     return (nullptr == mkey) ? DPCP_ERR_NO_MEMORY : DPCP_OK;
 }
 
+status adapter::enable_mkey_cache(size_t max_unused)
+{
+    if (m_mkey_cache) {
+        return DPCP_OK;
+    }
+    m_mkey_cache = new (std::nothrow) mkey_cache(this, max_unused);
+    if (nullptr == m_mkey_cache) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    log_trace("mkey cache enabled max_unused: %zd\n", max_unused);
+    return DPCP_OK;
+}
+
+status adapter::get_cached_mkey(void* address, size_t length, mkey_flags flags, mkey*& mkey)
+{
+    if (nullptr == m_mkey_cache) {
+        return DPCP_ERR_NO_CONTEXT;
+    }
+    return m_mkey_cache->get(address, length, flags, mkey);
+}
+
+status adapter::put_cached_mkey(mkey* mkey)
+{
+    if (nullptr == m_mkey_cache) {
+        return DPCP_ERR_NO_CONTEXT;
+    }
+    return m_mkey_cache->put(mkey);
+}
+
+status adapter::invalidate_cached_mkeys(void* address, size_t length)
+{
+    if (nullptr == m_mkey_cache) {
+        return DPCP_ERR_NO_CONTEXT;
+    }
+    return m_mkey_cache->invalidate(address, length);
+}
+
 status adapter::create_cq(const cq_attr& attrs, cq*& out_cq)
 {
     // CQ_SIZE is mandatory
@@ -1012,6 +1323,23 @@ status adapter::create_cq(const cq_attr& attrs, cq*& out_cq)
     if (!attrs.cq_attr_use.test(CQ_EQ_NUM)) {
         return DPCP_ERR_INVALID_PARAM;
     }
+    if (attrs.flags.test(ATTR_CQ_CQE_COMPRESSION_FLAG)) {
+        if (CQ_MINI_CQE_FORMAT_HASH != attrs.mini_cqe_format &&
+            CQ_MINI_CQE_FORMAT_CSUM != attrs.mini_cqe_format &&
+            CQ_MINI_CQE_FORMAT_CSUM_STRIDX != attrs.mini_cqe_format) {
+            log_error("Unknown mini CQE format %d\n", attrs.mini_cqe_format);
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        if (m_is_caps_available && !m_external_hca_caps->cqe_compression) {
+            log_error("CQE compression is not supported\n");
+            return DPCP_ERR_NO_SUPPORT;
+        }
+        if (m_is_caps_available && CQ_MINI_CQE_FORMAT_CSUM_STRIDX == attrs.mini_cqe_format &&
+            !m_external_hca_caps->mini_cqe_resp_stride_index) {
+            log_error("Mini CQE stride index format is not supported\n");
+            return DPCP_ERR_NO_SUPPORT;
+        }
+    }
 
     if (nullptr == m_uarpool) {
         // Allocate UAR pool
@@ -1036,6 +1364,19 @@ status adapter::create_cq(const cq_attr& attrs, cq*& out_cq)
         delete cq64;
         return ret;
     }
+    if (m_umem_arena) {
+        // CQ Buf and DB are carved out of already registered UMEM
+        ret = cq64->alloc_from_arena(m_umem_arena);
+        if (DPCP_OK == ret) {
+            ret = cq64->init(&uar_p);
+        }
+        if (DPCP_OK == ret) {
+            out_cq = cq64;
+        } else {
+            delete cq64;
+        }
+        return ret;
+    }
     // Allocate CQ Buf
     void* cq_buf = nullptr;
     size_t cq_buf_sz = cq64->get_cq_buf_sz();
@@ -1101,6 +1442,14 @@ status adapter::prepare_basic_rq(basic_rq& srq)
     if (DPCP_OK != ret) {
         return ret;
     }
+    if (m_umem_arena) {
+        // WQ Buf and DB are carved out of already registered UMEM
+        ret = srq.alloc_from_arena(m_umem_arena);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        return srq.init(&uar_p);
+    }
     // Allocate WQ Buf
     void* wq_buf = nullptr;
     size_t wq_buf_sz = srq.get_wq_buf_sz();
@@ -1291,6 +1640,16 @@ status adapter::query_eqn(uint32_t& eqn, uint32_t cpu_vector)
     return DPCP_ERR_QUERY;
 }
 
+status adapter::query_eqn_by_cpu(uint32_t& eqn, uint32_t cpu)
+{
+    uint32_t vector = 0;
+    if (m_dcmd_ctx->query_comp_vector(cpu, vector)) {
+        log_trace("query_eqn_by_cpu: no completion vector for cpu %u\n", cpu);
+        return DPCP_ERR_NO_SUPPORT;
+    }
+    return query_eqn(eqn, vector);
+}
+
 status adapter::create_pp_sq(sq_attr& sq_attr, pp_sq*& packet_pacing_sq)
 {
     if (nullptr == m_uarpool) {
@@ -1315,6 +1674,14 @@ status adapter::create_pp_sq(sq_attr& sq_attr, pp_sq*& packet_pacing_sq)
     if (DPCP_OK != ret) {
         return ret;
     }
+    if (m_umem_arena) {
+        // WQ Buf and DB are carved out of already registered UMEM
+        ret = ppsq->alloc_from_arena(m_umem_arena);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        return ppsq->init(&uar_p);
+    }
     // Allocate WQ Buf
     void* wq_buf = nullptr;
     size_t wq_buf_sz = ppsq->get_wq_buf_sz();
@@ -1466,6 +1833,10 @@ adapter::~adapter()
 {
     m_is_caps_available = false;
 
+    if (m_mkey_cache) {
+        delete m_mkey_cache;
+        m_mkey_cache = nullptr;
+    }
     if (m_pd) {
         delete m_pd;
         m_pd = nullptr;
@@ -1478,6 +1849,10 @@ adapter::~adapter()
         delete m_uarpool;
         m_uarpool = nullptr;
     }
+    if (m_umem_arena) {
+        delete m_umem_arena;
+        m_umem_arena = nullptr;
+    }
     for (auto cap_type : m_caps) {
         free(cap_type.second);
     }
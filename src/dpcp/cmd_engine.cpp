@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+cmd_engine::cmd_engine(dcmd::ctx* ctx)
+    : m_ctx(ctx)
+    , m_comp(nullptr)
+    , m_workers()
+    , m_lock()
+    , m_cv()
+    , m_cmds()
+    , m_done()
+    , m_queries()
+    , m_resp()
+    , m_wr_id(0)
+    , m_outstanding(0)
+    , m_stop(false)
+{
+}
+
+status cmd_engine::init(uint32_t num_workers)
+{
+    if (nullptr == m_ctx) {
+        return DPCP_ERR_NO_CONTEXT;
+    }
+    if (0 == num_workers) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    m_comp = m_ctx->create_cmd_comp();
+    if (nullptr == m_comp) {
+        log_error("Async command completion channel is not supported\n");
+        return DPCP_ERR_NO_SUPPORT;
+    }
+    m_resp.resize(sizeof(cmd_comp_hdr));
+
+    try {
+        for (uint32_t i = 0; i < num_workers; i++) {
+            m_workers.emplace_back(&cmd_engine::worker, this);
+        }
+    } catch (...) {
+        log_error("Failed to start %u command workers\n", num_workers);
+        return DPCP_ERR_NO_MEMORY;
+    }
+    log_trace("cmd_engine %p fd: %d workers: %u\n", this, m_comp->get_fd(), num_workers);
+
+    return DPCP_OK;
+}
+
+cmd_engine::~cmd_engine()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        // Commands not started yet are dropped
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    delete m_comp;
+}
+
+void cmd_engine::worker()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    while (true) {
+        m_cv.wait(lock, [this]() { return m_stop || !m_cmds.empty(); });
+        if (m_stop) {
+            return;
+        }
+        cmd_t cmd = std::move(m_cmds.front());
+        m_cmds.pop_front();
+
+        lock.unlock();
+        status ret = cmd.first();
+        lock.lock();
+
+        cmd_completion comp = {cmd.second, ret};
+        m_done.push_back(comp);
+        m_comp->notify();
+    }
+}
+
+status cmd_engine::submit(std::function<status()> cmd, uint64_t cookie)
+{
+    if (!cmd) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_cmds.emplace_back(std::move(cmd), cookie);
+        m_outstanding++;
+    }
+    m_cv.notify_one();
+
+    return DPCP_OK;
+}
+
+status cmd_engine::exec_async(const void* in, size_t in_sz, void* out, size_t out_sz,
+                              uint64_t cookie)
+{
+    if ((nullptr == in) || (nullptr == out) || (in_sz < 16) || (out_sz < 16)) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    dcmd::ctx* ctx = m_ctx;
+    return submit(
+        [ctx, in, in_sz, out, out_sz]() {
+            int ret = ctx->exec_cmd(in, in_sz, out, out_sz);
+            if ((DCMD_EOK != ret) || DEVX_GET(general_obj_out_cmd_hdr, out, status)) {
+                log_trace("exec_async failed %d, status: %u syndrome: %x\n", ret,
+                          DEVX_GET(general_obj_out_cmd_hdr, out, status),
+                          DEVX_GET(general_obj_out_cmd_hdr, out, syndrome));
+                return DPCP_ERR_MODIFY;
+            }
+            return DPCP_OK;
+        },
+        cookie);
+}
+
+status cmd_engine::post_query(dcmd::obj* handle, const void* in, size_t in_sz, void* out,
+                              size_t out_sz, uint64_t cookie)
+{
+    if ((nullptr == handle) || (nullptr == in) || (nullptr == out)) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    struct dcmd::obj_desc desc = {in, in_sz, out, out_sz};
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    uint64_t wr_id = ++m_wr_id;
+    int ret = handle->query_async(&desc, wr_id, *m_comp);
+    if (DCMD_EOK != ret) {
+        log_error("query_async failed %d\n", ret);
+        return DPCP_ERR_QUERY;
+    }
+    query_ctx& query = m_queries[wr_id];
+    query.out = out;
+    query.out_sz = out_sz;
+    query.cookie = cookie;
+    if (m_resp.size() < sizeof(cmd_comp_hdr) + out_sz) {
+        m_resp.resize(sizeof(cmd_comp_hdr) + out_sz);
+    }
+    m_outstanding++;
+
+    return DPCP_OK;
+}
+
+status cmd_engine::poll(cmd_completion* comps, uint32_t& num)
+{
+    if ((nullptr == comps) && num) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    status ret = DPCP_OK;
+    uint32_t max_num = num;
+    num = 0;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    while ((num < max_num) && !m_done.empty()) {
+        comps[num++] = m_done.front();
+        m_done.pop_front();
+    }
+    if (m_done.empty()) {
+        m_comp->ack_notify();
+    }
+
+    cmd_comp_hdr* resp = reinterpret_cast<cmd_comp_hdr*>(m_resp.data());
+    while ((num < max_num) && !m_queries.empty()) {
+        int err = m_comp->get_comp(resp, m_resp.size());
+        if (DCMD_EAGAIN == err) {
+            break;
+        }
+        if (DCMD_EOK != err) {
+            ret = DPCP_ERR_QUERY;
+            break;
+        }
+        auto it = m_queries.find(resp->wr_id);
+        if (it == m_queries.end()) {
+            log_error("Unknown async query wr_id %llx\n", (unsigned long long)resp->wr_id);
+            continue;
+        }
+        query_ctx& query = it->second;
+        memcpy(query.out, resp->out_data, query.out_sz);
+        comps[num].cookie = query.cookie;
+        comps[num].ret = DEVX_GET(general_obj_out_cmd_hdr, query.out, status) ? DPCP_ERR_QUERY
+                                                                               : DPCP_OK;
+        num++;
+        m_queries.erase(it);
+    }
+    m_outstanding -= num;
+
+    return ret;
+}
+
+int cmd_engine::get_fd() const
+{
+    return m_comp->get_fd();
+}
+
+uint32_t cmd_engine::get_outstanding()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_outstanding;
+}
+
+} // namespace dpcp
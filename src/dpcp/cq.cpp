@@ -34,6 +34,11 @@
 
 #include <atomic>
 #include <stdlib.h>
+#if defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 #include "utils/os.h"
 #include "dcmd/dcmd.h"
@@ -41,35 +46,6 @@
 
 namespace dpcp {
 
-struct mlx5_cqe64 {
-    u8 tunneled_etc;
-    u8 rsvd0;
-    __be16 wqe_id;
-    u8 lro_tcppsh_abort_dupack;
-    u8 lro_min_ttl;
-    __be16 lro_tcp_win;
-    __be32 lro_ack_seq_num;
-    __be32 rss_hash_result;
-    u8 rss_hash_type;
-    u8 ml_path;
-    u8 rsvd20[2];
-    __be16 check_sum;
-    __be16 slid;
-    __be32 flags_rqpn;
-    u8 hds_ip_ext;
-    u8 l4_hdr_type_etc;
-    __be16 vlan_info;
-    __be32 srqn; /* [31:24]: lro_num_seg, [23:0]: srqn */
-    __be32 imm_inval_pkey;
-    u8 rsvd40[4];
-    __be32 byte_cnt;
-    __be64 timestamp;
-    __be32 sop_drop_qpn;
-    __be16 wqe_counter;
-    u8 signature;
-    u8 op_own;
-};
-
 const uint32_t MAX_CQ_SZ = 1 << 22; /* in CQE number */
 
 cq::cq(adapter* ad, const cq_attr& attrs)
@@ -83,6 +59,10 @@ cq::cq(adapter* ad, const cq_attr& attrs)
     , m_arm_db(nullptr)
     , m_db_rec_umem(nullptr)
     , m_cqe_num(0)
+    , m_cq_buf_map_sz(0)
+    , m_arena(nullptr)
+    , m_cq_buf_umem_offset(0)
+    , m_db_rec_umem_offset(0)
     , m_cq_buf_umem_id(0)
     , m_db_rec_umem_id(0)
     , m_cqn(0)
@@ -101,6 +81,14 @@ status cq::destroy()
         delete m_uar;
         m_uar = nullptr;
     }
+    // Return CQ buffer and DB record to the arena owning their UMEM
+    if (m_arena) {
+        m_arena->free(m_cq_buf);
+        m_arena->free(m_db_rec);
+        m_cq_buf = nullptr;
+        m_db_rec = nullptr;
+        m_arena = nullptr;
+    }
     // Deregister UMEM for CQ and DB
     if (m_cq_buf_umem) {
         delete m_cq_buf_umem;
@@ -130,11 +118,12 @@ cq::~cq()
 status cq::allocate_cq_buf(void*& cq_buf, size_t sz)
 {
     // Allocate CQ buffer
-    cq_buf = ::aligned_alloc(get_page_size(), sz);
+    cq_buf = alloc_ring_buf(m_adapter->get_ring_alloc_mode(), m_adapter->get_numa_node(), sz,
+                            m_cq_buf_map_sz);
     if (nullptr == cq_buf) {
         return DPCP_ERR_NO_MEMORY;
     }
-    log_trace("Allocated CQ Buf %zd -> %p\n", sz, cq_buf);
+    log_trace("Allocated CQ Buf %zd -> %p map: %zd\n", sz, cq_buf, m_cq_buf_map_sz);
     m_cq_buf = cq_buf;
     m_cq_buf_sz_bytes = (uint32_t)sz;
     return DPCP_OK;
@@ -142,7 +131,10 @@ status cq::allocate_cq_buf(void*& cq_buf, size_t sz)
 
 status cq::release_cq_buf(void* buf)
 {
-    ::aligned_free(buf);
+    free_ring_buf(buf, m_cq_buf_map_sz);
+    if (buf == m_cq_buf) {
+        m_cq_buf = nullptr;
+    }
     return DPCP_OK;
 }
 
@@ -163,6 +155,31 @@ status cq::allocate_db_rec(uint32_t*& db_rec, size_t& sz)
 status cq::release_db_rec(uint32_t* db_rec)
 {
     ::aligned_free(db_rec);
+    if (db_rec == m_db_rec) {
+        m_db_rec = nullptr;
+    }
+    return DPCP_OK;
+}
+
+status cq::alloc_from_arena(umem_arena* arena)
+{
+    void* db_rec = nullptr;
+    status ret = arena->alloc(m_cq_buf_sz_bytes, get_page_size(), m_cq_buf, m_cq_buf_umem_id,
+                              m_cq_buf_umem_offset);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = arena->alloc(64, get_cacheline_size(), db_rec, m_db_rec_umem_id, m_db_rec_umem_offset);
+    if (DPCP_OK != ret) {
+        arena->free(m_cq_buf);
+        m_cq_buf = nullptr;
+        return ret;
+    }
+    m_db_rec = (uint32_t*)db_rec;
+    m_arena = arena;
+    log_trace("CQ Buf %p umem_id: %x offset: 0x%llx DBRec %p offset: 0x%llx\n", m_cq_buf,
+              m_cq_buf_umem_id, (unsigned long long)m_cq_buf_umem_offset, m_db_rec,
+              (unsigned long long)m_db_rec_umem_offset);
     return DPCP_OK;
 }
 
@@ -206,7 +223,7 @@ status cq::create()
     size_t outlen = sizeof(out);
 
     DEVX_SET(create_cq_in, in, cq_umem_id, m_cq_buf_umem_id); // cq_umem_valid - implicit in kernel
-    DEVX_SET64(create_cq_in, in, e_mtt_pointer_or_cq_umem_offset, 0LL /*cbMemOffset*/);
+    DEVX_SET64(create_cq_in, in, e_mtt_pointer_or_cq_umem_offset, m_cq_buf_umem_offset);
 
     // Set fields in cq_ctx
     void* cq_ctx = DEVX_ADDR_OF(create_cq_in, in, cq_context);
@@ -223,7 +240,7 @@ status cq::create()
     DEVX_SET(cqc, cq_ctx, c_eqn, m_eqn);
     // dbr_umem_valid  - implicit in kernel
     DEVX_SET(cqc, cq_ctx, dbr_umem_id, m_db_rec_umem_id);
-    DEVX_SET64(cqc, cq_ctx, dbr_addr, 0x0); // cbMemOffsetDb
+    DEVX_SET64(cqc, cq_ctx, dbr_addr, m_db_rec_umem_offset); // cbMemOffsetDb
     // UAR PageId
     DEVX_SET(cqc, cq_ctx, uar_page, m_uar->m_page_id);
     // Moderation attributes
@@ -249,8 +266,13 @@ status cq::create()
         b_val = true;
         DEVX_SET(cqc, cq_ctx, oi, b_val);
     }
-    // CQ compression is disabled
-    DEVX_SET(cqc, cq_ctx, cqe_compression_en, false);
+    // CQE compression, mini CQE format is validated by adapter
+    if (m_user_attr.flags.test(ATTR_CQ_CQE_COMPRESSION_FLAG)) {
+        DEVX_SET(cqc, cq_ctx, cqe_compression_en, true);
+        DEVX_SET(cqc, cq_ctx, mini_cqe_res_format, m_user_attr.mini_cqe_format);
+    } else {
+        DEVX_SET(cqc, cq_ctx, cqe_compression_en, false);
+    }
     // Send mailbox
     DEVX_SET(create_cq_in, in, opcode, MLX5_CMD_OP_CREATE_CQ);
     status ret = obj::create(in, sizeof(in), out, outlen);
@@ -281,7 +303,7 @@ status cq::init(const uar_t* cq_uar)
     *m_uar = *cq_uar;
     // first round ownership bit is 1
     for (size_t i = 0; i < m_cqe_num; ++i) {
-        mlx5_cqe64* cqe = (mlx5_cqe64*)m_cq_buf + i;
+        cqe64* cqe = (cqe64*)m_cq_buf + i;
         cqe->op_own = 0xf1;
     }
     log_trace("use_set %s cqe num %zd eq num %d flags %s\n",
@@ -292,4 +314,91 @@ status cq::init(const uar_t* cq_uar)
 
     return ret;
 }
+
+/**
+ * @brief Copies one CQE with vector loads/stores
+ */
+static inline void cqe_copy(void* dst, const void* src)
+{
+#if defined(__AVX2__)
+    __m256i lo = _mm256_loadu_si256((const __m256i*)src);
+    __m256i hi = _mm256_loadu_si256((const __m256i*)src + 1);
+    _mm256_storeu_si256((__m256i*)dst, lo);
+    _mm256_storeu_si256((__m256i*)dst + 1, hi);
+#elif defined(__SSE2__) || defined(_M_X64)
+    __m128i v0 = _mm_loadu_si128((const __m128i*)src);
+    __m128i v1 = _mm_loadu_si128((const __m128i*)src + 1);
+    __m128i v2 = _mm_loadu_si128((const __m128i*)src + 2);
+    __m128i v3 = _mm_loadu_si128((const __m128i*)src + 3);
+    _mm_storeu_si128((__m128i*)dst, v0);
+    _mm_storeu_si128((__m128i*)dst + 1, v1);
+    _mm_storeu_si128((__m128i*)dst + 2, v2);
+    _mm_storeu_si128((__m128i*)dst + 3, v3);
+#elif defined(__ARM_NEON)
+    uint8x16_t v0 = vld1q_u8((const uint8_t*)src);
+    uint8x16_t v1 = vld1q_u8((const uint8_t*)src + 16);
+    uint8x16_t v2 = vld1q_u8((const uint8_t*)src + 32);
+    uint8x16_t v3 = vld1q_u8((const uint8_t*)src + 48);
+    vst1q_u8((uint8_t*)dst, v0);
+    vst1q_u8((uint8_t*)dst + 16, v1);
+    vst1q_u8((uint8_t*)dst + 32, v2);
+    vst1q_u8((uint8_t*)dst + 48, v3);
+#else
+    memcpy(dst, src, CQE_SIZE);
+#endif
+}
+
+uint32_t cq_poller::decompress(cqe64* cqes, uint32_t log_cqe_num, uint32_t ci,
+                               uint8_t mini_cqe_format, bool striding_rq)
+{
+    uint32_t mask = (1U << log_cqe_num) - 1;
+    cqe64 title;
+    mini_cqe8 minis[MINI_CQE_ARRAY_SIZE];
+
+    cqe_copy(&title, &cqes[ci & mask]);
+    // Title byte count holds number of CQEs in the session
+    uint32_t cqe_cnt = swap_be32(title.byte_cnt);
+    uint16_t wqe_counter = swap_be16(title.wqe_counter);
+    uint8_t opcode = title.op_own & 0xf0;
+    if (CQ_MINI_CQE_FORMAT_HASH != mini_cqe_format) {
+        title.rss_hash_type = 0;
+        title.rss_hash_result = 0;
+    }
+
+    for (uint32_t i = 0; i < cqe_cnt; i++) {
+        uint32_t idx = i % MINI_CQE_ARRAY_SIZE;
+        if (0 == idx) {
+            // First array follows the title, next ones reuse each 8th slot.
+            // Array is copied out before its slot is overwritten.
+            cqe_copy(minis, &cqes[(ci + (i ? i : 1)) & mask]);
+        }
+        const mini_cqe8& mini = minis[idx];
+        cqe64* cqe = &cqes[(ci + i) & mask];
+
+        cqe_copy(cqe, &title);
+        cqe->byte_cnt = mini.byte_cnt;
+        switch (mini_cqe_format) {
+        case CQ_MINI_CQE_FORMAT_HASH:
+            cqe->rss_hash_result = mini.rx_hash_result;
+            break;
+        case CQ_MINI_CQE_FORMAT_CSUM_STRIDX:
+            cqe->check_sum = mini.checksum_stridx[0];
+            wqe_counter = swap_be16(mini.checksum_stridx[1]);
+            break;
+        default:
+            cqe->check_sum = mini.checksum_stridx[0];
+            break;
+        }
+        cqe->wqe_counter = swap_be16(wqe_counter);
+        // Regular CQE format with the ownership of its own slot
+        cqe->op_own = (uint8_t)(opcode | (((ci + i) >> log_cqe_num) & CQE_OWNER_MASK));
+        if (striding_rq) {
+            wqe_counter += (uint16_t)((swap_be32(mini.byte_cnt) & CQE_STRIDES_MASK) >>
+                                      CQE_STRIDES_SHIFT);
+        } else {
+            wqe_counter++;
+        }
+    }
+    return cqe_cnt;
+}
 } // namespace dpcp
@@ -110,6 +110,11 @@ status dek::create(const dek::attr& dek_attr)
     return ret;
 }
 
+status dek::create_async(const dek::attr& dek_attr, cmd_engine& engine, uint64_t cookie)
+{
+    return engine.submit([this, dek_attr]() { return create(dek_attr); }, cookie);
+}
+
 status dek::modify(const dek::attr& dek_attr)
 {
     status ret = DPCP_OK;
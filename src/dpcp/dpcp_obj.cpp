@@ -172,4 +172,19 @@ status obj::query(void* in, size_t inlen, void* out, size_t& outlen)
     }
     return DPCP_OK;
 }
+
+status obj::query_async(void* in, size_t inlen, void* out, size_t outlen, cmd_engine& engine,
+                        uint64_t cookie)
+{
+    if (!m_ctx)
+        return DPCP_ERR_NO_CONTEXT;
+
+    if ((nullptr == in) || (nullptr == out) || (inlen < 16) || (outlen < 16))
+        return DPCP_ERR_INVALID_PARAM;
+
+    if (nullptr == m_obj_handle)
+        return DPCP_ERR_INVALID_ID;
+
+    return engine.post_query(m_obj_handle, in, inlen, out, outlen, cookie);
+}
 } // namespace dpcp
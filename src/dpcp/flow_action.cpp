@@ -117,7 +117,8 @@ status flow_action_modify::prepare_prm_modify_buff()
 
 status flow_action_modify::create_prm_modify()
 {
-    status ret = prepare_prm_modify_buff();
+    // In buffer is prepared once, it is the key of the action in the generator cache.
+    status ret = m_in ? DPCP_OK : prepare_prm_modify_buff();
     if (ret != DPCP_OK) {
         log_error("Failed to prepare modify create buffer, status %d\n", ret);
         return ret;
@@ -143,6 +144,8 @@ status flow_action_modify::apply(void* in)
 {
     status ret = DPCP_OK;
 
+    // Same action may be shared by flow rules of different threads.
+    std::lock_guard<std::mutex> guard(m_lock);
     if (!m_is_valid) {
         ret = create_prm_modify();
         if (ret != DPCP_OK) {
@@ -227,8 +230,9 @@ status flow_action_modify::apply(dcmd::flow_desc& flow_desc)
 {
     status ret = DPCP_OK;
 
+    std::lock_guard<std::mutex> guard(m_lock);
     if (!m_actions_root) {
-        ret = prepare_prm_modify_buff();
+        ret = m_in ? DPCP_OK : prepare_prm_modify_buff();
         if (ret != DPCP_OK) {
             log_error("Flow Action modify failed prepare prm buffer, ret %d\n", ret);
             return ret;
@@ -314,22 +318,22 @@ status flow_action_reformat::alloc_reformat_insert_action(std::unique_ptr<uint8_
     return DPCP_OK;
 }
 
+// HW object is created by @ref flow_action_generator::create_reformat, unless an identical
+// reformat action exists.
 flow_action_reformat::flow_action_reformat(dcmd::ctx* ctx, flow_action_reformat_attr& attr)
     : flow_action(ctx)
     , m_attr(attr)
     , m_is_valid(false)
     , m_reformat_id(0)
+    , m_in()
+    , m_inlen(0)
 {
-    uint32_t out[DEVX_ST_SZ_DW(alloc_packet_reformat_context_out)] = {0};
-    size_t out_len = DEVX_ST_SZ_BYTES(alloc_packet_reformat_context_out);
-    std::unique_ptr<uint8_t[]> in_mem_guard;
-    size_t in_len = 0;
     status ret = DPCP_OK;
 
     // Allocate reformat action by type.
     switch (m_attr.type) {
     case flow_action_reformat_type::INSERT_HDR:
-        ret = alloc_reformat_insert_action(in_mem_guard, in_len, m_attr);
+        ret = alloc_reformat_insert_action(m_in, m_inlen, m_attr);
         break;
     default:
         log_error("Flow action reformat, not supported type %d\n", m_attr.type);
@@ -337,15 +341,24 @@ flow_action_reformat::flow_action_reformat(dcmd::ctx* ctx, flow_action_reformat_
     }
     if (ret != DPCP_OK) {
         log_error("Flow action reformat from type 0x%x faile with error %d\n", m_attr.type, ret);
-        return;
+        m_in.reset();
+    }
+}
+
+status flow_action_reformat::create_prm_reformat()
+{
+    uint32_t out[DEVX_ST_SZ_DW(alloc_packet_reformat_context_out)] = {0};
+    size_t out_len = DEVX_ST_SZ_BYTES(alloc_packet_reformat_context_out);
+
+    if (!m_in) {
+        return DPCP_ERR_INVALID_PARAM;
     }
 
     // Create flow group HW object.
-    void* in = in_mem_guard.get();
-    ret = obj::create(in, in_len, out, out_len);
+    status ret = obj::create(m_in.get(), m_inlen, out, out_len);
     if (ret != DPCP_OK) {
         log_error("Flow action reformat HW object create failed\n");
-        return;
+        return ret;
     }
     m_reformat_id = DEVX_GET(alloc_packet_reformat_context_out, out, packet_reformat_id);
 
@@ -354,6 +367,7 @@ flow_action_reformat::flow_action_reformat(dcmd::ctx* ctx, flow_action_reformat_
 
     // reformat creation was successful.
     m_is_valid = true;
+    return DPCP_OK;
 }
 
 flow_action_reformat::~flow_action_reformat()
@@ -551,6 +565,44 @@ status flow_action_reparse::apply(dcmd::flow_desc& flow_desc)
     return DPCP_ERR_NO_SUPPORT;
 }
 
+////////////////////////////////////////////////////////////////////////
+// flow_action_counter implementation.                                //
+////////////////////////////////////////////////////////////////////////
+
+flow_action_counter::flow_action_counter(dcmd::ctx* ctx, uint32_t counter_id)
+    : flow_action(ctx)
+    , m_counter_id(counter_id)
+{
+}
+
+status flow_action_counter::apply(void* in)
+{
+    void* in_flow_context = DEVX_ADDR_OF(set_fte_in, in, flow_context);
+    void* in_dests = DEVX_ADDR_OF(flow_context, in_flow_context, destination);
+
+    // Counter list follows destination list, should be applied after forward action.
+    uint32_t dest_list_size = DEVX_GET(flow_context, in_flow_context, destination_list_size);
+    uint8_t* counter = reinterpret_cast<uint8_t*>(in_dests) +
+        dest_list_size * DEVX_ST_SZ_BYTES(dest_format_struct);
+    DEVX_SET(flow_counter_list, counter, flow_counter_id, m_counter_id);
+
+    // Enable count action.
+    uint32_t action_enabled = DEVX_GET(flow_context, in_flow_context, action);
+    action_enabled |= MLX5_FLOW_CONTEXT_ACTION_COUNT;
+    DEVX_SET(flow_context, in_flow_context, action, action_enabled);
+    DEVX_SET(flow_context, in_flow_context, flow_counter_list_size, 1);
+
+    log_trace("Flow Action counter 0x%x was applied\n", m_counter_id);
+    return DPCP_OK;
+}
+
+status flow_action_counter::apply(dcmd::flow_desc& flow_desc)
+{
+    NOT_IN_USE(flow_desc);
+    log_error("Flow Action counter is not supported on root table\n");
+    return DPCP_ERR_NO_SUPPORT;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // flow_action_generator implemitation.                               //
 ////////////////////////////////////////////////////////////////////////
@@ -558,9 +610,68 @@ status flow_action_reparse::apply(dcmd::flow_desc& flow_desc)
 flow_action_generator::flow_action_generator(dcmd::ctx* ctx, const adapter_hca_capabilities* caps)
     : m_ctx(ctx)
     , m_caps(caps)
+    , m_cache_lock()
+    , m_action_cache()
+    , m_cache_purge_size(64)
 {
 }
 
+static inline uint64_t hash_prm_buff(const uint8_t* in, size_t in_len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < in_len; i++) {
+        hash = (hash ^ in[i]) * 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief: Returns action with identical PRM in buffer if exists, otherwise creates HW object
+ *         of the new action by create (if set) and adds it to the cache.
+ *         Expired entries are dropped on the way.
+ */
+template <class FA>
+std::shared_ptr<flow_action> flow_action_generator::get_cached_action(FA* action,
+                                                                      status (FA::*create)())
+{
+    std::shared_ptr<flow_action> fa(action);
+    uint64_t hash = hash_prm_buff(action->m_in.get(), action->m_inlen);
+
+    std::lock_guard<std::mutex> guard(m_cache_lock);
+    auto range = m_action_cache.equal_range(hash);
+    for (auto it = range.first; it != range.second;) {
+        std::shared_ptr<flow_action> locked = it->second.lock();
+        if (!locked) {
+            it = m_action_cache.erase(it);
+            continue;
+        }
+        std::shared_ptr<FA> cached = std::dynamic_pointer_cast<FA>(locked);
+        if (cached && cached->m_in && cached->m_inlen == action->m_inlen &&
+            !memcmp(cached->m_in.get(), action->m_in.get(), action->m_inlen)) {
+            log_trace("Flow Action shared, hash 0x%llx\n", (unsigned long long)hash);
+            return cached;
+        }
+        ++it;
+    }
+
+    if (create && (action->*create)() != DPCP_OK) {
+        return fa;
+    }
+
+    // Keep cache size proportional to live actions.
+    if (m_action_cache.size() >= m_cache_purge_size) {
+        for (auto it = m_action_cache.begin(); it != m_action_cache.end();) {
+            it = it->second.expired() ? m_action_cache.erase(it) : std::next(it);
+        }
+        m_cache_purge_size = std::max<size_t>(64, m_action_cache.size() * 2);
+    }
+    m_action_cache.insert(std::make_pair(hash, std::weak_ptr<flow_action>(fa)));
+
+    return fa;
+}
+
 // TODO: Need to add acpabilities check for all Flow Actions, i added the adapter_hca_capabilities
 // To the flow_action_generator, but we need to think if to do it here or inside flow_rule_ex
 // because we have some complex capabilities check like reformat + modify. Also the caps should be
@@ -578,12 +689,23 @@ std::shared_ptr<flow_action> flow_action_generator::create_tag(uint32_t id)
 
 std::shared_ptr<flow_action> flow_action_generator::create_reformat(flow_action_reformat_attr& attr)
 {
-    return std::shared_ptr<flow_action>(new (std::nothrow) flow_action_reformat(m_ctx, attr));
+    flow_action_reformat* fa = new (std::nothrow) flow_action_reformat(m_ctx, attr);
+    if (!fa || !fa->m_in) {
+        return std::shared_ptr<flow_action>(fa);
+    }
+
+    return get_cached_action(fa, &flow_action_reformat::create_prm_reformat);
 }
 
 std::shared_ptr<flow_action> flow_action_generator::create_modify(flow_action_modify_attr& attr)
 {
-    return std::shared_ptr<flow_action>(new (std::nothrow) flow_action_modify(m_ctx, attr));
+    flow_action_modify* fa = new (std::nothrow) flow_action_modify(m_ctx, attr);
+    if (!fa || fa->prepare_prm_modify_buff() != DPCP_OK) {
+        return std::shared_ptr<flow_action>(fa);
+    }
+
+    // HW object is created on first apply, shared actions create it once.
+    return get_cached_action<flow_action_modify>(fa, nullptr);
 }
 
 std::shared_ptr<flow_action> flow_action_generator::create_reparse()
@@ -591,4 +713,16 @@ std::shared_ptr<flow_action> flow_action_generator::create_reparse()
     return std::shared_ptr<flow_action>(new (std::nothrow) flow_action_reparse(m_ctx));
 }
 
+std::shared_ptr<flow_action> flow_action_generator::create_counter(flow_counter_bulk& bulk,
+                                                                   uint32_t index)
+{
+    uint32_t counter_id = 0;
+    if (bulk.get_counter_id(index, counter_id) != DPCP_OK) {
+        log_error("Flow Action counter, invalid counter index %u\n", index);
+        return nullptr;
+    }
+
+    return std::shared_ptr<flow_action>(new (std::nothrow) flow_action_counter(m_ctx, counter_id));
+}
+
 } // namespace dpcp
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+enum {
+    FLOW_COUNTER_BULK_UNIT = 128, // flow_counter_bulk of ALLOC_FLOW_COUNTER is in these units
+    FLOW_COUNTER_BULK_MAX = 16384,
+    FLOW_COUNTER_QUERY_ALIGN = 4, // flow_counter_id of bulk query
+};
+
+flow_counter_bulk::flow_counter_bulk(dcmd::ctx* ctx)
+    : obj(ctx)
+    , m_num(0)
+    , m_base_id(0)
+    , m_indexes()
+    , m_indexes_lock()
+    , m_snapshot()
+    , m_snapshot_lock()
+    , m_refresh_thread()
+    , m_refresh_lock()
+    , m_refresh_cv()
+    , m_refresh_stop(false)
+{
+}
+
+flow_counter_bulk::~flow_counter_bulk()
+{
+    stop_refresh();
+}
+
+status flow_counter_bulk::init(uint32_t num, uint8_t bulk_alloc)
+{
+    uint32_t in[DEVX_ST_SZ_DW(alloc_flow_counter_in)] = {0};
+    uint32_t out[DEVX_ST_SZ_DW(alloc_flow_counter_out)] = {0};
+    size_t outlen = sizeof(out);
+
+    if (num != 1 &&
+        (num < FLOW_COUNTER_BULK_UNIT || num > FLOW_COUNTER_BULK_MAX || (num & (num - 1)))) {
+        log_error("Flow counter bulk invalid number of counters %u\n", num);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (num > 1 && !(bulk_alloc & (num / FLOW_COUNTER_BULK_UNIT))) {
+        log_error("Flow counter bulk of %u counters is not supported, bulk_alloc 0x%x\n", num,
+                  bulk_alloc);
+        return DPCP_ERR_NO_SUPPORT;
+    }
+
+    DEVX_SET(alloc_flow_counter_in, in, opcode, MLX5_CMD_OP_ALLOC_FLOW_COUNTER);
+    DEVX_SET(alloc_flow_counter_in, in, flow_counter_bulk, num / FLOW_COUNTER_BULK_UNIT);
+    status ret = obj::create(in, sizeof(in), out, outlen);
+    if (DPCP_OK != ret) {
+        log_error("Flow counter bulk of %u counters allocation failed, ret %d\n", num, ret);
+        return ret;
+    }
+    m_base_id = DEVX_GET(alloc_flow_counter_out, out, flow_counter_id);
+
+    m_indexes.reset(new (std::nothrow) index_allocator(0, num));
+    if (!m_indexes) {
+        log_error("Flow counter bulk index allocator allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    m_num = num;
+
+    log_trace("Flow counter bulk created: base_id=0x%x num=%u\n", m_base_id, m_num);
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::alloc_counter(uint32_t& index)
+{
+    std::lock_guard<std::mutex> guard(m_indexes_lock);
+
+    if (!m_indexes->alloc(index)) {
+        log_error("Flow counter bulk 0x%x has no free counter\n", m_base_id);
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::release_counter(uint32_t index)
+{
+    std::lock_guard<std::mutex> guard(m_indexes_lock);
+
+    if (!m_indexes->release(index)) {
+        log_error("Flow counter bulk 0x%x counter %u is not taken\n", m_base_id, index);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::get_counter_id(uint32_t index, uint32_t& id) const
+{
+    if (index >= m_num) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    id = m_base_id + index;
+    return DPCP_OK;
+}
+
+status flow_counter_bulk::query(uint32_t first, uint32_t num, flow_counter_stats* stats,
+                                bool clear)
+{
+    uint32_t in[DEVX_ST_SZ_DW(query_flow_counter_in)] = {0};
+
+    if (!stats || !num || first >= m_num || num > m_num - first) {
+        log_error("Flow counter bulk invalid range first %u num %u of %u\n", first, num, m_num);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // All counters of the range are returned by one command. Bulk query starts at
+    // counter id aligned to 4, counters before the range are skipped.
+    uint32_t id = m_base_id + first;
+    uint32_t skip = (num > 1) ? id % FLOW_COUNTER_QUERY_ALIGN : 0;
+    uint32_t query_num = (num > 1) ? align(num + skip, FLOW_COUNTER_QUERY_ALIGN) : 1;
+    if (clear && query_num != num) {
+        log_error("Flow counter bulk clear of unaligned range first %u num %u\n", first, num);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    size_t outlen = DEVX_ST_SZ_BYTES(query_flow_counter_out) +
+        query_num * DEVX_ST_SZ_BYTES(traffic_counter);
+    std::unique_ptr<uint8_t[]> out(new (std::nothrow) uint8_t[outlen]);
+    if (!out) {
+        log_error("Flow counter bulk query buffer allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(out.get(), 0, outlen);
+
+    DEVX_SET(query_flow_counter_in, in, opcode, MLX5_CMD_OP_QUERY_FLOW_COUNTER);
+    DEVX_SET(query_flow_counter_in, in, clear, clear);
+    if (num > 1) {
+        DEVX_SET(query_flow_counter_in, in, num_of_counters, query_num);
+    }
+    DEVX_SET(query_flow_counter_in, in, flow_counter_id, id - skip);
+    status ret = obj::query(in, sizeof(in), out.get(), outlen);
+    if (DPCP_OK != ret) {
+        log_error("Flow counter bulk 0x%x query failed, ret %d\n", m_base_id, ret);
+        return ret;
+    }
+
+    void* statistics = DEVX_ADDR_OF(query_flow_counter_out, out.get(), flow_statistics);
+    uint8_t* counter =
+        reinterpret_cast<uint8_t*>(statistics) + skip * DEVX_ST_SZ_BYTES(traffic_counter);
+    for (uint32_t i = 0; i < num; i++) {
+        stats[i].packets = DEVX_GET64(traffic_counter, counter, packets);
+        stats[i].octets = DEVX_GET64(traffic_counter, counter, octets);
+        counter += DEVX_ST_SZ_BYTES(traffic_counter);
+    }
+
+    return DPCP_OK;
+}
+
+void flow_counter_bulk::refresh(std::chrono::milliseconds period)
+{
+    std::vector<flow_counter_stats> stats(m_num);
+    std::unique_lock<std::mutex> lock(m_refresh_lock);
+
+    while (!m_refresh_stop) {
+        lock.unlock();
+        if (query(0, m_num, stats.data()) == DPCP_OK) {
+            std::lock_guard<std::mutex> guard(m_snapshot_lock);
+            m_snapshot.swap(stats);
+        }
+        stats.resize(m_num);
+        lock.lock();
+        m_refresh_cv.wait_for(lock, period, [this]() { return m_refresh_stop; });
+    }
+}
+
+status flow_counter_bulk::start_refresh(std::chrono::milliseconds period)
+{
+    if (period.count() <= 0) {
+        log_error("Flow counter bulk invalid refresh period %lld ms\n",
+                  static_cast<long long>(period.count()));
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Restart with new period.
+    stop_refresh();
+    m_refresh_stop = false;
+    try {
+        m_refresh_thread = std::thread(&flow_counter_bulk::refresh, this, period);
+    } catch (...) {
+        log_error("Flow counter bulk failed to start refresh thread\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    log_trace("Flow counter bulk 0x%x refresh every %lld ms\n", m_base_id,
+              static_cast<long long>(period.count()));
+    return DPCP_OK;
+}
+
+void flow_counter_bulk::stop_refresh()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_refresh_lock);
+        m_refresh_stop = true;
+    }
+    m_refresh_cv.notify_all();
+    if (m_refresh_thread.joinable()) {
+        m_refresh_thread.join();
+    }
+}
+
+status flow_counter_bulk::get_stats(uint32_t first, uint32_t num, flow_counter_stats* stats)
+{
+    if (!stats || first >= m_num || num > m_num - first) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> guard(m_snapshot_lock);
+    if (m_snapshot.empty()) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+    std::copy(m_snapshot.begin() + first, m_snapshot.begin() + first + num, stats);
+
+    return DPCP_OK;
+}
+
+} // namespace dpcp
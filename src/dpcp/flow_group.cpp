@@ -28,6 +28,7 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <type_traits>
 
 #include "dpcp/internal.h"
@@ -69,7 +70,16 @@ status flow_group::create()
         return DPCP_ERR_NO_MEMORY;
     }
 
-    return DPCP_OK;
+    // Create rules registry keyed by the match criteria, kernel tables order rules
+    // of the same match value by priority.
+    bool by_priority = !!std::dynamic_pointer_cast<const flow_table_kernel>(m_table.lock());
+    m_rules = std::make_shared<flow_rule_registry>(m_matcher, by_priority);
+    if (!m_rules) {
+        log_error("Flow rule registry allocation failed.\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    return m_rules->init(m_attr.match_criteria);
 }
 
 status flow_group::get_match_criteria(match_params_ex& match) const
@@ -83,13 +93,31 @@ status flow_group::get_match_criteria(match_params_ex& match) const
     return DPCP_OK;
 }
 
+status flow_group::get_flow_index_range(uint32_t& start, uint32_t& end) const
+{
+    start = m_attr.start_flow_index;
+    end = m_attr.end_flow_index;
+    return DPCP_OK;
+}
+
+status flow_group::get_occupancy(uint32_t& used, uint32_t& size) const
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    used = static_cast<uint32_t>(m_rules->size());
+    size = m_attr.end_flow_index - m_attr.start_flow_index + 1;
+    return DPCP_OK;
+}
+
 status flow_group::remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule)
 {
     if (!m_is_initialized) {
         return DPCP_ERR_NOT_APPLIED;
     }
 
-    if (m_rules.erase(rule.lock()) != 1) {
+    if (!m_rules->erase(rule.lock())) {
         log_error("Flow rule %p do not exist in this group\n", rule.lock().get());
         return DPCP_ERR_INVALID_PARAM;
     }
@@ -97,6 +125,72 @@ status flow_group::remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule)
     return DPCP_OK;
 }
 
+status flow_group::find_flow_rule(const match_params_ex& match, std::weak_ptr<flow_rule_ex>& rule,
+                                  uint16_t priority) const
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    std::shared_ptr<flow_rule_ex> fr = m_rules->find(match, priority);
+    if (!fr) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    rule = fr;
+    return DPCP_OK;
+}
+
+status flow_group::remove_flow_rule_by_match(const match_params_ex& match, uint16_t priority)
+{
+    std::weak_ptr<flow_rule_ex> rule;
+
+    status ret = find_flow_rule(match, rule, priority);
+    if (ret != DPCP_OK) {
+        log_error("Flow rule with the match value do not exist in this group\n");
+        return ret;
+    }
+
+    return remove_flow_rule(rule);
+}
+
+status flow_group::add_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                  std::vector<std::weak_ptr<flow_rule_ex>>& rules)
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+    if (!attrs && num) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    status ret = DPCP_OK;
+    size_t i = 0;
+    rules.clear();
+    rules.reserve(num);
+    for (; i < num; i++) {
+        std::weak_ptr<flow_rule_ex> rule;
+        ret = add_flow_rule(attrs[i], rule);
+        if (ret != DPCP_OK) {
+            break;
+        }
+        rules.push_back(rule);
+        ret = rule.lock()->create();
+        if (ret != DPCP_OK) {
+            break;
+        }
+    }
+    if (ret != DPCP_OK) {
+        log_error("Flow rule %zu of batch failed, ret %d\n", i, ret);
+        for (auto& rule : rules) {
+            m_rules->erase(rule.lock());
+        }
+        rules.clear();
+    }
+
+    return ret;
+}
+
 template <class FR>
 status flow_group::create_flow_rule_ex(const flow_rule_attr_ex& attr,
                                        std::weak_ptr<flow_rule_ex>& rule)
@@ -115,10 +209,10 @@ status flow_group::create_flow_rule_ex(const flow_rule_attr_ex& attr,
         return DPCP_ERR_NO_MEMORY;
     }
 
-    auto ret = m_rules.insert(fr);
-    if (!ret.second) {
-        log_error("Flow rule placement failed\n");
-        return DPCP_ERR_NO_MEMORY;
+    status ret = m_rules->insert(fr);
+    if (ret != DPCP_OK) {
+        log_error("Flow rule placement failed, ret %d\n", ret);
+        return ret;
     }
     rule = fr;
 
@@ -133,6 +227,9 @@ flow_group_prm::flow_group_prm(dcmd::ctx* ctx, const flow_group_attr& attr,
                                std::weak_ptr<const flow_table> table)
     : flow_group(ctx, attr, table)
     , m_group_id()
+    , m_flow_indexes(attr.start_flow_index, attr.end_flow_index >= attr.start_flow_index
+                         ? attr.end_flow_index - attr.start_flow_index + 1
+                         : 0)
 {
 }
 
@@ -212,10 +309,145 @@ status flow_group_prm::get_table_id(uint32_t& table_id) const
     return DPCP_OK;
 }
 
+status flow_group_prm::place_flow_rule(flow_rule_ex_prm& rule)
+{
+    if (rule.m_flow_index == FLOW_INDEX_AUTO) {
+        if (!m_flow_indexes.alloc(rule.m_flow_index)) {
+            log_error("Flow group 0x%x has no free flow index, used %u of %u\n", m_group_id,
+                      m_flow_indexes.get_used(), m_flow_indexes.get_size());
+            return DPCP_ERR_OUT_OF_RANGE;
+        }
+    } else if (!m_flow_indexes.reserve(rule.m_flow_index)) {
+        log_error("Flow index 0x%x is taken or not in flow group 0x%x\n", rule.m_flow_index,
+                  m_group_id);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    return DPCP_OK;
+}
+
+void flow_group_prm::erase_flow_rule(const std::shared_ptr<flow_rule_ex>& rule)
+{
+    flow_rule_ex_prm* fr = static_cast<flow_rule_ex_prm*>(rule.get());
+    if (fr && fr->m_flow_index != FLOW_INDEX_AUTO) {
+        m_flow_indexes.release(fr->m_flow_index);
+    }
+    m_rules->erase(rule);
+}
+
 status flow_group_prm::add_flow_rule(const flow_rule_attr_ex& attr,
                                      std::weak_ptr<flow_rule_ex>& rule)
 {
-    return create_flow_rule_ex<flow_rule_ex_prm>(attr, rule);
+    status ret = create_flow_rule_ex<flow_rule_ex_prm>(attr, rule);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    std::shared_ptr<flow_rule_ex> fr = rule.lock();
+    ret = place_flow_rule(*static_cast<flow_rule_ex_prm*>(fr.get()));
+    if (ret != DPCP_OK) {
+        m_rules->erase(fr);
+        rule.reset();
+    }
+
+    return ret;
+}
+
+status flow_group_prm::remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule)
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    std::shared_ptr<flow_rule_ex> fr = rule.lock();
+    if (!m_rules->contains(fr)) {
+        log_error("Flow rule %p do not exist in this group\n", fr.get());
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    erase_flow_rule(fr);
+
+    return DPCP_OK;
+}
+
+status flow_group_prm::add_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                      std::vector<std::weak_ptr<flow_rule_ex>>& rules)
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+    if (!attrs && num) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    rules.clear();
+    rules.reserve(num);
+
+    // Part of SET_FTE common for all rules of the group is prepared once.
+    uint32_t fte_hdr[DEVX_ST_SZ_DW(set_fte_in)] = {0};
+    flow_table_type ft_type = flow_table_type::FT_END;
+    uint32_t ft_id = 0;
+    std::shared_ptr<const flow_table> table = m_table.lock();
+    if (!table || table->get_table_type(ft_type) != DPCP_OK ||
+        static_cast<const flow_table_prm*>(table.get())->get_table_id(ft_id) != DPCP_OK) {
+        log_error("Flow table is not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    DEVX_SET(set_fte_in, fte_hdr, opcode, MLX5_CMD_OP_SET_FLOW_TABLE_ENTRY);
+    DEVX_SET(set_fte_in, fte_hdr, table_type, ft_type);
+    DEVX_SET(set_fte_in, fte_hdr, table_id, ft_id);
+    DEVX_SET(set_fte_in, fte_hdr, flow_context.group_id, m_group_id);
+
+    // Rule objects first, so the scratch buffer fits the longest destination list.
+    status ret = DPCP_OK;
+    size_t max_in_len = sizeof(fte_hdr);
+    for (size_t i = 0; i < num && ret == DPCP_OK; i++) {
+        std::weak_ptr<flow_rule_ex> rule;
+        ret = create_flow_rule_ex<flow_rule_ex_prm>(attrs[i], rule);
+        if (ret == DPCP_OK) {
+            rules.push_back(rule);
+            flow_rule_ex_prm* fr = static_cast<flow_rule_ex_prm*>(rule.lock().get());
+            ret = place_flow_rule(*fr);
+            if (ret != DPCP_OK) {
+                // Keep the rule from releasing an index it does not own.
+                fr->m_flow_index = FLOW_INDEX_AUTO;
+            }
+            max_in_len = std::max(max_in_len, fr->get_in_len());
+        }
+    }
+
+    std::unique_ptr<uint8_t[]> in_mem_guard;
+    if (ret == DPCP_OK) {
+        in_mem_guard.reset(new (std::nothrow) uint8_t[max_in_len]);
+        if (!in_mem_guard) {
+            log_error("Flow rules in buf memory allocation failed\n");
+            ret = DPCP_ERR_NO_MEMORY;
+        }
+    }
+
+    // Issue SET_FTE commands back to back reusing the scratch buffer.
+    void* in = in_mem_guard.get();
+    for (size_t i = 0; i < rules.size() && ret == DPCP_OK; i++) {
+        flow_rule_ex_prm* fr = static_cast<flow_rule_ex_prm*>(rules[i].lock().get());
+        if (!fr->m_is_valid_actions) {
+            log_error("Flow Actions of rule %zu are not valid\n", i);
+            ret = DPCP_ERR_INVALID_PARAM;
+            break;
+        }
+        size_t in_len = fr->get_in_len();
+        memcpy(in, fte_hdr, sizeof(fte_hdr));
+        memset((uint8_t*)in + sizeof(fte_hdr), 0, in_len - sizeof(fte_hdr));
+        ret = fr->create_fte(in, in_len);
+    }
+
+    if (ret != DPCP_OK) {
+        log_error("Flow rules batch of %zu failed, ret %d\n", num, ret);
+        for (auto& rule : rules) {
+            erase_flow_rule(rule.lock());
+        }
+        rules.clear();
+    }
+
+    return ret;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -240,6 +472,40 @@ status flow_group_kernel::create()
     return DPCP_OK;
 }
 
+status flow_group_kernel::get_dcmd_matcher(dcmd::ctx* ctx, uint16_t priority,
+                                           std::shared_ptr<dcmd::flow_matcher>& matcher) const
+{
+    if (!m_is_initialized) {
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    std::lock_guard<std::mutex> guard(m_dcmd_matchers_lock);
+    std::weak_ptr<dcmd::flow_matcher>& cached = m_dcmd_matchers[priority];
+    matcher = cached.lock();
+    if (matcher) {
+        return DPCP_OK;
+    }
+
+    prm_match_params criteria;
+    memset(&criteria, 0, sizeof(criteria));
+    criteria.buf_sz = sizeof(criteria.buf);
+    status ret = m_matcher->apply(&criteria.buf, m_attr.match_criteria);
+    if (ret != DPCP_OK) {
+        log_error("Flow group failed to apply match criteria, ret %d\n", ret);
+        return ret;
+    }
+
+    struct dcmd::flow_matcher_desc desc = {(dcmd::flow_match_parameters*)&criteria, priority};
+    matcher.reset(ctx->create_flow_matcher(&desc));
+    if (!matcher) {
+        log_trace("Flow group kernel matcher is not created, priority %u\n", priority);
+        return DPCP_ERR_NO_SUPPORT;
+    }
+    cached = matcher;
+
+    return DPCP_OK;
+}
+
 status flow_group_kernel::add_flow_rule(const flow_rule_attr_ex& attr,
                                         std::weak_ptr<flow_rule_ex>& rule)
 {
@@ -37,7 +37,8 @@ namespace dpcp {
 // flow_rule_ex                                                       //
 ////////////////////////////////////////////////////////////////////////
 
-bool flow_rule_ex::verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions)
+bool flow_rule_ex::verify_flow_actions(const std::vector<std::shared_ptr<flow_action>>& actions,
+                                       action_map_t& action_map)
 {
     if (actions.empty()) {
         log_error("No Flow Actions were added to Flow Rule\n");
@@ -52,18 +53,18 @@ bool flow_rule_ex::verify_flow_actions(const std::vector<std::shared_ptr<flow_ac
         // It do not support typeid() as key, so the type_index make wrapper that the hash function
         // can use.
         auto& action_ref = *action.get();
-        m_actions.insert({std::type_index(typeid(action_ref)), action});
+        action_map.insert({std::type_index(typeid(action_ref)), action});
     }
 
-    if (m_actions.size() != actions.size()) {
+    if (action_map.size() != actions.size()) {
         log_error("Flow Action placement failure, could be caused by multiple actions from the "
                   "same type\n");
         return false;
     }
 
     // Flow rule must have flow action forward.
-    auto action_iter = m_actions.find(std::type_index(typeid(flow_action_fwd)));
-    if (action_iter == m_actions.end()) {
+    auto action_iter = action_map.find(std::type_index(typeid(flow_action_fwd)));
+    if (action_iter == action_map.end()) {
         log_error("Flow Rule must have Flow Action forward to destination\n");
         return false;
     }
@@ -77,13 +78,14 @@ flow_rule_ex::flow_rule_ex(dcmd::ctx* ctx, const flow_rule_attr_ex& attr,
                            std::shared_ptr<const flow_matcher> matcher)
     : obj(ctx)
     , m_match_value(attr.match_value)
+    , m_priority(attr.priority)
     , m_is_initialized()
     , m_table(table)
     , m_group(group)
     , m_is_valid_actions(false)
     , m_matcher(matcher)
 {
-    m_is_valid_actions = verify_flow_actions(attr.actions);
+    m_is_valid_actions = verify_flow_actions(attr.actions, m_actions);
 }
 
 status flow_rule_ex::get_match_value(match_params_ex& match_val)
@@ -92,6 +94,11 @@ status flow_rule_ex::get_match_value(match_params_ex& match_val)
     return DPCP_OK;
 }
 
+status flow_rule_ex::create_async(cmd_engine& engine, uint64_t cookie)
+{
+    return engine.submit([this]() { return create(); }, cookie);
+}
+
 ////////////////////////////////////////////////////////////////////////
 // flow_rule_ex_prm                                                   //
 ////////////////////////////////////////////////////////////////////////
@@ -105,18 +112,27 @@ flow_rule_ex_prm::flow_rule_ex_prm(dcmd::ctx* ctx, const flow_rule_attr_ex& attr
 {
 }
 
-status flow_rule_ex_prm::alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]>& in_mem_guard)
+size_t flow_rule_ex_prm::get_in_len() const
 {
     // Get destination list size.
     size_t dest_list_size = 0;
     auto action_fwd = m_actions.find(std::type_index(typeid(flow_action_fwd)));
     if (action_fwd != m_actions.end()) {
         dest_list_size =
-            std::dynamic_pointer_cast<flow_action_fwd>(action_fwd->second)->get_dest_num();
+            std::static_pointer_cast<flow_action_fwd>(action_fwd->second)->get_dest_num();
     }
 
+    if (m_actions.count(std::type_index(typeid(flow_action_counter)))) {
+        dest_list_size++;
+    }
+
+    return DEVX_ST_SZ_BYTES(set_fte_in) + DEVX_ST_SZ_BYTES(dest_format_struct) * dest_list_size;
+}
+
+status flow_rule_ex_prm::alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]>& in_mem_guard)
+{
     // Allocate in buffer.
-    in_len = DEVX_ST_SZ_BYTES(set_fte_in) + DEVX_ST_SZ_BYTES(dest_format_struct) * dest_list_size;
+    in_len = get_in_len();
     in_mem_guard.reset(new (std::nothrow) uint8_t[in_len]);
     if (!in_mem_guard) {
         log_error("Flow rule in buf memory allocation failed\n");
@@ -138,7 +154,6 @@ status flow_rule_ex_prm::config_flow_rule(void* in)
         std::dynamic_pointer_cast<const flow_group_prm>(m_group.lock());
 
     DEVX_SET(set_fte_in, in, opcode, MLX5_CMD_OP_SET_FLOW_TABLE_ENTRY);
-    DEVX_SET(set_fte_in, in, flow_index, m_flow_index);
 
     // Set flow table type.
     ret = prm_table->get_table_type(ft_type);
@@ -179,8 +194,6 @@ status flow_rule_ex_prm::create()
     }
 
     // Prepare PRM buffers.
-    uint32_t out[DEVX_ST_SZ_DW(set_fte_out)] {0};
-    size_t outlen = sizeof(out);
     size_t in_len = 0;
     std::unique_ptr<uint8_t[]> in_mem_guard;
     ret = alloc_in_buff(in_len, in_mem_guard);
@@ -197,6 +210,15 @@ status flow_rule_ex_prm::create()
         return ret;
     }
 
+    return create_fte(in, in_len);
+}
+
+status flow_rule_ex_prm::fill_fte(void* in)
+{
+    status ret = DPCP_OK;
+
+    DEVX_SET(set_fte_in, in, flow_index, m_flow_index);
+
     // Set match values
     void* match_params = DEVX_ADDR_OF(set_fte_in, in, flow_context.match_value);
     ret = m_matcher->apply(match_params, m_match_value);
@@ -205,14 +227,39 @@ status flow_rule_ex_prm::create()
         return ret;
     }
 
-    // Apply flow actions.
-    for (auto action : m_actions) {
+    // Apply flow actions, counter list is placed after destination list.
+    std::shared_ptr<flow_action> counter;
+    for (const auto& action : m_actions) {
+        if (action.first == std::type_index(typeid(flow_action_counter))) {
+            counter = action.second;
+            continue;
+        }
         ret = action.second->apply(in);
         if (ret != DPCP_OK) {
             log_error("Flow rule failed to apply actions\n");
             return ret;
         }
     }
+    if (counter) {
+        ret = counter->apply(in);
+        if (ret != DPCP_OK) {
+            log_error("Flow rule failed to apply counter action\n");
+            return ret;
+        }
+    }
+
+    return DPCP_OK;
+}
+
+status flow_rule_ex_prm::create_fte(void* in, size_t in_len)
+{
+    uint32_t out[DEVX_ST_SZ_DW(set_fte_out)] {0};
+    size_t outlen = sizeof(out);
+
+    status ret = fill_fte(in);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
 
     // Create flow rule HW object.
     ret = obj::create(in, in_len, out, outlen);
@@ -229,6 +276,95 @@ status flow_rule_ex_prm::create()
     return ret;
 }
 
+uint8_t flow_rule_ex_prm::get_modify_mask(const action_map_t& actions) const
+{
+    uint8_t mask = 0;
+    std::unordered_set<std::type_index> types;
+
+    for (const auto& action : m_actions) {
+        types.insert(action.first);
+    }
+    for (const auto& action : actions) {
+        types.insert(action.first);
+    }
+
+    // Action which was added, removed or replaced enables its part of the FTE.
+    for (const auto& type : types) {
+        auto old_action = m_actions.find(type);
+        auto new_action = actions.find(type);
+        std::shared_ptr<flow_action> old_ptr =
+            (old_action != m_actions.end()) ? old_action->second : nullptr;
+        std::shared_ptr<flow_action> new_ptr =
+            (new_action != actions.end()) ? new_action->second : nullptr;
+        if (old_ptr == new_ptr) {
+            continue;
+        }
+        if (type == std::type_index(typeid(flow_action_fwd))) {
+            mask |= 1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_DESTINATION_LIST;
+        } else if (type == std::type_index(typeid(flow_action_tag))) {
+            mask |= 1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_FLOW_TAG;
+        } else if (type == std::type_index(typeid(flow_action_counter))) {
+            // Counter list and count action bit.
+            mask |= 1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_FLOW_COUNTERS;
+            mask |= 1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_ACTION;
+        } else {
+            mask |= 1 << MLX5_SET_FTE_MODIFY_ENABLE_MASK_ACTION;
+        }
+    }
+
+    return mask;
+}
+
+status flow_rule_ex_prm::modify(const std::vector<std::shared_ptr<flow_action>>& actions)
+{
+    status ret = DPCP_OK;
+
+    if (!m_is_initialized) {
+        log_error("Flow rule was not created\n");
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    action_map_t new_actions;
+    if (!verify_flow_actions(actions, new_actions)) {
+        log_error("Flow Actions are not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    uint8_t modify_mask = get_modify_mask(new_actions);
+    if (!modify_mask) {
+        return DPCP_OK;
+    }
+
+    // New actions are applied to the FTE, old ones are restored on failure.
+    std::swap(m_actions, new_actions);
+
+    uint32_t out[DEVX_ST_SZ_DW(set_fte_out)] {0};
+    size_t outlen = sizeof(out);
+    size_t in_len = 0;
+    std::unique_ptr<uint8_t[]> in_mem_guard;
+    void* in = nullptr;
+    ret = alloc_in_buff(in_len, in_mem_guard);
+    if (ret == DPCP_OK) {
+        in = in_mem_guard.get();
+        ret = config_flow_rule(in);
+    }
+    if (ret == DPCP_OK) {
+        DEVX_SET(set_fte_in, in, op_mod, 1); // Modify existing entry
+        DEVX_SET(set_fte_in, in, modify_enable_mask, modify_mask);
+        ret = fill_fte(in);
+    }
+    if (ret == DPCP_OK) {
+        ret = obj::modify(in, in_len, out, outlen);
+    }
+    if (ret != DPCP_OK) {
+        log_error("Flow rule modify failed, mask 0x%x ret %d\n", modify_mask, ret);
+        std::swap(m_actions, new_actions);
+        return ret;
+    }
+
+    log_trace("Flow rule modified: index=0x%x mask=0x%x\n", m_flow_index, modify_mask);
+    return DPCP_OK;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // flow_rule_ex_kernel                                                //
 ////////////////////////////////////////////////////////////////////////
@@ -238,7 +374,6 @@ flow_rule_ex_kernel::flow_rule_ex_kernel(dcmd::ctx* ctx, const flow_rule_attr_ex
                                          std::weak_ptr<const flow_group> group,
                                          std::shared_ptr<const flow_matcher> matcher)
     : flow_rule_ex(ctx, attr, table, group, matcher)
-    , m_priority(attr.priority)
     , m_flow(nullptr)
 {
 }
@@ -302,6 +437,14 @@ status flow_rule_ex_kernel::create()
         return ret;
     }
 
+    // Rules of the group with the same priority share the kernel matcher,
+    // if it can't be shared the flow creates own one.
+    std::shared_ptr<const flow_group_kernel> group =
+        std::static_pointer_cast<const flow_group_kernel>(m_group.lock());
+    if (group && group->get_dcmd_matcher(get_ctx(), m_priority, m_dcmd_matcher) == DPCP_OK) {
+        dcmd_flow.matcher = m_dcmd_matcher.get();
+    }
+
     // Set Flow Rule actions.
     for (auto action : m_actions) {
         ret = action.second->apply(dcmd_flow);
@@ -316,6 +459,13 @@ status flow_rule_ex_kernel::create()
     return m_flow ? DPCP_OK : DPCP_ERR_CREATE;
 }
 
+status flow_rule_ex_kernel::modify(const std::vector<std::shared_ptr<flow_action>>& actions)
+{
+    UNUSED(actions);
+    log_error("Flow rule of kernel table can't be modified in place\n");
+    return DPCP_ERR_NO_SUPPORT;
+}
+
 flow_rule_ex_kernel::~flow_rule_ex_kernel()
 {
     if (m_flow) {
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+enum {
+    MATCH_PARAM_DWS = DEVX_ST_SZ_DW(fte_match_param),
+    REGISTRY_MIN_SLOTS = 16,
+};
+
+static inline uint64_t hash_key(const uint32_t* key, size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ key[i]) * 0x9e3779b97f4a7c15ULL;
+        hash ^= hash >> 29;
+    }
+
+    return hash;
+}
+
+flow_rule_registry::flow_rule_registry(std::shared_ptr<const flow_matcher> matcher,
+                                       bool by_priority)
+    : m_matcher(matcher)
+    , m_by_priority(by_priority)
+    , m_key_dws()
+    , m_key_masks()
+    , m_slots()
+    , m_size(0)
+{
+}
+
+status flow_rule_registry::init(const match_params_ex& match_criteria)
+{
+    uint32_t mask[MATCH_PARAM_DWS] = {0};
+
+    status ret = m_matcher->apply(mask, match_criteria);
+    if (ret != DPCP_OK) {
+        log_error("Flow rule registry failed to apply match criteria, ret %d\n", ret);
+        return ret;
+    }
+
+    m_key_dws.clear();
+    m_key_masks.clear();
+    for (uint32_t i = 0; i < MATCH_PARAM_DWS; i++) {
+        if (mask[i]) {
+            m_key_dws.push_back(i);
+            m_key_masks.push_back(mask[i]);
+        }
+    }
+
+    if (!rehash(REGISTRY_MIN_SLOTS)) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    return DPCP_OK;
+}
+
+status flow_rule_registry::get_key(const match_params_ex& match_value, uint16_t priority,
+                                   uint32_t* key, uint64_t& hash) const
+{
+    uint32_t param[MATCH_PARAM_DWS] = {0};
+
+    status ret = m_matcher->apply(param, match_value);
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    for (size_t i = 0; i < m_key_dws.size(); i++) {
+        key[i] = param[m_key_dws[i]] & m_key_masks[i];
+    }
+    if (m_by_priority) {
+        key[m_key_dws.size()] = priority;
+    }
+    hash = hash_key(key, get_key_len());
+
+    return DPCP_OK;
+}
+
+size_t flow_rule_registry::lookup(const uint32_t* key, uint64_t hash) const
+{
+    uint32_t rule_key[MATCH_PARAM_DWS + 1];
+    uint64_t rule_hash = 0;
+    size_t mask = m_slots.size() - 1;
+
+    for (size_t i = hash & mask; m_slots[i].rule; i = (i + 1) & mask) {
+        if (m_slots[i].hash != hash) {
+            continue;
+        }
+        // Key of a registered rule is always valid.
+        const flow_rule_ex& rule = *m_slots[i].rule;
+        get_key(rule.m_match_value, rule.m_priority, rule_key, rule_hash);
+        if (!memcmp(key, rule_key, get_key_len() * sizeof(uint32_t))) {
+            return i;
+        }
+    }
+
+    return m_slots.size();
+}
+
+size_t flow_rule_registry::lookup(const std::shared_ptr<flow_rule_ex>& rule) const
+{
+    uint32_t key[MATCH_PARAM_DWS + 1];
+    uint64_t hash = 0;
+
+    if (!rule || !m_size) {
+        return m_slots.size();
+    }
+    if (get_key(rule->m_match_value, rule->m_priority, key, hash) != DPCP_OK) {
+        return m_slots.size();
+    }
+
+    size_t mask = m_slots.size() - 1;
+    for (size_t i = hash & mask; m_slots[i].rule; i = (i + 1) & mask) {
+        if (m_slots[i].rule == rule) {
+            return i;
+        }
+    }
+
+    return m_slots.size();
+}
+
+bool flow_rule_registry::rehash(size_t num_slots)
+{
+    std::vector<slot> slots(num_slots);
+    if (slots.size() != num_slots) {
+        return false;
+    }
+
+    size_t mask = num_slots - 1;
+    for (auto& old : m_slots) {
+        if (!old.rule) {
+            continue;
+        }
+        size_t i = old.hash & mask;
+        while (slots[i].rule) {
+            i = (i + 1) & mask;
+        }
+        slots[i].hash = old.hash;
+        slots[i].rule = std::move(old.rule);
+    }
+    m_slots.swap(slots);
+
+    return true;
+}
+
+status flow_rule_registry::insert(const std::shared_ptr<flow_rule_ex>& rule)
+{
+    uint32_t key[MATCH_PARAM_DWS + 1];
+    uint64_t hash = 0;
+
+    status ret = get_key(rule->m_match_value, rule->m_priority, key, hash);
+    if (ret != DPCP_OK) {
+        log_error("Flow rule registry failed to apply match value, ret %d\n", ret);
+        return ret;
+    }
+    if (lookup(key, hash) != m_slots.size()) {
+        log_error("Flow rule with same match value exists in the group\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    // Keep load factor at most 3/4.
+    if ((m_size + 1) * 4 > m_slots.size() * 3 && !rehash(m_slots.size() * 2)) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+
+    size_t mask = m_slots.size() - 1;
+    size_t i = hash & mask;
+    while (m_slots[i].rule) {
+        i = (i + 1) & mask;
+    }
+    m_slots[i].hash = hash;
+    m_slots[i].rule = rule;
+    m_size++;
+
+    return DPCP_OK;
+}
+
+std::shared_ptr<flow_rule_ex> flow_rule_registry::find(const match_params_ex& match_value,
+                                                       uint16_t priority) const
+{
+    uint32_t key[MATCH_PARAM_DWS + 1];
+    uint64_t hash = 0;
+
+    if (!m_size || get_key(match_value, priority, key, hash) != DPCP_OK) {
+        return nullptr;
+    }
+
+    size_t i = lookup(key, hash);
+    if (i == m_slots.size()) {
+        return nullptr;
+    }
+
+    return m_slots[i].rule;
+}
+
+bool flow_rule_registry::contains(const std::shared_ptr<flow_rule_ex>& rule) const
+{
+    return lookup(rule) != m_slots.size();
+}
+
+bool flow_rule_registry::erase(const std::shared_ptr<flow_rule_ex>& rule)
+{
+    size_t i = lookup(rule);
+    if (i == m_slots.size()) {
+        return false;
+    }
+
+    // Shift following entries of the probe sequence back, no tombstones are left.
+    size_t mask = m_slots.size() - 1;
+    for (size_t j = (i + 1) & mask; m_slots[j].rule; j = (j + 1) & mask) {
+        size_t home = m_slots[j].hash & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            m_slots[i] = std::move(m_slots[j]);
+            i = j;
+        }
+    }
+    m_slots[i].rule.reset();
+    m_size--;
+
+    return true;
+}
+
+} // namespace dpcp
@@ -87,6 +87,19 @@ status flow_table::remove_flow_group(std::weak_ptr<flow_group>& group)
     return DPCP_OK;
 }
 
+status flow_table::get_occupancy(uint32_t& used, uint32_t& size) const
+{
+    UNUSED(used);
+    UNUSED(size);
+    return DPCP_ERR_NO_SUPPORT;
+}
+
+status flow_table::set_table_miss(std::shared_ptr<flow_table> table)
+{
+    UNUSED(table);
+    return DPCP_ERR_NO_SUPPORT;
+}
+
 template <class FG>
 status flow_table::create_flow_group(const flow_group_attr& attr, std::weak_ptr<flow_group>& group)
 {
@@ -129,6 +142,7 @@ flow_table_prm::flow_table_prm(dcmd::ctx* ctx, const flow_table_attr& attr)
     : flow_table(ctx, attr.type)
     , m_table_id(0)
     , m_attr(attr)
+    , m_group_ranges(1U << attr.log_size)
 {
 }
 
@@ -149,7 +163,7 @@ status flow_table_prm::create()
     switch (m_attr.op_mod) {
     // Regular flow table mode.
     case flow_table_op_mod::FT_OP_MOD_NORMAL:
-        ret = set_miss_action(in);
+        ret = set_miss_action(DEVX_ADDR_OF(create_flow_table_in, in, flow_table_context));
         break;
     // Unsupported flow table mode.
     default:
@@ -192,7 +206,7 @@ status flow_table_prm::create()
     return DPCP_OK;
 }
 
-status flow_table_prm::set_miss_action(void* in)
+status flow_table_prm::set_miss_action(void* ft_ctx)
 {
     uint32_t miss_table_id = 0;
     uint8_t miss_table_level = 0;
@@ -200,7 +214,7 @@ status flow_table_prm::set_miss_action(void* in)
     switch (m_attr.def_miss_action) {
     // Will Set default miss behavior according to table type.
     case flow_table_miss_action::FT_MISS_ACTION_DEF:
-        DEVX_SET(create_flow_table_in, in, flow_table_context.table_miss_action,
+        DEVX_SET(flow_table_context, ft_ctx, table_miss_action,
                  flow_table_miss_action::FT_MISS_ACTION_DEF);
         break;
 
@@ -219,9 +233,9 @@ status flow_table_prm::set_miss_action(void* in)
                       miss_table_level, m_attr.level);
             return DPCP_ERR_INVALID_PARAM;
         }
-        DEVX_SET(create_flow_table_in, in, flow_table_context.table_miss_action,
+        DEVX_SET(flow_table_context, ft_ctx, table_miss_action,
                  flow_table_miss_action::FT_MISS_ACTION_FWD);
-        DEVX_SET(create_flow_table_in, in, flow_table_context.table_miss_id, miss_table_id);
+        DEVX_SET(flow_table_context, ft_ctx, table_miss_id, miss_table_id);
         break;
     }
 
@@ -234,6 +248,42 @@ status flow_table_prm::set_miss_action(void* in)
     return DPCP_OK;
 }
 
+status flow_table_prm::set_table_miss(std::shared_ptr<flow_table> table)
+{
+    uint32_t in[DEVX_ST_SZ_DW(modify_flow_table_in)] = {0};
+    uint32_t out[DEVX_ST_SZ_DW(modify_flow_table_out)] = {0};
+    size_t outlen = sizeof(out);
+
+    status ret = get_flow_table_status();
+    if (ret != DPCP_OK) {
+        log_error("Failed to set Flow Table miss, bad status %d\n", ret);
+        return ret;
+    }
+
+    // New miss table is set to the context, old one is restored on failure.
+    flow_table_attr attr = m_attr;
+    m_attr.table_miss = table;
+    m_attr.def_miss_action = table ? flow_table_miss_action::FT_MISS_ACTION_FWD
+                                   : flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ret = set_miss_action(DEVX_ADDR_OF(modify_flow_table_in, in, flow_table_context));
+    if (ret == DPCP_OK) {
+        DEVX_SET(modify_flow_table_in, in, opcode, MLX5_CMD_OP_MODIFY_FLOW_TABLE);
+        DEVX_SET(modify_flow_table_in, in, modify_field_select,
+                 MLX5_MODIFY_FLOW_TABLE_MISS_TABLE_ID);
+        DEVX_SET(modify_flow_table_in, in, table_type, m_attr.type);
+        DEVX_SET(modify_flow_table_in, in, table_id, m_table_id);
+        ret = obj::modify(in, sizeof(in), out, outlen);
+    }
+    if (ret != DPCP_OK) {
+        log_error("Failed to set Flow Table 0x%x miss, ret %d\n", m_table_id, ret);
+        m_attr = attr;
+        return ret;
+    }
+
+    log_trace("Flow table 0x%x miss action set to 0x%x\n", m_table_id, m_attr.def_miss_action);
+    return DPCP_OK;
+}
+
 status flow_table_prm::get_table_id(uint32_t& table_id) const
 {
     status ret = get_flow_table_status();
@@ -322,7 +372,67 @@ status flow_table_prm::get_table_level(uint8_t& table_level) const
 
 status flow_table_prm::add_flow_group(const flow_group_attr& attr, std::weak_ptr<flow_group>& group)
 {
-    return create_flow_group<flow_group_prm>(attr, group);
+    status ret = get_flow_table_status();
+    if (ret != DPCP_OK) {
+        log_error("Failed to add Flow Group, bad status %d\n", ret);
+        return ret;
+    }
+
+    flow_group_attr group_attr = attr;
+    if (attr.num_flows) {
+        uint32_t start = 0;
+        if (!m_group_ranges.alloc(attr.num_flows, start)) {
+            log_error("Flow table has no %u free consecutive flow indexes, used %u of %u\n",
+                      attr.num_flows, m_group_ranges.get_used(), m_group_ranges.get_size());
+            return DPCP_ERR_OUT_OF_RANGE;
+        }
+        group_attr.start_flow_index = start;
+        group_attr.end_flow_index = start + attr.num_flows - 1;
+    } else {
+        if (attr.end_flow_index < attr.start_flow_index ||
+            !m_group_ranges.reserve(attr.start_flow_index,
+                                    attr.end_flow_index - attr.start_flow_index + 1)) {
+            log_error("Flow group range [0x%x, 0x%x] is not free in the Flow Table\n",
+                      attr.start_flow_index, attr.end_flow_index);
+            return DPCP_ERR_INVALID_PARAM;
+        }
+    }
+
+    ret = create_flow_group<flow_group_prm>(group_attr, group);
+    if (ret != DPCP_OK) {
+        m_group_ranges.release(group_attr.start_flow_index,
+                               group_attr.end_flow_index - group_attr.start_flow_index + 1);
+    }
+
+    return ret;
+}
+
+status flow_table_prm::remove_flow_group(std::weak_ptr<flow_group>& group)
+{
+    uint32_t start = 0;
+    uint32_t end = 0;
+    std::shared_ptr<flow_group> shrd_group = group.lock();
+    bool has_range = shrd_group && m_groups.count(shrd_group) &&
+        shrd_group->get_flow_index_range(start, end) == DPCP_OK;
+
+    status ret = flow_table::remove_flow_group(group);
+    if (ret == DPCP_OK && has_range) {
+        m_group_ranges.release(start, end - start + 1);
+    }
+
+    return ret;
+}
+
+status flow_table_prm::get_occupancy(uint32_t& used, uint32_t& size) const
+{
+    status ret = get_flow_table_status();
+    if (ret != DPCP_OK) {
+        return ret;
+    }
+
+    used = m_group_ranges.get_used();
+    size = m_group_ranges.get_size();
+    return DPCP_OK;
 }
 
 ////////////////////////////////////////////////////////////////////////
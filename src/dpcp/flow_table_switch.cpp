@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+flow_table_switch::flow_table_switch(adapter* ad)
+    : m_adapter(ad)
+    , m_attr()
+    , m_active()
+    , m_shadow()
+    , m_parent_rule()
+    , m_parent_table()
+{
+}
+
+flow_table_switch::~flow_table_switch()
+{
+}
+
+status flow_table_switch::init(const flow_table_attr& attr)
+{
+    m_attr = attr;
+
+    status ret = create_table(m_active);
+    if (DPCP_OK != ret) {
+        log_error("Flow table switch failed to create active table, ret %d\n", ret);
+        return ret;
+    }
+
+    return DPCP_OK;
+}
+
+status flow_table_switch::create_table(std::shared_ptr<flow_table>& table)
+{
+    flow_table_attr attr = m_attr;
+    std::shared_ptr<flow_table> new_table;
+
+    status ret = m_adapter->create_flow_table(attr, new_table);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = new_table->create();
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+
+    table = new_table;
+    return DPCP_OK;
+}
+
+status flow_table_switch::get_shadow(std::shared_ptr<flow_table>& table)
+{
+    if (!m_shadow) {
+        status ret = create_table(m_shadow);
+        if (DPCP_OK != ret) {
+            log_error("Flow table switch failed to create shadow table, ret %d\n", ret);
+            return ret;
+        }
+    }
+
+    table = m_shadow;
+    return DPCP_OK;
+}
+
+status flow_table_switch::set_parent(std::weak_ptr<flow_rule_ex> rule)
+{
+    std::shared_ptr<flow_rule_ex> shrd_rule = rule.lock();
+    if (!shrd_rule) {
+        log_error("Flow table switch parent rule is not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    auto it = shrd_rule->m_actions.find(std::type_index(typeid(flow_action_fwd)));
+    if (it == shrd_rule->m_actions.end()) {
+        log_error("Flow table switch parent rule %p has no forward action\n", shrd_rule.get());
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    const std::vector<forwardable_obj*>& dests =
+        std::static_pointer_cast<flow_action_fwd>(it->second)->get_dest_objs();
+    if (std::find(dests.begin(), dests.end(), m_active.get()) == dests.end()) {
+        log_error("Flow table switch parent rule %p does not forward to active table\n",
+                  shrd_rule.get());
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    m_parent_rule = rule;
+    m_parent_table.reset();
+    return DPCP_OK;
+}
+
+status flow_table_switch::set_parent(std::shared_ptr<flow_table> table)
+{
+    if (!table) {
+        log_error("Flow table switch parent table is not valid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    status ret = table->set_table_miss(m_active);
+    if (DPCP_OK != ret) {
+        log_error("Flow table switch failed to set parent table miss, ret %d\n", ret);
+        return ret;
+    }
+
+    m_parent_table = table;
+    m_parent_rule.reset();
+    return DPCP_OK;
+}
+
+status flow_table_switch::redirect_rule(const std::shared_ptr<flow_rule_ex>& rule,
+                                        const std::shared_ptr<flow_table>& table)
+{
+    std::vector<std::shared_ptr<flow_action>> actions;
+
+    // Same actions, forward action gets new table in place of active one.
+    for (auto& action : rule->m_actions) {
+        if (action.first != std::type_index(typeid(flow_action_fwd))) {
+            actions.push_back(action.second);
+            continue;
+        }
+        std::vector<forwardable_obj*> dests =
+            std::static_pointer_cast<flow_action_fwd>(action.second)->get_dest_objs();
+        std::replace(dests.begin(), dests.end(), static_cast<forwardable_obj*>(m_active.get()),
+                     static_cast<forwardable_obj*>(table.get()));
+        std::shared_ptr<flow_action> fwd = m_adapter->get_flow_action_generator().create_fwd(dests);
+        if (!fwd) {
+            log_error("Flow table switch forward action allocation failed\n");
+            return DPCP_ERR_NO_MEMORY;
+        }
+        actions.push_back(fwd);
+    }
+
+    return rule->modify(actions);
+}
+
+status flow_table_switch::commit(cmd_engine* engine, uint64_t cookie)
+{
+    status ret = DPCP_OK;
+
+    if (!m_shadow) {
+        log_error("Flow table switch has no shadow table to commit\n");
+        return DPCP_ERR_NOT_APPLIED;
+    }
+
+    std::shared_ptr<flow_rule_ex> rule = m_parent_rule.lock();
+    std::shared_ptr<flow_table> parent = m_parent_table.lock();
+    if (rule) {
+        ret = redirect_rule(rule, m_shadow);
+    } else if (parent) {
+        ret = parent->set_table_miss(m_shadow);
+    } else {
+        log_error("Flow table switch has no parent\n");
+        return DPCP_ERR_NOT_APPLIED;
+    }
+    if (DPCP_OK != ret) {
+        log_error("Flow table switch failed to redirect parent, ret %d\n", ret);
+        return ret;
+    }
+
+    std::shared_ptr<flow_table> retired = m_active;
+    m_active = m_shadow;
+    m_shadow.reset();
+    log_trace("Flow table switch committed, active table %p retired table %p\n", m_active.get(),
+              retired.get());
+
+    // Destroying groups and rules of retired table takes command per object.
+    if (engine) {
+        ret = engine->submit(
+            [retired]() mutable {
+                retired.reset();
+                return DPCP_OK;
+            },
+            cookie);
+    }
+
+    return ret;
+}
+
+void flow_table_switch::discard_shadow()
+{
+    m_shadow.reset();
+}
+
+} // namespace dpcp
@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+////////////////////////////////////////////////////////////////////////
+// index_allocator implementation.                                    //
+////////////////////////////////////////////////////////////////////////
+
+index_allocator::index_allocator(uint32_t start, uint32_t size)
+    : m_start(start)
+    , m_size(size)
+    , m_used(0)
+    , m_next(0)
+    , m_bitmap((size + 63) / 64, 0)
+    , m_released()
+    , m_queued((size + 63) / 64, 0)
+{
+}
+
+bool index_allocator::alloc(uint32_t& index)
+{
+    uint32_t off = 0;
+
+    if (m_used == m_size) {
+        return false;
+    }
+
+    // Offsets reserved explicitly after release are dropped lazily.
+    while (!m_released.empty()) {
+        off = m_released.back();
+        m_released.pop_back();
+        m_queued[off >> 6] &= ~(1ULL << (off & 63));
+        if (!is_set(off)) {
+            set(off);
+            index = m_start + off;
+            return true;
+        }
+    }
+
+    while (m_next < m_size && is_set(m_next)) {
+        m_next++;
+    }
+    if (m_next == m_size) {
+        return false;
+    }
+    off = m_next++;
+    set(off);
+    index = m_start + off;
+
+    return true;
+}
+
+bool index_allocator::reserve(uint32_t index)
+{
+    if (index < m_start || index - m_start >= m_size) {
+        return false;
+    }
+
+    uint32_t off = index - m_start;
+    if (is_set(off)) {
+        return false;
+    }
+    set(off);
+
+    return true;
+}
+
+bool index_allocator::release(uint32_t index)
+{
+    if (index < m_start || index - m_start >= m_size) {
+        return false;
+    }
+
+    uint32_t off = index - m_start;
+    if (!is_set(off)) {
+        return false;
+    }
+    m_bitmap[off >> 6] &= ~(1ULL << (off & 63));
+    m_used--;
+    if (off < m_next && !is_queued(off)) {
+        m_queued[off >> 6] |= (1ULL << (off & 63));
+        m_released.push_back(off);
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+// range_allocator implementation.                                    //
+////////////////////////////////////////////////////////////////////////
+
+range_allocator::range_allocator(uint32_t size)
+    : m_free()
+    , m_size(size)
+    , m_used(0)
+{
+    if (size) {
+        m_free[0] = size;
+    }
+}
+
+bool range_allocator::alloc(uint32_t length, uint32_t& start)
+{
+    if (!length) {
+        return false;
+    }
+
+    for (auto it = m_free.begin(); it != m_free.end(); ++it) {
+        if (it->second < length) {
+            continue;
+        }
+        start = it->first;
+        if (it->second > length) {
+            m_free[start + length] = it->second - length;
+        }
+        m_free.erase(it);
+        m_used += length;
+        return true;
+    }
+
+    return false;
+}
+
+bool range_allocator::reserve(uint32_t start, uint32_t length)
+{
+    if (!length || start >= m_size || length > m_size - start) {
+        return false;
+    }
+
+    // The free extent starting at or before start must cover the whole range.
+    auto it = m_free.upper_bound(start);
+    if (it == m_free.begin()) {
+        return false;
+    }
+    --it;
+    uint32_t ext_start = it->first;
+    uint32_t ext_len = it->second;
+    if (start + length > ext_start + ext_len) {
+        return false;
+    }
+
+    m_free.erase(it);
+    if (start > ext_start) {
+        m_free[ext_start] = start - ext_start;
+    }
+    if (start + length < ext_start + ext_len) {
+        m_free[start + length] = ext_start + ext_len - start - length;
+    }
+    m_used += length;
+
+    return true;
+}
+
+void range_allocator::release(uint32_t start, uint32_t length)
+{
+    if (!length) {
+        return;
+    }
+
+    auto next = m_free.insert(std::make_pair(start, length)).first;
+    m_used -= length;
+
+    // Merge with following extent.
+    auto after = std::next(next);
+    if (after != m_free.end() && start + length == after->first) {
+        next->second += after->second;
+        m_free.erase(after);
+    }
+    // Merge with preceding extent.
+    if (next != m_free.begin()) {
+        auto before = std::prev(next);
+        if (before->first + before->second == start) {
+            before->second += next->second;
+            m_free.erase(next);
+        }
+    }
+}
+
+} // namespace dpcp
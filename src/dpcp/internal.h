@@ -33,6 +33,7 @@
 
 #include <cstring>
 #include <memory>
+#include <list>
 #include <map>
 #include <mutex>
 #include <vector>
@@ -207,6 +208,225 @@ inline int ilog2(int n)
     return e;
 }
 
+/**
+ * @brief Allocates page aligned Queue ring buffer
+ * @param [in] mode          Ring allocation mode
+ * @param [in] numa_node     Preferred NUMA node, -1 for no preference
+ * @param [in] sz            Buffer size
+ * @param [out] map_sz       Page allocation size, 0 if buffer is allocated from heap
+ *
+ * @retval Returns buffer address or nullptr on failure.
+ */
+void* alloc_ring_buf(ring_alloc_mode mode, int numa_node, size_t sz, size_t& map_sz);
+void free_ring_buf(void* buf, size_t map_sz);
+
+status reg_mem(dcmd::ctx* ctx, void* buf, size_t sz, dcmd::umem*& umem, uint32_t& mem_id);
+
+/**
+ * @brief class umem_arena - Carves Queue rings and DoorBell records out of
+ * a few large UMEM registered chunks, so Queue creation doesn't register memory.
+ * Chunks are allocated and registered on demand and kept till arena is destroyed.
+ */
+class umem_arena {
+    struct chunk {
+        uint8_t* buf;
+        size_t sz;
+        size_t map_sz;
+        dcmd::umem* umem;
+        uint32_t umem_id;
+        std::map<size_t, size_t> free_list; // offset -> length
+    };
+    struct block {
+        chunk* ch;
+        size_t offset;
+        size_t sz;
+    };
+
+    std::mutex m_mutex;
+    dcmd::ctx* m_ctx;
+    size_t m_chunk_sz;
+    ring_alloc_mode m_mode;
+    int m_numa_node;
+    std::vector<chunk*> m_chunks;
+    std::map<uintptr_t, block> m_used;
+
+    status add_chunk(size_t sz, chunk*& ch);
+    static bool carve(chunk* ch, size_t sz, size_t align, size_t& offset);
+
+public:
+    umem_arena(dcmd::ctx* ctx, size_t chunk_sz, ring_alloc_mode mode, int numa_node);
+    virtual ~umem_arena();
+
+    /**
+     * @brief Allocates and registers the first chunk
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status init();
+    /**
+     * @brief Allocates zeroed memory block from the arena
+     * @param [in] sz        Block size
+     * @param [in] align     Block alignment, power of 2
+     * @param [out] buf      Block address
+     * @param [out] umem_id  UMEM Id of the chunk
+     * @param [out] offset   Block offset inside the UMEM
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status alloc(size_t sz, size_t align, void*& buf, uint32_t& umem_id, uint64_t& offset);
+    status free(void* buf);
+
+    inline size_t num_chunks()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_chunks.size();
+    }
+
+    umem_arena(umem_arena const&) = delete;
+    void operator=(umem_arena const&) = delete;
+};
+
+/**
+ * @brief class interval_tree - AVL tree of [start, end) address ranges augmented
+ * with the maximal range end of each subtree, so overlap and containment lookups
+ * skip subtrees which can't match. Ranges may overlap, data pointers must be unique.
+ */
+class interval_tree {
+    struct node {
+        uintptr_t start;
+        uintptr_t end;
+        uintptr_t max_end;
+        void* data;
+        node* left;
+        node* right;
+        int height;
+    };
+
+    node* m_root;
+    size_t m_size;
+
+    static int height(node* n)
+    {
+        return n ? n->height : 0;
+    }
+    static bool less(uintptr_t start1, void* data1, uintptr_t start2, void* data2)
+    {
+        return start1 < start2 || (start1 == start2 && data1 < data2);
+    }
+    static void update(node* n);
+    static node* rotate_left(node* n);
+    static node* rotate_right(node* n);
+    static node* balance(node* n);
+    static node* insert(node* n, node* new_node);
+    static node* erase(node* n, uintptr_t start, void* data, bool& found);
+    static node* erase_min(node* n, node*& min);
+    static void* find_containing(node* n, uintptr_t start, uintptr_t end,
+                                 const std::function<bool(void*)>& match);
+    static void find_overlapping(node* n, uintptr_t start, uintptr_t end,
+                                 std::vector<void*>& lst);
+    static void clear(node* n);
+
+public:
+    interval_tree();
+    ~interval_tree();
+
+    /**
+     * @brief Adds range [start, end) associated with data
+     *
+     * @retval Returns DPCP_OK on success.
+     */
+    status insert(uintptr_t start, uintptr_t end, void* data);
+    /**
+     * @brief Removes range added with the same start and data
+     *
+     * @retval Returns DPCP_OK on success, DPCP_ERR_INVALID_PARAM if there is no such range.
+     */
+    status erase(uintptr_t start, void* data);
+    /**
+     * @brief Returns data of a range containing [start, end) accepted by match
+     *
+     * @retval Returns data or nullptr if not found.
+     */
+    void* find_containing(uintptr_t start, uintptr_t end,
+                          const std::function<bool(void*)>& match) const;
+    /**
+     * @brief Collects data of all ranges overlapping [start, end)
+     */
+    void find_overlapping(uintptr_t start, uintptr_t end, std::vector<void*>& lst) const;
+
+    inline size_t size() const
+    {
+        return m_size;
+    }
+
+    interval_tree(interval_tree const&) = delete;
+    void operator=(interval_tree const&) = delete;
+};
+
+/**
+ * @brief class mkey_cache - Registration cache of direct_mkeys
+ *
+ * Regions are looked up by containment in the cached registrations, an exact
+ * match returns the cached direct_mkey and a sub-range returns ref_mkey of it.
+ * Misses register the region rounded to pages. Registrations are refcounted,
+ * the unreferenced ones are kept in LRU order and deregistered when there are
+ * more than max_unused of them.
+ */
+class mkey_cache {
+    struct entry {
+        direct_mkey* mk;
+        uintptr_t start;
+        uintptr_t end;
+        mkey_flags flags;
+        uint32_t refcnt;
+        bool stale; // invalidated while referenced, deleted on the last put
+        std::list<entry*>::iterator lru_it;
+    };
+
+    std::mutex m_mutex;
+    adapter* m_adapter;
+    size_t m_max_unused;
+    interval_tree m_tree;
+    std::list<entry*> m_lru; // unreferenced entries, the most recently used first
+    std::unordered_set<entry*> m_entries;
+    std::unordered_map<mkey*, entry*> m_refs; // handed out key -> entry
+    size_t m_hits;
+    size_t m_misses;
+
+    status ref(entry* e, uintptr_t start, uintptr_t end, mkey*& mk);
+    void evict(std::vector<direct_mkey*>& victims);
+
+public:
+    mkey_cache(adapter* ad, size_t max_unused);
+    virtual ~mkey_cache();
+
+    status get(void* address, size_t length, mkey_flags flags, mkey*& mk);
+    status put(mkey* mk);
+    status invalidate(void* address, size_t length);
+
+    inline size_t num_entries()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+    inline void get_stats(size_t& hits, size_t& misses)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        hits = m_hits;
+        misses = m_misses;
+    }
+
+    mkey_cache(mkey_cache const&) = delete;
+    void operator=(mkey_cache const&) = delete;
+};
+
+// KLM and KSM translation entry, KSM entries have no byte_count
+struct klm_seg {
+    uint32_t byte_count;
+    uint32_t mkey;
+    uint64_t address;
+};
+
 class packet_pacing : public obj {
 private:
     pp_handle* m_pp_handle;
@@ -284,10 +504,14 @@ public:
  *         chosen.
  */
 class flow_action_reformat : public flow_action {
+    friend class flow_action_generator;
+
 private:
     flow_action_reformat_attr m_attr;
     bool m_is_valid;
     uint32_t m_reformat_id;
+    std::unique_ptr<uint8_t[]> m_in;
+    size_t m_inlen;
 
 public:
     flow_action_reformat(dcmd::ctx* ctx, flow_action_reformat_attr& attr);
@@ -300,6 +524,7 @@ private:
     // Help functions
     status alloc_reformat_insert_action(std::unique_ptr<uint8_t[]>& in_mem_guard, size_t& in_len,
                                         flow_action_reformat_attr& attr);
+    status create_prm_reformat();
 };
 
 /**
@@ -309,6 +534,8 @@ private:
  *         for the @ref flow_action_modify_type chosen.
  */
 class flow_action_modify : public flow_action {
+    friend class flow_action_generator;
+
 private:
     flow_action_modify_attr m_attr;
     bool m_is_valid;
@@ -318,6 +545,7 @@ private:
     size_t m_outlen = sizeof(m_out);
     std::unique_ptr<uint8_t[]> m_in;
     size_t m_inlen = 0;
+    std::mutex m_lock;
 
 public:
     flow_action_modify(dcmd::ctx* ctx, flow_action_modify_attr& attr);
@@ -373,6 +601,20 @@ private:
     status create_root_action_fwd();
 };
 
+/**
+ * @brief: Flow action counter, counts packets by counter of @ref flow_counter_bulk.
+ */
+class flow_action_counter : public flow_action {
+private:
+    uint32_t m_counter_id;
+
+public:
+    flow_action_counter(dcmd::ctx* ctx, uint32_t counter_id);
+    virtual ~flow_action_counter() = default;
+    virtual status apply(void* in) override;
+    virtual status apply(dcmd::flow_desc& flow_desc) override;
+};
+
 /**
  * @brief: Flow action reparse, triggers HW packet reparse.
  */
@@ -431,6 +673,119 @@ private:
                                          const match_params_ex& match_value) const;
 };
 
+/**
+ * @brief class flow_rule_registry - Rules of a flow group indexed by match value.
+ * The key is the PRM match param of the rule masked by the group match criteria,
+ * only dwords covered by the criteria are hashed and compared.
+ * Kernel groups add the rule priority to the key, so rules of the same match value
+ * are kept only at different priorities. Insert of an existing key is refused.
+ * Flat open addressing table with linear probing and backward shift removal.
+ */
+class flow_rule_registry {
+    struct slot {
+        uint64_t hash;
+        std::shared_ptr<flow_rule_ex> rule; // nullptr for free slot
+    };
+
+    std::shared_ptr<const flow_matcher> m_matcher;
+    bool m_by_priority;
+    std::vector<uint32_t> m_key_dws; // dword offsets of match param covered by criteria
+    std::vector<uint32_t> m_key_masks;
+    std::vector<slot> m_slots;
+    size_t m_size;
+
+public:
+    flow_rule_registry(std::shared_ptr<const flow_matcher> matcher, bool by_priority);
+    status init(const match_params_ex& match_criteria);
+    status insert(const std::shared_ptr<flow_rule_ex>& rule);
+    std::shared_ptr<flow_rule_ex> find(const match_params_ex& match_value,
+                                       uint16_t priority) const;
+    bool erase(const std::shared_ptr<flow_rule_ex>& rule);
+    bool contains(const std::shared_ptr<flow_rule_ex>& rule) const;
+    inline size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    status get_key(const match_params_ex& match_value, uint16_t priority, uint32_t* key,
+                   uint64_t& hash) const;
+    inline size_t get_key_len() const
+    {
+        return m_key_dws.size() + (m_by_priority ? 1 : 0);
+    }
+    size_t lookup(const uint32_t* key, uint64_t hash) const;
+    size_t lookup(const std::shared_ptr<flow_rule_ex>& rule) const;
+    bool rehash(size_t num_slots);
+};
+
+/**
+ * @brief class index_allocator - Hands out free indices of [start, start + size).
+ * Released indices are reused first, then never used ones in order, both O(1).
+ * The bitmap detects indices which are already in use.
+ */
+class index_allocator {
+    uint32_t m_start;
+    uint32_t m_size;
+    uint32_t m_used;
+    uint32_t m_next; // lowest offset never handed out by alloc()
+    std::vector<uint64_t> m_bitmap;
+    std::vector<uint32_t> m_released; // may hold offsets reserved again since
+    std::vector<uint64_t> m_queued; // offsets in m_released, each is queued once
+
+    inline bool is_set(uint32_t off) const
+    {
+        return (m_bitmap[off >> 6] >> (off & 63)) & 1;
+    }
+    inline bool is_queued(uint32_t off) const
+    {
+        return (m_queued[off >> 6] >> (off & 63)) & 1;
+    }
+    inline void set(uint32_t off)
+    {
+        m_bitmap[off >> 6] |= (1ULL << (off & 63));
+        m_used++;
+    }
+
+public:
+    index_allocator(uint32_t start, uint32_t size);
+    bool alloc(uint32_t& index);
+    bool reserve(uint32_t index);
+    bool release(uint32_t index);
+    inline uint32_t get_used() const
+    {
+        return m_used;
+    }
+    inline uint32_t get_size() const
+    {
+        return m_size;
+    }
+};
+
+/**
+ * @brief class range_allocator - First fit placement of ranges in [0, size),
+ * free extents are kept sorted and merged on release.
+ */
+class range_allocator {
+    std::map<uint32_t, uint32_t> m_free; // start to length of free extent
+    uint32_t m_size;
+    uint32_t m_used;
+
+public:
+    range_allocator(uint32_t size);
+    bool alloc(uint32_t length, uint32_t& start);
+    bool reserve(uint32_t start, uint32_t length);
+    void release(uint32_t start, uint32_t length);
+    inline uint32_t get_used() const
+    {
+        return m_used;
+    }
+    inline uint32_t get_size() const
+    {
+        return m_size;
+    }
+};
+
 /**
  * @brief flow_table_prm class, implements flow_table interface.
  */
@@ -440,6 +795,7 @@ class flow_table_prm : public flow_table {
 private:
     uint32_t m_table_id;
     flow_table_attr m_attr;
+    range_allocator m_group_ranges;
 
 public:
     virtual status create() override;
@@ -448,6 +804,9 @@ public:
     virtual status get_table_level(uint8_t& table_level) const override;
     virtual status add_flow_group(const flow_group_attr& attr,
                                   std::weak_ptr<flow_group>& group) override;
+    virtual status remove_flow_group(std::weak_ptr<flow_group>& group) override;
+    virtual status get_occupancy(uint32_t& used, uint32_t& size) const override;
+    virtual status set_table_miss(std::shared_ptr<flow_table> table) override;
     virtual ~flow_table_prm() = default;
 
 private:
@@ -456,7 +815,7 @@ private:
      *        @ref adapter::create_flow_table.
      */
     flow_table_prm(dcmd::ctx* ctx, const flow_table_attr& attr);
-    status set_miss_action(void* in);
+    status set_miss_action(void* ft_ctx);
 };
 
 /**
@@ -488,16 +847,22 @@ private:
     flow_table_kernel(dcmd::ctx* ctx, flow_table_type type);
 };
 
+class flow_rule_ex_prm;
+
 class flow_group_prm : public flow_group {
     friend class flow_table;
 
 private:
     uint32_t m_group_id;
+    index_allocator m_flow_indexes;
 
 public:
     virtual status create() override;
     virtual status add_flow_rule(const flow_rule_attr_ex& attr,
                                  std::weak_ptr<flow_rule_ex>& rule) override;
+    virtual status add_flow_rules(const flow_rule_attr_ex* attrs, size_t num,
+                                  std::vector<std::weak_ptr<flow_rule_ex>>& rules) override;
+    virtual status remove_flow_rule(std::weak_ptr<flow_rule_ex>& rule) override;
     status get_group_id(uint32_t& group_id) const;
     status get_table_id(uint32_t& table_id) const;
     virtual ~flow_group_prm() = default;
@@ -509,15 +874,24 @@ private:
      */
     flow_group_prm(dcmd::ctx* ctx, const flow_group_attr& attr,
                    std::weak_ptr<const flow_table> table);
+    status place_flow_rule(flow_rule_ex_prm& rule);
+    void erase_flow_rule(const std::shared_ptr<flow_rule_ex>& rule);
 };
 
 class flow_group_kernel : public flow_group {
     friend class flow_table;
 
+private:
+    // Kernel matchers shared by rules of the group, by rule priority.
+    mutable std::mutex m_dcmd_matchers_lock;
+    mutable std::map<uint16_t, std::weak_ptr<dcmd::flow_matcher>> m_dcmd_matchers;
+
 public:
     virtual status create() override;
     virtual status add_flow_rule(const flow_rule_attr_ex& attr,
                                  std::weak_ptr<flow_rule_ex>& rule) override;
+    status get_dcmd_matcher(dcmd::ctx* ctx, uint16_t priority,
+                            std::shared_ptr<dcmd::flow_matcher>& matcher) const;
     virtual ~flow_group_kernel() = default;
 
 private:
@@ -531,12 +905,14 @@ private:
 
 class flow_rule_ex_prm : public flow_rule_ex {
     friend class flow_group;
+    friend class flow_group_prm;
 
 private:
     uint32_t m_flow_index;
 
 public:
     virtual status create() override;
+    virtual status modify(const std::vector<std::shared_ptr<flow_action>>& actions) override;
     virtual ~flow_rule_ex_prm() = default;
 
 private:
@@ -549,19 +925,24 @@ private:
                      std::shared_ptr<const flow_matcher> matcher);
 
     // Help functions.
+    size_t get_in_len() const;
     status alloc_in_buff(size_t& in_len, std::unique_ptr<uint8_t[]>& in_mem_guard);
     status config_flow_rule(void* in);
+    status fill_fte(void* in);
+    status create_fte(void* in, size_t in_len);
+    uint8_t get_modify_mask(const action_map_t& actions) const;
 };
 
 class flow_rule_ex_kernel : public flow_rule_ex {
     friend class flow_group;
 
 private:
-    uint16_t m_priority;
     dcmd::flow* m_flow;
+    std::shared_ptr<dcmd::flow_matcher> m_dcmd_matcher;
 
 public:
     virtual status create() override;
+    virtual status modify(const std::vector<std::shared_ptr<flow_action>>& actions) override;
     virtual ~flow_rule_ex_kernel();
 
 private:
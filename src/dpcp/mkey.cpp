@@ -32,6 +32,7 @@
 #include "config.h"
 #endif
 
+#include <algorithm>
 #include <atomic>
 
 #include "utils/os.h"
@@ -486,6 +487,172 @@ status pattern_mkey::create()
     return ret;
 }
 
+klm_mkey::klm_mkey(adapter* ad, void* address, mkey_flags flags, size_t entries_num,
+                   const klm_mkey_entry* entries)
+    : indirect_mkey(ad)
+    , m_adapter(ad)
+    , m_entries(entries, entries + entries_num)
+    , m_mkeys()
+    , m_address(address)
+    , m_length(0)
+    , m_flags(flags)
+    , m_idx(0)
+    , m_log_entity_sz(0)
+{
+    for (auto& entry : m_entries) {
+        m_mkeys.push_back(entry.m_key);
+        m_length += entry.m_length;
+    }
+    // Fixed size entities are translated by offset, no lookup over entries
+    size_t entity_sz = entries_num ? entries[0].m_length : 0;
+    if (entity_sz >= get_page_size() && 0 == (entity_sz & (entity_sz - 1)) &&
+        entity_sz <= UINT32_MAX) {
+        bool same_sz = true;
+        for (auto& entry : m_entries) {
+            same_sz = same_sz && entry.m_length == entity_sz;
+        }
+        if (same_sz) {
+            // Entity size may not fit int, log2 is taken on the full size.
+            while (((uint64_t)1 << m_log_entity_sz) < entity_sz) {
+                m_log_entity_sz++;
+            }
+        }
+    }
+    log_trace("klm_mkey entries_num %zd length %zd log_entity_sz %u\n", entries_num, m_length,
+              m_log_entity_sz);
+}
+
+klm_mkey::~klm_mkey()
+{
+}
+
+status klm_mkey::get_mkeys_num(size_t& mkeys_num)
+{
+    mkeys_num = m_mkeys.size();
+    return DPCP_OK;
+}
+
+status klm_mkey::get_mkeys_lst(mkey*& mkeys_lst)
+{
+    if (m_mkeys.empty()) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    mkeys_lst = (mkey*)m_mkeys.data();
+    return DPCP_OK;
+}
+
+status klm_mkey::get_id(uint32_t& id)
+{
+    id = m_idx;
+    return DPCP_OK;
+}
+
+status klm_mkey::get_address(void*& address)
+{
+    address = m_address;
+    if (nullptr == address && 0 == (m_flags & MKEY_ZERO_BASED)) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    return DPCP_OK;
+}
+
+status klm_mkey::get_length(size_t& len)
+{
+    if (0 == m_length) {
+        return DPCP_ERR_OUT_OF_RANGE;
+    }
+    len = m_length;
+    return DPCP_OK;
+}
+
+status klm_mkey::get_flags(mkey_flags& flags)
+{
+    flags = m_flags;
+    return DPCP_OK;
+}
+
+/*
+ * See PRM sec. 9.6.1 Indirect Memory Keys
+ */
+status klm_mkey::create()
+{
+    if (m_entries.empty() || 0 == m_length) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    uint32_t id = m_adapter->get_pd();
+    if (0 == id) {
+        log_error("klm_mkey::create PD num is not avalaible!\n");
+        return DPCP_ERR_CREATE;
+    }
+    // Translation table is in octwords (16 Bytes), aligned to 4 octwords.
+    // The last entries are padded with zeros.
+    uint32_t aligned_sz = align((uint32_t)m_entries.size(), 4);
+    uint32_t table_sz = aligned_sz;
+    if (m_flags & MKEY_UMR_ENABLED) {
+        // Room for translation set by UMR later
+        table_sz = std::max(table_sz, (uint32_t)UMR_MAX_ENTRIES);
+    }
+    size_t inlen = DEVX_ST_SZ_BYTES(create_mkey_in) + aligned_sz * sizeof(klm_seg);
+    uint32_t* in = new (std::nothrow) uint32_t[inlen / sizeof(uint32_t)];
+    if (nullptr == in) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(in, 0, inlen);
+    uint32_t out[DEVX_ST_SZ_DW(create_mkey_out)] = {};
+    size_t outlen = sizeof(out);
+
+    DEVX_SET(create_mkey_in, in, translations_octword_actual_size, (uint32_t)m_entries.size());
+    void* p_mkeyc = DEVX_ADDR_OF(create_mkey_in, in, memory_key_mkey_entry);
+    DEVX_SET(mkc, p_mkeyc, access_mode_4_2, 0x0);
+    DEVX_SET(mkc, p_mkeyc, lw, 0x1);
+    DEVX_SET(mkc, p_mkeyc, lr, 0x1);
+    DEVX_SET(mkc, p_mkeyc, umr_en, (m_flags & MKEY_UMR_ENABLED) ? 1 : 0);
+    DEVX_SET(mkc, p_mkeyc, access_mode_1_0,
+             is_ksm() ? MLX5_MKC_ACCESS_MODE_KSM : MLX5_MKC_ACCESS_MODE_KLMS);
+    DEVX_SET(mkc, p_mkeyc, qpn, 0xffffff);
+    // Obtain next Mkey counter from static value
+    int mkey_cnt = g_mkey_cnt.load();
+    while (!g_mkey_cnt.compare_exchange_strong(mkey_cnt, mkey_cnt + 1, std::memory_order_seq_cst) &&
+           (mkey_cnt < g_mkey_cnt))
+        ;
+    DEVX_SET(mkc, p_mkeyc, mkey_7_0, mkey_cnt % 0xFF);
+    DEVX_SET(mkc, p_mkeyc, pd, id);
+    uint64_t addr = (uint64_t)m_address;
+    if (m_flags & MKEY_ZERO_BASED) {
+        addr = 0;
+    }
+    DEVX_SET64(mkc, p_mkeyc, start_addr, addr);
+    DEVX_SET64(mkc, p_mkeyc, len, (uint64_t)m_length);
+    DEVX_SET(mkc, p_mkeyc, translations_octword_size, table_sz);
+    DEVX_SET(mkc, p_mkeyc, log_entity_size, m_log_entity_sz);
+    //
+    // Fill translation entries
+    klm_seg* klm = (klm_seg*)DEVX_ADDR_OF(create_mkey_in, in, klm_pas_mtt_bsf);
+    for (size_t i = 0; i < m_entries.size(); i++) {
+        status ret = m_entries[i].m_key->get_id(id);
+        if (DPCP_OK != ret) {
+            log_trace("Can't get id for MKey %p ret = %d\n", m_entries[i].m_key, ret);
+            delete[] in;
+            return ret;
+        }
+        if (!is_ksm()) {
+            klm[i].byte_count = htobe32((uint32_t)m_entries[i].m_length);
+        }
+        klm[i].mkey = htobe32(id);
+        klm[i].address = htobe64((uint64_t)m_entries[i].m_address);
+    }
+    DEVX_SET(create_mkey_in, in, opcode, MLX5_CMD_OP_CREATE_MKEY);
+    status ret = obj::create(in, inlen, out, outlen);
+    delete[] in;
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    m_idx = DEVX_GET(create_mkey_out, out, mkey_index) << 8;
+    m_idx |= (mkey_cnt % 0xFF);
+    log_trace("klm_mkey mkey_cnt: %d mkey_idx: 0x%x ksm: %d\n", mkey_cnt, m_idx, is_ksm());
+    return ret;
+}
+
 reserved_mkey::reserved_mkey(adapter* ad, reserved_mkey_type type, void* address, size_t length,
                              mkey_flags flags)
     : mkey(ad->get_ctx())
@@ -0,0 +1,448 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+
+namespace dpcp {
+
+interval_tree::interval_tree()
+    : m_root(nullptr)
+    , m_size(0)
+{
+}
+
+interval_tree::~interval_tree()
+{
+    clear(m_root);
+}
+
+void interval_tree::clear(node* n)
+{
+    if (n) {
+        clear(n->left);
+        clear(n->right);
+        delete n;
+    }
+}
+
+void interval_tree::update(node* n)
+{
+    n->height = 1 + std::max(height(n->left), height(n->right));
+    n->max_end = n->end;
+    if (n->left) {
+        n->max_end = std::max(n->max_end, n->left->max_end);
+    }
+    if (n->right) {
+        n->max_end = std::max(n->max_end, n->right->max_end);
+    }
+}
+
+interval_tree::node* interval_tree::rotate_left(node* n)
+{
+    node* r = n->right;
+    n->right = r->left;
+    r->left = n;
+    update(n);
+    update(r);
+    return r;
+}
+
+interval_tree::node* interval_tree::rotate_right(node* n)
+{
+    node* l = n->left;
+    n->left = l->right;
+    l->right = n;
+    update(n);
+    update(l);
+    return l;
+}
+
+interval_tree::node* interval_tree::balance(node* n)
+{
+    update(n);
+    int bf = height(n->left) - height(n->right);
+    if (bf > 1) {
+        if (height(n->left->left) < height(n->left->right)) {
+            n->left = rotate_left(n->left);
+        }
+        return rotate_right(n);
+    }
+    if (bf < -1) {
+        if (height(n->right->right) < height(n->right->left)) {
+            n->right = rotate_right(n->right);
+        }
+        return rotate_left(n);
+    }
+    return n;
+}
+
+interval_tree::node* interval_tree::insert(node* n, node* new_node)
+{
+    if (nullptr == n) {
+        return new_node;
+    }
+    if (less(new_node->start, new_node->data, n->start, n->data)) {
+        n->left = insert(n->left, new_node);
+    } else {
+        n->right = insert(n->right, new_node);
+    }
+    return balance(n);
+}
+
+interval_tree::node* interval_tree::erase_min(node* n, node*& min)
+{
+    if (nullptr == n->left) {
+        min = n;
+        return n->right;
+    }
+    n->left = erase_min(n->left, min);
+    return balance(n);
+}
+
+interval_tree::node* interval_tree::erase(node* n, uintptr_t start, void* data, bool& found)
+{
+    if (nullptr == n) {
+        return nullptr;
+    }
+    if (less(start, data, n->start, n->data)) {
+        n->left = erase(n->left, start, data, found);
+    } else if (less(n->start, n->data, start, data)) {
+        n->right = erase(n->right, start, data, found);
+    } else {
+        found = true;
+        node* l = n->left;
+        node* r = n->right;
+        delete n;
+        if (nullptr == r) {
+            return l;
+        }
+        node* min = nullptr;
+        r = erase_min(r, min);
+        min->left = l;
+        min->right = r;
+        return balance(min);
+    }
+    return balance(n);
+}
+
+void* interval_tree::find_containing(node* n, uintptr_t start, uintptr_t end,
+                                     const std::function<bool(void*)>& match)
+{
+    // No range of the subtree reaches the end
+    if (nullptr == n || n->max_end < end) {
+        return nullptr;
+    }
+    void* data = find_containing(n->left, start, end, match);
+    if (data) {
+        return data;
+    }
+    // Ranges of the right subtree start after this one
+    if (n->start > start) {
+        return nullptr;
+    }
+    if (n->end >= end && match(n->data)) {
+        return n->data;
+    }
+    return find_containing(n->right, start, end, match);
+}
+
+void interval_tree::find_overlapping(node* n, uintptr_t start, uintptr_t end,
+                                     std::vector<void*>& lst)
+{
+    if (nullptr == n || n->max_end <= start) {
+        return;
+    }
+    find_overlapping(n->left, start, end, lst);
+    if (n->start >= end) {
+        return;
+    }
+    if (n->end > start) {
+        lst.push_back(n->data);
+    }
+    find_overlapping(n->right, start, end, lst);
+}
+
+status interval_tree::insert(uintptr_t start, uintptr_t end, void* data)
+{
+    if (start >= end) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    node* n = new (std::nothrow) node();
+    if (nullptr == n) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    n->start = start;
+    n->end = end;
+    n->max_end = end;
+    n->data = data;
+    n->left = nullptr;
+    n->right = nullptr;
+    n->height = 1;
+    m_root = insert(m_root, n);
+    m_size++;
+    return DPCP_OK;
+}
+
+status interval_tree::erase(uintptr_t start, void* data)
+{
+    bool found = false;
+    m_root = erase(m_root, start, data, found);
+    if (!found) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    m_size--;
+    return DPCP_OK;
+}
+
+void* interval_tree::find_containing(uintptr_t start, uintptr_t end,
+                                     const std::function<bool(void*)>& match) const
+{
+    return find_containing(m_root, start, end, match);
+}
+
+void interval_tree::find_overlapping(uintptr_t start, uintptr_t end,
+                                     std::vector<void*>& lst) const
+{
+    find_overlapping(m_root, start, end, lst);
+}
+
+mkey_cache::mkey_cache(adapter* ad, size_t max_unused)
+    : m_mutex()
+    , m_adapter(ad)
+    , m_max_unused(max_unused)
+    , m_tree()
+    , m_lru()
+    , m_entries()
+    , m_refs()
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+mkey_cache::~mkey_cache()
+{
+    for (auto& ref : m_refs) {
+        if (ref.first != ref.second->mk) {
+            delete ref.first;
+        }
+    }
+    m_refs.clear();
+    for (auto e : m_entries) {
+        delete e->mk;
+        delete e;
+    }
+    m_entries.clear();
+}
+
+status mkey_cache::ref(entry* e, uintptr_t start, uintptr_t end, mkey*& mk)
+{
+    if (e->start == start && e->end == end) {
+        mk = e->mk;
+    } else {
+        ref_mkey* rmk = new (std::nothrow) ref_mkey(m_adapter, (void*)start, end - start);
+        if (nullptr == rmk) {
+            return DPCP_ERR_NO_MEMORY;
+        }
+        status ret = rmk->create(e->mk);
+        if (DPCP_OK != ret) {
+            delete rmk;
+            return ret;
+        }
+        m_refs[rmk] = e;
+        mk = rmk;
+    }
+    if (0 == e->refcnt++) {
+        m_lru.erase(e->lru_it);
+    }
+    return DPCP_OK;
+}
+
+void mkey_cache::evict(std::vector<direct_mkey*>& victims)
+{
+    while (m_lru.size() > m_max_unused) {
+        entry* e = m_lru.back();
+        m_lru.pop_back();
+        m_tree.erase(e->start, e);
+        m_entries.erase(e);
+        m_refs.erase(e->mk);
+        victims.push_back(e->mk);
+        delete e;
+    }
+}
+
+status mkey_cache::get(void* address, size_t length, mkey_flags flags, mkey*& mk)
+{
+    if (nullptr == address || 0 == length) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    uintptr_t start = (uintptr_t)address;
+    uintptr_t end = start + length;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Sub-ranges are referenced for regular virtual address based keys only
+        void* found = m_tree.find_containing(start, end, [&](void* data) {
+            entry* e = (entry*)data;
+            return e->flags == flags &&
+                (MKEY_NONE == flags || (e->start == start && e->end == end));
+        });
+        if (found) {
+            m_hits++;
+            return ref((entry*)found, start, end, mk);
+        }
+        m_misses++;
+    }
+    // Register whole pages, they are pinned anyway, to serve neighbouring buffers
+    uintptr_t reg_start = start;
+    uintptr_t reg_end = end;
+    if (MKEY_NONE == flags) {
+        uintptr_t page_sz = (uintptr_t)get_page_size();
+        reg_start = start & ~(page_sz - 1);
+        reg_end = (end + page_sz - 1) & ~(page_sz - 1);
+    }
+    direct_mkey* dmk = nullptr;
+    status ret =
+        m_adapter->create_direct_mkey((void*)reg_start, reg_end - reg_start, flags, dmk);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    entry* e = new (std::nothrow) entry();
+    if (nullptr == e) {
+        delete dmk;
+        return DPCP_ERR_NO_MEMORY;
+    }
+    e->mk = dmk;
+    e->start = reg_start;
+    e->end = reg_end;
+    e->flags = flags;
+    e->refcnt = 0;
+    e->stale = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ret = m_tree.insert(reg_start, reg_end, e);
+        if (DPCP_OK == ret) {
+            m_entries.insert(e);
+            m_refs[dmk] = e;
+            m_lru.push_front(e);
+            e->lru_it = m_lru.begin();
+            log_trace("mkey_cache: registered %p len: %zd for %p len: %zd\n", (void*)reg_start,
+                      (size_t)(reg_end - reg_start), address, length);
+            ret = ref(e, start, end, mk);
+            if (DPCP_OK == ret) {
+                return ret;
+            }
+            // New entry is not cached if the sub-range reference fails
+            m_tree.erase(reg_start, e);
+            m_entries.erase(e);
+            m_refs.erase(dmk);
+            m_lru.erase(e->lru_it);
+        }
+    }
+    // Deregister out of the lock
+    delete dmk;
+    delete e;
+    return ret;
+}
+
+status mkey_cache::put(mkey* mk)
+{
+    std::vector<direct_mkey*> victims;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_refs.find(mk);
+        if (m_refs.end() == it) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        entry* e = it->second;
+        if (0 == e->refcnt) {
+            log_error("mkey_cache: mkey %p is not referenced\n", mk);
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        if (mk != e->mk) {
+            m_refs.erase(it);
+            delete mk;
+        }
+        if (0 == --e->refcnt) {
+            if (e->stale) {
+                m_entries.erase(e);
+                m_refs.erase(e->mk);
+                victims.push_back(e->mk);
+                delete e;
+            } else {
+                m_lru.push_front(e);
+                e->lru_it = m_lru.begin();
+                evict(victims);
+            }
+        }
+    }
+    // Deregister out of the lock
+    for (auto dmk : victims) {
+        delete dmk;
+    }
+    return DPCP_OK;
+}
+
+status mkey_cache::invalidate(void* address, size_t length)
+{
+    std::vector<direct_mkey*> victims;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<void*> lst;
+        uintptr_t start = (uintptr_t)address;
+        m_tree.find_overlapping(start, start + length, lst);
+        for (auto data : lst) {
+            entry* e = (entry*)data;
+            m_tree.erase(e->start, e);
+            if (e->refcnt) {
+                e->stale = true;
+                continue;
+            }
+            m_lru.erase(e->lru_it);
+            m_entries.erase(e);
+            m_refs.erase(e->mk);
+            victims.push_back(e->mk);
+            delete e;
+        }
+    }
+    for (auto dmk : victims) {
+        delete dmk;
+    }
+    return DPCP_OK;
+}
+
+} // namespace dpcp
@@ -117,6 +117,11 @@ status rq::modify_state(rq_state new_state)
     return DPCP_OK;
 }
 
+status rq::modify_state_async(rq_state new_state, cmd_engine& engine, uint64_t cookie)
+{
+    return engine.submit([this, new_state]() { return modify_state(new_state); }, cookie);
+}
+
 status rq::get_hw_buff_stride_sz(size_t& buff_stride_sz)
 {
     buff_stride_sz = m_attr.buf_stride_sz;
@@ -143,6 +148,10 @@ basic_rq::basic_rq(const adapter* ad, const rq_attr& attr)
     , m_wq_buf_umem(nullptr)
     , m_db_rec(nullptr)
     , m_db_rec_umem(nullptr)
+    , m_wq_buf_map_sz(0)
+    , m_arena(nullptr)
+    , m_wq_buf_umem_offset(0)
+    , m_db_rec_umem_offset(0)
     , m_wq_buf_umem_id(0)
     , m_db_rec_umem_id(0)
     , m_mem_type(MEMORY_RQ_INLINE)
@@ -166,6 +175,14 @@ status basic_rq::destroy()
         delete m_uar;
         m_uar = nullptr;
     }
+    // Return WQ buffer and DB record to the arena owning their UMEM
+    if (m_arena) {
+        m_arena->free(m_wq_buf);
+        m_arena->free(m_db_rec);
+        m_wq_buf = nullptr;
+        m_db_rec = nullptr;
+        m_arena = nullptr;
+    }
     // Deregister UMEM for WQ and DB
     if (m_wq_buf_umem) {
         delete m_wq_buf_umem;
@@ -177,7 +194,7 @@ status basic_rq::destroy()
     }
     // Deallocated WQ buffer and DoorBell record
     if (m_wq_buf) {
-        ::aligned_free((void*)m_wq_buf);
+        free_ring_buf(m_wq_buf, m_wq_buf_map_sz);
         m_wq_buf = nullptr;
     }
     if (m_db_rec) {
@@ -212,14 +229,12 @@ status ibq_rq::get_ibq_protocol(dpcp_ibq_protocol& protocol)
 status basic_rq::allocate_wq_buf(void*& wq_buf, size_t sz)
 {
     // Allocate WQ buffer
-    // Registered memory must be aligned and multiple of page-size.
-    size_t page_size = get_page_size();
-    size_t mul_of_page_sz = (sz + page_size - 1) & ~(page_size - 1);
-    wq_buf = ::aligned_alloc(page_size, mul_of_page_sz);
+    wq_buf = alloc_ring_buf(m_adapter->get_ring_alloc_mode(), m_adapter->get_numa_node(), sz,
+                            m_wq_buf_map_sz);
     if (nullptr == wq_buf) {
         return DPCP_ERR_NO_MEMORY;
     }
-    log_trace("Allocated WQ Buf %zd -> %p\n", sz, wq_buf);
+    log_trace("Allocated WQ Buf %zd -> %p map: %zd\n", sz, wq_buf, m_wq_buf_map_sz);
     m_wq_buf = wq_buf;
     m_wq_buf_sz_bytes = (uint32_t)sz;
     return DPCP_OK;
@@ -240,6 +255,28 @@ status basic_rq::allocate_db_rec(uint32_t*& db_rec, size_t& sz)
     return DPCP_OK;
 }
 
+status basic_rq::alloc_from_arena(umem_arena* arena)
+{
+    void* db_rec = nullptr;
+    status ret = arena->alloc(m_wq_buf_sz_bytes, get_page_size(), m_wq_buf, m_wq_buf_umem_id,
+                              m_wq_buf_umem_offset);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = arena->alloc(64, get_cacheline_size(), db_rec, m_db_rec_umem_id, m_db_rec_umem_offset);
+    if (DPCP_OK != ret) {
+        arena->free(m_wq_buf);
+        m_wq_buf = nullptr;
+        return ret;
+    }
+    m_db_rec = (uint32_t*)db_rec;
+    m_arena = arena;
+    log_trace("RQ WQ Buf %p umem_id: %x offset: 0x%llx DBRec %p offset: 0x%llx\n", m_wq_buf,
+              m_wq_buf_umem_id, (unsigned long long)m_wq_buf_umem_offset, m_db_rec,
+              (unsigned long long)m_db_rec_umem_offset);
+    return DPCP_OK;
+}
+
 status basic_rq::get_wq_buf(void*& buf_addr)
 {
     if (nullptr == m_wq_buf) {
@@ -331,7 +368,7 @@ status striding_rq::create()
     // UAR PageId number
     // DEVX_SET(wq, p_wq, uar_page, (m_uar->m_page_id & 0xFFFFFF));
     // Offset of the DB record address inside DB umem
-    DEVX_SET64(wq, p_wq, dbr_addr, 0x0);
+    DEVX_SET64(wq, p_wq, dbr_addr, m_db_rec_umem_offset);
     // Log of WQ stride size. The size of a WQ stride equals 2^log_wq_stride.
     int32_t log_wq_stride = ilog2((int)m_attr.wqe_sz);
     DEVX_SET(wq, p_wq, log_wq_stride, log_wq_stride);
@@ -388,7 +425,7 @@ status striding_rq::create()
     // WQ buffer umem Id
     DEVX_SET(wq, p_wq, wq_umem_id, m_wq_buf_umem_id);
     // Offset of RQ buffer inside WQ umem
-    DEVX_SET64(wq, p_wq, wq_umem_offset, 0x0);
+    DEVX_SET64(wq, p_wq, wq_umem_offset, m_wq_buf_umem_offset);
 
     // Send mailbox
     DEVX_SET(create_rq_in, in, opcode, MLX5_CMD_OP_CREATE_RQ);
@@ -453,7 +490,7 @@ status regular_rq::create()
     // UAR PageId number
     // DEVX_SET(wq, p_wq, uar_page, (m_uar->m_page_id & 0xFFFFFF));
     // Offset of the DB record address inside DB umem
-    DEVX_SET64(wq, p_wq, dbr_addr, 0x0);
+    DEVX_SET64(wq, p_wq, dbr_addr, m_db_rec_umem_offset);
     // Log of WQ stride size. The size of a WQ stride equals 2^log_wq_stride.
     uint32_t wqe_stride_size = 0U;
     get_wq_stride_sz(wqe_stride_size);
@@ -475,7 +512,7 @@ status regular_rq::create()
     // WQ buffer umem Id
     DEVX_SET(wq, p_wq, wq_umem_id, m_wq_buf_umem_id);
     // Offset of RQ buffer inside WQ umem
-    DEVX_SET64(wq, p_wq, wq_umem_offset, 0x0);
+    DEVX_SET64(wq, p_wq, wq_umem_offset, m_wq_buf_umem_offset);
 
     // Send mailbox
     DEVX_SET(create_rq_in, in, opcode, MLX5_CMD_OP_CREATE_RQ);
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+rqt::rqt(dcmd::ctx* ctx)
+    : obj(ctx)
+    , m_rqtn(0)
+    , m_max_size(0)
+{
+}
+
+rqt::~rqt()
+{
+}
+
+// HW takes the entry by the low log2(size) bits of the hash, so size must be a power of 2.
+static uint32_t get_rqt_size(size_t num)
+{
+    uint32_t size = 1;
+
+    while (size < num && size < RQT_MAX_SIZE) {
+        size <<= 1;
+    }
+    return size;
+}
+
+// RQ numbers are replicated up to the table size, as the kernel driver does.
+static void set_rq_nums(void* rqt_ctx, const std::vector<uint32_t>& rqns, uint32_t size)
+{
+    uint8_t* rq_num = (uint8_t*)DEVX_ADDR_OF(rqtc, rqt_ctx, rq_num);
+
+    DEVX_SET(rqtc, rqt_ctx, rqt_actual_size, size);
+    for (uint32_t i = 0; i < size; i++) {
+        DEVX_SET(rq_num, rq_num + i * DEVX_ST_SZ_BYTES(rq_num), rq_num, rqns[i % rqns.size()]);
+    }
+}
+
+status rqt::create(const std::vector<uint32_t>& rqns, uint32_t max_size)
+{
+    status ret = DPCP_OK;
+    uint32_t out[DEVX_ST_SZ_DW(create_rqt_out)] = {0};
+    size_t outlen = sizeof(out);
+    uintptr_t handle;
+
+    if (DPCP_OK == get_handle(handle)) {
+        log_error("RQT already exists\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (!max_size) {
+        max_size = rqns.size();
+    }
+    if (rqns.empty() || rqns.size() > max_size || max_size > RQT_MAX_SIZE) {
+        log_error("RQT invalid size %zu, max_size %u\n", rqns.size(), max_size);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    max_size = get_rqt_size(max_size);
+    uint32_t size = get_rqt_size(rqns.size());
+
+    size_t inlen = DEVX_ST_SZ_BYTES(create_rqt_in) + DEVX_ST_SZ_BYTES(rq_num) * max_size;
+    std::unique_ptr<uint8_t[]> in_mem_guard(new (std::nothrow) uint8_t[inlen]);
+    void* in = in_mem_guard.get();
+    if (!in) {
+        log_error("RQT in buffer allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(in, 0, inlen);
+
+    DEVX_SET(create_rqt_in, in, opcode, MLX5_CMD_OP_CREATE_RQT);
+    void* rqt_ctx = DEVX_ADDR_OF(create_rqt_in, in, rqt_context);
+    DEVX_SET(rqtc, rqt_ctx, rqt_max_size, max_size);
+    set_rq_nums(rqt_ctx, rqns, size);
+
+    ret = obj::create(in, inlen, out, outlen);
+    if (DPCP_OK == ret) {
+        ret = obj::get_id(m_rqtn);
+        if (DPCP_OK == ret) {
+            m_max_size = max_size;
+            log_trace("RQT rqtn: 0x%x created, size %u max_size %u\n", m_rqtn, size, max_size);
+        }
+    }
+
+    return ret;
+}
+
+status rqt::modify(const std::vector<uint32_t>& rqns)
+{
+    status ret = DPCP_OK;
+    uint32_t out[DEVX_ST_SZ_DW(modify_rqt_out)] = {0};
+    size_t outlen = sizeof(out);
+    uintptr_t handle;
+
+    if (DPCP_OK != get_handle(handle)) {
+        log_error("RQT is invalid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (rqns.empty() || rqns.size() > m_max_size) {
+        log_error("RQT invalid size %zu, max_size %u\n", rqns.size(), m_max_size);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    uint32_t size = get_rqt_size(rqns.size());
+
+    size_t inlen = DEVX_ST_SZ_BYTES(modify_rqt_in) + DEVX_ST_SZ_BYTES(rq_num) * size;
+    std::unique_ptr<uint8_t[]> in_mem_guard(new (std::nothrow) uint8_t[inlen]);
+    void* in = in_mem_guard.get();
+    if (!in) {
+        log_error("RQT in buffer allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(in, 0, inlen);
+
+    DEVX_SET(modify_rqt_in, in, opcode, MLX5_CMD_OP_MODIFY_RQT);
+    DEVX_SET(modify_rqt_in, in, rqtn, m_rqtn);
+    DEVX_SET(modify_rqt_in, in, bitmask.rqn_list, 1);
+    set_rq_nums(DEVX_ADDR_OF(modify_rqt_in, in, ctx), rqns, size);
+
+    ret = obj::modify(in, inlen, out, outlen);
+    if (DPCP_OK == ret) {
+        log_trace("RQT rqtn: 0x%x modified, size %u\n", m_rqtn, size);
+    }
+
+    return ret;
+}
+
+status rqt::query(std::vector<uint32_t>& rqns)
+{
+    status ret = DPCP_OK;
+    uint32_t in[DEVX_ST_SZ_DW(query_rqt_in)] = {0};
+    uintptr_t handle;
+
+    if (DPCP_OK != get_handle(handle)) {
+        log_error("RQT is invalid\n");
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    size_t outlen = DEVX_ST_SZ_BYTES(query_rqt_out) + DEVX_ST_SZ_BYTES(rq_num) * m_max_size;
+    std::unique_ptr<uint8_t[]> out_mem_guard(new (std::nothrow) uint8_t[outlen]);
+    void* out = out_mem_guard.get();
+    if (!out) {
+        log_error("RQT out buffer allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    memset(out, 0, outlen);
+
+    DEVX_SET(query_rqt_in, in, opcode, MLX5_CMD_OP_QUERY_RQT);
+    DEVX_SET(query_rqt_in, in, rqtn, m_rqtn);
+
+    ret = obj::query(in, sizeof(in), out, outlen);
+    if (DPCP_OK != ret) {
+        log_error("RQT query() rqtn=0x%x ret=%d\n", m_rqtn, ret);
+        return ret;
+    }
+
+    void* rqt_ctx = DEVX_ADDR_OF(query_rqt_out, out, rqt_context);
+    uint8_t* rq_num = (uint8_t*)DEVX_ADDR_OF(rqtc, rqt_ctx, rq_num);
+    uint32_t size = DEVX_GET(rqtc, rqt_ctx, rqt_actual_size);
+    rqns.resize(std::min(size, m_max_size));
+    for (size_t i = 0; i < rqns.size(); i++) {
+        rqns[i] = DEVX_GET(rq_num, rq_num + i * DEVX_ST_SZ_BYTES(rq_num), rq_num);
+    }
+
+    return DPCP_OK;
+}
+
+} // namespace dpcp
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+rss_table::rss_table(dcmd::ctx* ctx)
+    : m_rqt(ctx)
+    , m_rqns()
+    , m_map()
+    , m_loads()
+    , m_mask(0)
+{
+}
+
+rss_table::~rss_table()
+{
+}
+
+status rss_table::init(const std::vector<uint32_t>& rqns, uint32_t num_buckets)
+{
+    if (rqns.empty() || num_buckets < rqns.size() || num_buckets > RQT_MAX_SIZE ||
+        (num_buckets & (num_buckets - 1))) {
+        log_error("RSS table invalid number of buckets %u for %zu RQs\n", num_buckets,
+                  rqns.size());
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    m_loads.reset(new (std::nothrow) std::atomic<uint64_t>[num_buckets]);
+    if (!m_loads) {
+        log_error("RSS table loads allocation failed\n");
+        return DPCP_ERR_NO_MEMORY;
+    }
+    m_mask = num_buckets - 1;
+    reset_loads();
+
+    m_rqns = rqns;
+    m_map.resize(num_buckets);
+    std::vector<uint32_t> list(num_buckets);
+    for (uint32_t i = 0; i < num_buckets; i++) {
+        m_map[i] = i % rqns.size();
+        list[i] = rqns[m_map[i]];
+    }
+
+    status ret = m_rqt.create(list, num_buckets);
+    if (DPCP_OK != ret) {
+        log_error("RSS table failed to create RQT, ret %d\n", ret);
+        return ret;
+    }
+
+    log_trace("RSS table rqtn 0x%x created, %u buckets over %zu RQs\n", m_rqt.get_rqtn(),
+              num_buckets, rqns.size());
+    return DPCP_OK;
+}
+
+status rss_table::apply(const std::vector<uint32_t>& map)
+{
+    std::vector<uint32_t> list(map.size());
+    for (size_t i = 0; i < map.size(); i++) {
+        list[i] = m_rqns[map[i]];
+    }
+
+    status ret = m_rqt.modify(list);
+    if (DPCP_OK != ret) {
+        log_error("RSS table failed to modify RQT 0x%x, ret %d\n", m_rqt.get_rqtn(), ret);
+        return ret;
+    }
+    m_map = map;
+
+    return DPCP_OK;
+}
+
+void rss_table::get_rq_loads(std::vector<uint64_t>& loads) const
+{
+    loads.assign(m_rqns.size(), 0);
+    for (uint32_t i = 0; i <= m_mask; i++) {
+        loads[m_map[i]] += get_bucket_load(i);
+    }
+}
+
+void rss_table::reset_loads()
+{
+    for (uint32_t i = 0; i <= m_mask; i++) {
+        m_loads[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+status rss_table::move_buckets(const std::vector<rss_bucket_move>& moves)
+{
+    std::vector<uint32_t> map(m_map);
+
+    for (auto& move : moves) {
+        auto it = std::find(m_rqns.begin(), m_rqns.end(), move.rqn);
+        if (move.bucket > m_mask || it == m_rqns.end()) {
+            log_error("RSS table invalid move of bucket %u to RQ 0x%x\n", move.bucket, move.rqn);
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        map[move.bucket] = static_cast<uint32_t>(it - m_rqns.begin());
+    }
+
+    return apply(map);
+}
+
+status rss_table::rebalance(uint32_t max_moves, uint32_t& moved)
+{
+    std::vector<uint32_t> map(m_map);
+    std::vector<uint64_t> bucket_loads(m_mask + 1);
+    std::vector<uint64_t> rq_loads(m_rqns.size(), 0);
+
+    // Snapshot, loads keep changing while buckets are chosen.
+    for (uint32_t i = 0; i <= m_mask; i++) {
+        bucket_loads[i] = get_bucket_load(i);
+        rq_loads[map[i]] += bucket_loads[i];
+    }
+
+    moved = 0;
+    while (moved < max_moves) {
+        uint32_t hot = static_cast<uint32_t>(
+            std::max_element(rq_loads.begin(), rq_loads.end()) - rq_loads.begin());
+        uint32_t cold = static_cast<uint32_t>(
+            std::min_element(rq_loads.begin(), rq_loads.end()) - rq_loads.begin());
+        uint64_t gap = rq_loads[hot] - rq_loads[cold];
+
+        // Heaviest bucket of the hot RQ which still narrows the gap.
+        uint32_t best = m_mask + 1;
+        for (uint32_t i = 0; i <= m_mask; i++) {
+            if (map[i] == hot && bucket_loads[i] && bucket_loads[i] < gap &&
+                (best > m_mask || bucket_loads[i] > bucket_loads[best])) {
+                best = i;
+            }
+        }
+        if (best > m_mask) {
+            break;
+        }
+
+        map[best] = cold;
+        rq_loads[hot] -= bucket_loads[best];
+        rq_loads[cold] += bucket_loads[best];
+        moved++;
+    }
+
+    if (!moved) {
+        return DPCP_OK;
+    }
+
+    status ret = apply(map);
+    if (DPCP_OK != ret) {
+        moved = 0;
+        return ret;
+    }
+
+    log_trace("RSS table rqtn 0x%x rebalanced, %u buckets moved\n", m_rqt.get_rqtn(), moved);
+    return DPCP_OK;
+}
+
+} // namespace dpcp
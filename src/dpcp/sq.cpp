@@ -135,6 +135,11 @@ status sq::modify_state(sq_state new_state)
     return DPCP_OK;
 }
 
+status sq::modify_state_async(sq_state new_state, cmd_engine& engine, uint64_t cookie)
+{
+    return engine.submit([this, new_state]() { return modify_state(new_state); }, cookie);
+}
+
 status sq::get_cqn(uint32_t& cqn)
 {
     cqn = m_attr.cqn;
@@ -152,6 +157,10 @@ pp_sq::pp_sq(adapter* ad, sq_attr& attr)
     , m_pp(nullptr)
     , m_wqe_num(attr.wqe_num)
     , m_wqe_sz(attr.wqe_sz)
+    , m_wq_buf_map_sz(0)
+    , m_arena(nullptr)
+    , m_wq_buf_umem_offset(0)
+    , m_db_rec_umem_offset(0)
     , m_wq_buf_umem_id(0)
     , m_db_rec_umem_id(0)
     , m_pp_idx(0)
@@ -168,6 +177,14 @@ status pp_sq::destroy()
         delete m_uar;
         m_uar = nullptr;
     }
+    // Return WQ buffer and DB record to the arena owning their UMEM
+    if (m_arena) {
+        m_arena->free(m_wq_buf);
+        m_arena->free(m_db_rec);
+        m_wq_buf = nullptr;
+        m_db_rec = nullptr;
+        m_arena = nullptr;
+    }
     // Deregister UMEM for WQ and DB
     if (m_wq_buf_umem) {
         delete m_wq_buf_umem;
@@ -179,7 +196,7 @@ status pp_sq::destroy()
     }
     // Deallocated WQ buffer and DoorBell record
     if (m_wq_buf) {
-        ::aligned_free((void*)m_wq_buf);
+        free_ring_buf(m_wq_buf, m_wq_buf_map_sz);
         m_wq_buf = nullptr;
     }
     if (m_db_rec) {
@@ -199,12 +216,13 @@ pp_sq::~pp_sq()
 status pp_sq::allocate_wq_buf(void*& wq_buf, size_t sz)
 {
     // Allocate WQ buffer
-    wq_buf = ::aligned_alloc(get_page_size(), sz);
+    wq_buf = alloc_ring_buf(m_adapter->get_ring_alloc_mode(), m_adapter->get_numa_node(), sz,
+                            m_wq_buf_map_sz);
     if (nullptr == wq_buf) {
         return DPCP_ERR_NO_MEMORY;
     }
     memset(wq_buf, 0, sz);
-    log_trace("Allocated SQ Buf %zd -> %p\n", sz, wq_buf);
+    log_trace("Allocated SQ Buf %zd -> %p map: %zd\n", sz, wq_buf, m_wq_buf_map_sz);
     m_wq_buf = wq_buf;
     m_wq_buf_sz_bytes = (uint32_t)sz;
     return DPCP_OK;
@@ -225,6 +243,28 @@ status pp_sq::allocate_db_rec(uint32_t*& db_rec, size_t& sz)
     return DPCP_OK;
 }
 
+status pp_sq::alloc_from_arena(umem_arena* arena)
+{
+    void* db_rec = nullptr;
+    status ret = arena->alloc(m_wq_buf_sz_bytes, get_page_size(), m_wq_buf, m_wq_buf_umem_id,
+                              m_wq_buf_umem_offset);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = arena->alloc(64, get_cacheline_size(), db_rec, m_db_rec_umem_id, m_db_rec_umem_offset);
+    if (DPCP_OK != ret) {
+        arena->free(m_wq_buf);
+        m_wq_buf = nullptr;
+        return ret;
+    }
+    m_db_rec = (uint32_t*)db_rec;
+    m_arena = arena;
+    log_trace("SQ WQ Buf %p umem_id: %x offset: 0x%llx DBRec %p offset: 0x%llx\n", m_wq_buf,
+              m_wq_buf_umem_id, (unsigned long long)m_wq_buf_umem_offset, m_db_rec,
+              (unsigned long long)m_db_rec_umem_offset);
+    return DPCP_OK;
+}
+
 status pp_sq::get_wq_buf(void*& buf_addr)
 {
     if (nullptr == m_wq_buf) {
@@ -269,6 +309,8 @@ status pp_sq::create()
     DEVX_SET(sqc, p_sqc, allow_multi_pkt_send_wqe, 1);
     // Flush in Error
     DEVX_SET(sqc, p_sqc, flush_in_error_en, 1);
+    // UMR WQEs are allowed
+    DEVX_SET(sqc, p_sqc, reg_umr, m_attr.reg_umr ? 1 : 0);
     // Inline mode for SQ - no inline
     DEVX_SET(sqc, p_sqc, min_wqe_inline_mode, 0);
     // SQ in RESET
@@ -308,7 +350,7 @@ status pp_sq::create()
     // UAR PageId number
     DEVX_SET(wq, p_wq, uar_page, (m_uar->m_page_id & 0xFFFFFF));
     // Offset of the DB record address inside DB umem
-    DEVX_SET64(wq, p_wq, dbr_addr, 0x0);
+    DEVX_SET64(wq, p_wq, dbr_addr, m_db_rec_umem_offset);
     // Log of WQ stride size. The size of a WQ stride equals 2^log_wq_stride.
     int32_t log_wq_stride = ilog2((int)m_wqe_sz);
     DEVX_SET(wq, p_wq, log_wq_stride, log_wq_stride);
@@ -328,7 +370,7 @@ status pp_sq::create()
     // WQ buffer umem Id
     DEVX_SET(wq, p_wq, wq_umem_id, m_wq_buf_umem_id);
     // Offset of RQ buffer inside WQ umem
-    DEVX_SET64(wq, p_wq, wq_umem_offset, 0x0);
+    DEVX_SET64(wq, p_wq, wq_umem_offset, m_wq_buf_umem_offset);
 
     // Send mailbox
     DEVX_SET(create_sq_in, in, opcode, MLX5_CMD_OP_CREATE_SQ);
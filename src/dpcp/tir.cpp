@@ -48,6 +48,23 @@ tir::~tir()
 {
 }
 
+static void set_rss(void* tir_ctx, const tir::attr& tir_attr)
+{
+    DEVX_SET(tirc, tir_ctx, disp_type, MLX5_TIRC_DISP_TYPE_INDIRECT);
+    DEVX_SET(tirc, tir_ctx, indirect_table, tir_attr.rss.indirect_table);
+    DEVX_SET(tirc, tir_ctx, rx_hash_fn, tir_attr.rss.hash_fn);
+    DEVX_SET(tirc, tir_ctx, rx_hash_symmetric, tir_attr.rss.symmetric);
+    if (tir_attr.rss.hash_fn == TIR_HASH_FN_TOEPLITZ) {
+        memcpy(DEVX_ADDR_OF(tirc, tir_ctx, rx_hash_toeplitz_key), tir_attr.rss.toeplitz_key,
+               sizeof(tir_attr.rss.toeplitz_key));
+    }
+
+    void* hfso = DEVX_ADDR_OF(tirc, tir_ctx, rx_hash_field_selector_outer);
+    DEVX_SET(rx_hash_field_select, hfso, l3_prot_type, tir_attr.rss.l3_prot_type);
+    DEVX_SET(rx_hash_field_select, hfso, l4_prot_type, tir_attr.rss.l4_prot_type);
+    DEVX_SET(rx_hash_field_select, hfso, selected_fields, tir_attr.rss.selected_fields);
+}
+
 status tir::create(const tir::attr& tir_attr)
 {
     status ret = DPCP_OK;
@@ -80,6 +97,14 @@ status tir::create(const tir::attr& tir_attr)
         DEVX_SET(tirc, tir_ctx, inline_rqn, tir_attr.inline_rqn);
     }
 
+    if (tir_attr.flags & TIR_ATTR_RSS) {
+        if (tir_attr.flags & TIR_ATTR_INLINE_RQN) {
+            log_error("TIR dispatch should be either inline RQN or RSS\n");
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        set_rss(tir_ctx, tir_attr);
+    }
+
     if (tir_attr.flags & TIR_ATTR_TRANSPORT_DOMAIN) {
         DEVX_SET(tirc, tir_ctx, transport_domain, tir_attr.transport_domain);
     }
@@ -108,6 +133,11 @@ status tir::create(const tir::attr& tir_attr)
     return ret;
 }
 
+status tir::create_async(const tir::attr& tir_attr, cmd_engine& engine, uint64_t cookie)
+{
+    return engine.submit([this, tir_attr]() { return create(tir_attr); }, cookie);
+}
+
 status tir::modify(const tir::attr& tir_attr)
 {
     status ret = DPCP_OK;
@@ -133,6 +163,11 @@ status tir::modify(const tir::attr& tir_attr)
         DEVX_SET(tirc, tir_ctx, lro_max_ip_payload_size, tir_attr.lro.max_msg_sz);
     }
 
+    if (tir_attr.flags & TIR_ATTR_RSS) {
+        DEVX_SET(modify_tir_in, in, bitmask.hash, 1);
+        set_rss(tir_ctx, tir_attr);
+    }
+
     ret = obj::modify(in, sizeof(in), out, outlen);
     if (DPCP_OK == ret) {
         log_trace("TIR tirn: 0x%x modified\n", m_tirn);
@@ -140,6 +175,9 @@ status tir::modify(const tir::attr& tir_attr)
         if (tir_attr.flags & TIR_ATTR_LRO) {
             memcpy(&m_attr.lro, &tir_attr.lro, sizeof(m_attr.lro));
         }
+        if (tir_attr.flags & TIR_ATTR_RSS) {
+            memcpy(&m_attr.rss, &tir_attr.rss, sizeof(m_attr.rss));
+        }
     }
 
     return ret;
@@ -195,6 +233,19 @@ status tir::query(tir::attr& tir_attr)
     m_attr.nvmeotcp.tag_buffer_table_id = DEVX_GET(tirc, tir_ctx, nvmeotcp_tag_buffer_table_id);
     m_attr.flags |= TIR_ATTR_NVMEOTCP_CRC;
     m_attr.nvmeotcp.crc_en = DEVX_GET(tirc, tir_ctx, nvmeotcp_crc_en);
+    if (DEVX_GET(tirc, tir_ctx, disp_type) == MLX5_TIRC_DISP_TYPE_INDIRECT) {
+        void* hfso = DEVX_ADDR_OF(tirc, tir_ctx, rx_hash_field_selector_outer);
+        m_attr.flags |= TIR_ATTR_RSS;
+        m_attr.flags &= ~TIR_ATTR_INLINE_RQN;
+        m_attr.rss.indirect_table = DEVX_GET(tirc, tir_ctx, indirect_table);
+        m_attr.rss.hash_fn = DEVX_GET(tirc, tir_ctx, rx_hash_fn);
+        m_attr.rss.symmetric = DEVX_GET(tirc, tir_ctx, rx_hash_symmetric);
+        m_attr.rss.l3_prot_type = DEVX_GET(rx_hash_field_select, hfso, l3_prot_type);
+        m_attr.rss.l4_prot_type = DEVX_GET(rx_hash_field_select, hfso, l4_prot_type);
+        m_attr.rss.selected_fields = DEVX_GET(rx_hash_field_select, hfso, selected_fields);
+        memcpy(m_attr.rss.toeplitz_key, DEVX_ADDR_OF(tirc, tir_ctx, rx_hash_toeplitz_key),
+               sizeof(m_attr.rss.toeplitz_key));
+    }
 
 out:
     memcpy(&tir_attr, &m_attr, sizeof(m_attr));
@@ -208,6 +259,9 @@ status tir::query(tir::attr& tir_attr)
     log_trace("          zerocopy_en=0x%x\n", m_attr.nvmeotcp.zerocopy_en);
     log_trace("          tag_buffer_table_id=0x%x\n", m_attr.nvmeotcp.tag_buffer_table_id);
     log_trace("          crc_en=0x%x\n", m_attr.nvmeotcp.crc_en);
+    log_trace("          rss.indirect_table=0x%x\n", m_attr.rss.indirect_table);
+    log_trace("          rss.hash_fn=0x%x\n", m_attr.rss.hash_fn);
+    log_trace("          rss.selected_fields=0x%x\n", m_attr.rss.selected_fields);
 
     return DPCP_OK;
 }
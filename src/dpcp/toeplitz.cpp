@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define DPCP_TOEPLITZ_CLMUL
+#endif
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+static inline uint32_t load_be32(const uint8_t* p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t bit_reverse64(uint64_t v)
+{
+    v = ((v >> 1) & 0x5555555555555555ULL) | ((v & 0x5555555555555555ULL) << 1);
+    v = ((v >> 2) & 0x3333333333333333ULL) | ((v & 0x3333333333333333ULL) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((v & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
+    return (v >> 32) | (v << 32);
+}
+
+// 32 key bits starting at bit @a bit, key must be padded by 4 zero bytes.
+static inline uint32_t key_window(const uint8_t* key, size_t bit)
+{
+    uint64_t v = ((uint64_t)load_be32(key + bit / 8) << 32) | load_be32(key + bit / 8 + 4);
+    return (uint32_t)(v >> (32 - bit % 8));
+}
+
+#ifdef DPCP_TOEPLITZ_CLMUL
+static bool cpu_has_clmul()
+{
+    unsigned int eax, ebx, ecx, edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_PCLMUL);
+}
+
+/*
+ * Each input dword D is multiplied by the bit reversed 64 bit key window K
+ * starting at the same bit. Bit 31 + r of D * K is the result bit r counted
+ * from MSB, so bits 31..62 hold the dword contribution in reversed order.
+ */
+__attribute__((target("pclmul"))) static uint32_t hash_clmul(const uint64_t* keys,
+                                                              const uint8_t* data, size_t len)
+{
+    __m128i acc = _mm_setzero_si128();
+    uint8_t tail[4] = {0};
+
+    for (size_t i = 0; i < len; i += 4, keys++) {
+        const uint8_t* p = data + i;
+        if (len - i < 4) {
+            memcpy(tail, p, len - i);
+            p = tail;
+        }
+        __m128i d = _mm_cvtsi32_si128((int)load_be32(p));
+        __m128i k = _mm_cvtsi64_si128((long long)*keys);
+        acc = _mm_xor_si128(acc, _mm_clmulepi64_si128(d, k, 0x00));
+    }
+
+    uint64_t v = (uint64_t)_mm_cvtsi128_si64(acc);
+    return (uint32_t)(bit_reverse64(v >> 31) >> 32);
+}
+#endif
+
+toeplitz_hash::toeplitz_hash()
+    : m_lut()
+    , m_clmul_keys()
+    , m_max_len(0)
+    , m_clmul(false)
+{
+}
+
+status toeplitz_hash::init(const uint8_t* key, size_t key_len)
+{
+    if (!key || key_len <= sizeof(uint32_t) || key_len > TIR_TOEPLITZ_KEY_SIZE) {
+        log_error("Toeplitz invalid key length %zu\n", key_len);
+        return DPCP_ERR_INVALID_PARAM;
+    }
+
+    uint8_t padded[TIR_TOEPLITZ_KEY_SIZE + 8] = {0};
+    memcpy(padded, key, key_len);
+    m_max_len = key_len - sizeof(uint32_t);
+
+    m_lut.assign(m_max_len * 256, 0);
+    for (size_t i = 0; i < m_max_len; i++) {
+        uint32_t* lut = &m_lut[i * 256];
+        uint32_t windows[8];
+        for (int b = 0; b < 8; b++) {
+            windows[b] = key_window(padded, i * 8 + b);
+        }
+        for (uint32_t v = 1; v < 256; v++) {
+            int b = 0;
+            while (!(v & (0x80 >> b))) {
+                b++;
+            }
+            lut[v] = lut[v & ~(0x80U >> b)] ^ windows[b];
+        }
+    }
+
+    m_clmul_keys.resize((m_max_len + 3) / 4);
+    for (size_t i = 0; i < m_clmul_keys.size(); i++) {
+        uint64_t v = ((uint64_t)load_be32(padded + i * 4) << 32) | load_be32(padded + i * 4 + 4);
+        m_clmul_keys[i] = bit_reverse64(v);
+    }
+#ifdef DPCP_TOEPLITZ_CLMUL
+    m_clmul = cpu_has_clmul();
+#endif
+
+    log_trace("Toeplitz key length %zu, clmul %d\n", key_len, m_clmul);
+    return DPCP_OK;
+}
+
+uint32_t toeplitz_hash::hash_lut(const uint8_t* data, size_t len) const
+{
+    uint32_t res = 0;
+
+    len = std::min(len, m_max_len);
+    for (size_t i = 0; i < len; i++) {
+        res ^= m_lut[i * 256 + data[i]];
+    }
+
+    return res;
+}
+
+uint32_t toeplitz_hash::hash(const uint8_t* data, size_t len) const
+{
+#ifdef DPCP_TOEPLITZ_CLMUL
+    if (m_clmul) {
+        return hash_clmul(m_clmul_keys.data(), data, std::min(len, m_max_len));
+    }
+#endif
+    return hash_lut(data, len);
+}
+
+uint32_t toeplitz_hash::hash_ipv4(uint32_t src_ip, uint32_t dst_ip, uint16_t sport,
+                                  uint16_t dport, uint32_t fields) const
+{
+    uint8_t tuple[12];
+    size_t len = 0;
+
+    if (fields & TIR_HASH_FIELD_SRC_IP) {
+        memcpy(tuple + len, &src_ip, sizeof(src_ip));
+        len += sizeof(src_ip);
+    }
+    if (fields & TIR_HASH_FIELD_DST_IP) {
+        memcpy(tuple + len, &dst_ip, sizeof(dst_ip));
+        len += sizeof(dst_ip);
+    }
+    if (fields & TIR_HASH_FIELD_L4_SPORT) {
+        memcpy(tuple + len, &sport, sizeof(sport));
+        len += sizeof(sport);
+    }
+    if (fields & TIR_HASH_FIELD_L4_DPORT) {
+        memcpy(tuple + len, &dport, sizeof(dport));
+        len += sizeof(dport);
+    }
+
+    return hash(tuple, len);
+}
+
+uint32_t toeplitz_hash::hash_ipv6(const uint8_t* src_ip, const uint8_t* dst_ip, uint16_t sport,
+                                  uint16_t dport, uint32_t fields) const
+{
+    uint8_t tuple[36];
+    size_t len = 0;
+
+    if (fields & TIR_HASH_FIELD_SRC_IP) {
+        memcpy(tuple + len, src_ip, 16);
+        len += 16;
+    }
+    if (fields & TIR_HASH_FIELD_DST_IP) {
+        memcpy(tuple + len, dst_ip, 16);
+        len += 16;
+    }
+    if (fields & TIR_HASH_FIELD_L4_SPORT) {
+        memcpy(tuple + len, &sport, sizeof(sport));
+        len += sizeof(sport);
+    }
+    if (fields & TIR_HASH_FIELD_L4_DPORT) {
+        memcpy(tuple + len, &dport, sizeof(dport));
+        len += sizeof(dport);
+    }
+
+    return hash(tuple, len);
+}
+
+uint32_t toeplitz_hash::hash_generic(const uint8_t* key, size_t key_len, const uint8_t* data,
+                                     size_t len)
+{
+    uint32_t res = 0;
+    uint32_t window = load_be32(key);
+
+    len = std::min(len, key_len - sizeof(uint32_t));
+    for (size_t i = 0; i < len; i++) {
+        for (int b = 7; b >= 0; b--) {
+            if (data[i] & (1 << b)) {
+                res ^= window;
+            }
+            window = (window << 1) | ((key[i + 4] >> b) & 1);
+        }
+    }
+
+    return res;
+}
+
+void toeplitz_hash::make_symmetric_key(uint8_t* key, size_t key_len, uint16_t pattern)
+{
+    for (size_t i = 0; i < key_len; i++) {
+        key[i] = (uint8_t)(i % 2 ? pattern : pattern >> 8);
+    }
+}
+
+} // namespace dpcp
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <iterator>
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+umem_arena::umem_arena(dcmd::ctx* ctx, size_t chunk_sz, ring_alloc_mode mode, int numa_node)
+    : m_mutex()
+    , m_ctx(ctx)
+    , m_chunk_sz(chunk_sz)
+    , m_mode(mode)
+    , m_numa_node(numa_node)
+    , m_chunks()
+    , m_used()
+{
+}
+
+umem_arena::~umem_arena()
+{
+    for (auto ch : m_chunks) {
+        delete ch->umem;
+        free_ring_buf(ch->buf, ch->map_sz);
+        delete ch;
+    }
+    m_chunks.clear();
+    m_used.clear();
+}
+
+status umem_arena::init()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    chunk* ch = nullptr;
+
+    if (0 == m_chunk_sz) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    if (!m_chunks.empty()) {
+        return DPCP_OK;
+    }
+    return add_chunk(m_chunk_sz, ch);
+}
+
+status umem_arena::add_chunk(size_t sz, chunk*& ch)
+{
+    size_t map_sz = 0;
+    void* buf = alloc_ring_buf(m_mode, m_numa_node, sz, map_sz);
+    if (nullptr == buf) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    // Whole mapping is usable
+    if (map_sz) {
+        sz = map_sz;
+    }
+    ch = new (std::nothrow) chunk();
+    if (nullptr == ch) {
+        free_ring_buf(buf, map_sz);
+        return DPCP_ERR_NO_MEMORY;
+    }
+    status ret = reg_mem(m_ctx, buf, sz, ch->umem, ch->umem_id);
+    if (DPCP_OK != ret) {
+        free_ring_buf(buf, map_sz);
+        delete ch;
+        ch = nullptr;
+        return ret;
+    }
+    ch->buf = (uint8_t*)buf;
+    ch->sz = sz;
+    ch->map_sz = map_sz;
+    ch->free_list[0] = sz;
+    m_chunks.push_back(ch);
+    log_trace("umem_arena: chunk %p sz: 0x%zx umem_id: %x\n", buf, sz, ch->umem_id);
+    return DPCP_OK;
+}
+
+bool umem_arena::carve(chunk* ch, size_t sz, size_t align, size_t& offset)
+{
+    for (auto it = ch->free_list.begin(); it != ch->free_list.end(); ++it) {
+        size_t start = it->first;
+        size_t end = it->first + it->second;
+        size_t aligned = (start + align - 1) & ~(align - 1);
+
+        if (aligned + sz > end) {
+            continue;
+        }
+        ch->free_list.erase(it);
+        if (aligned > start) {
+            ch->free_list[start] = aligned - start;
+        }
+        if (aligned + sz < end) {
+            ch->free_list[aligned + sz] = end - aligned - sz;
+        }
+        offset = aligned;
+        return true;
+    }
+    return false;
+}
+
+status umem_arena::alloc(size_t sz, size_t align, void*& buf, uint32_t& umem_id,
+                         uint64_t& offset)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    chunk* ch = nullptr;
+    size_t off = 0;
+
+    if (0 == sz || 0 == align || (align & (align - 1))) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    for (auto c : m_chunks) {
+        if (carve(c, sz, align, off)) {
+            ch = c;
+            break;
+        }
+    }
+    if (nullptr == ch) {
+        // Oversized blocks get a dedicated chunk
+        status ret = add_chunk(std::max(sz, m_chunk_sz), ch);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        carve(ch, sz, align, off);
+    }
+    buf = ch->buf + off;
+    umem_id = ch->umem_id;
+    offset = off;
+    memset(buf, 0, sz);
+    m_used[(uintptr_t)buf] = {ch, off, sz};
+    return DPCP_OK;
+}
+
+status umem_arena::free(void* buf)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto used = m_used.find((uintptr_t)buf);
+    if (m_used.end() == used) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    std::map<size_t, size_t>& free_list = used->second.ch->free_list;
+    size_t offset = used->second.offset;
+    size_t sz = used->second.sz;
+    m_used.erase(used);
+
+    // Merge with the following and the preceding free blocks
+    auto next = free_list.lower_bound(offset);
+    if (free_list.end() != next && offset + sz == next->first) {
+        sz += next->second;
+        next = free_list.erase(next);
+    }
+    if (free_list.begin() != next) {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset) {
+            prev->second += sz;
+            return DPCP_OK;
+        }
+    }
+    free_list[offset] = sz;
+    return DPCP_OK;
+}
+
+} // namespace dpcp
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2020-2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "utils/os.h"
+#include "dpcp/internal.h"
+
+namespace dpcp {
+
+// UMR Control Segment
+struct umr_ctrl_seg {
+    uint8_t flags;
+    uint8_t rsvd0[3];
+    uint16_t klm_octowords;
+    uint16_t translation_offset;
+    uint64_t mkey_mask;
+    uint8_t rsvd1[32];
+};
+
+// UMR Memory Key Context Segment
+struct umr_mkey_ctx_seg {
+    uint8_t free;
+    uint8_t rsvd0;
+    uint8_t access_flags;
+    uint8_t sf;
+    uint32_t qpn_mkey;
+    uint32_t rsvd1;
+    uint32_t flags_pd;
+    uint64_t start_addr;
+    uint64_t len;
+    uint32_t bsf_octword_size;
+    uint32_t rsvd2[4];
+    uint32_t translations_octword_size;
+    uint8_t rsvd3[3];
+    uint8_t log_page_size;
+    uint32_t rsvd4;
+};
+
+enum {
+    UMR_CTRL_INLINE = 1 << 7, // Translation entries follow Memory Key Context
+    UMR_MKEY_MASK_LEN = 1 << 0,
+    UMR_MKEY_MASK_START_ADDR = 1 << 6,
+    // Control, UMR Control and Memory Key Context segments
+    UMR_HDR_DS_NUM = (sizeof(wqe_ctrl_seg) + sizeof(umr_ctrl_seg) + sizeof(umr_mkey_ctx_seg)) /
+        WQE_DS_SZ,
+};
+
+umr_queue::umr_queue(adapter* ad)
+    : m_adapter(ad)
+    , m_cq(nullptr)
+    , m_tis(nullptr)
+    , m_sq(nullptr)
+    , m_sp()
+    , m_cp()
+    , m_cookies()
+    , m_wqebbs()
+    , m_sqn(0)
+    , m_sq_ci(0)
+{
+}
+
+umr_queue::~umr_queue()
+{
+    delete m_sq;
+    delete m_tis;
+    delete m_cq;
+}
+
+status umr_queue::init(uint32_t depth)
+{
+    uint32_t max_wqebb_num =
+        (UMR_HDR_DS_NUM + klm_mkey::UMR_MAX_ENTRIES + (SEND_WQE_BB / WQE_DS_SZ) - 1) /
+        (SEND_WQE_BB / WQE_DS_SZ);
+    if (depth < max_wqebb_num || (depth & (depth - 1))) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    uint32_t eqn = 0;
+    status ret = m_adapter->query_eqn(eqn);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    // Every UMR WQE is signaled, so there are no more CQEs than WQEBBs
+    cq_attr cqattr = {};
+    cqattr.cq_sz = depth;
+    cqattr.eq_num = eqn;
+    cqattr.flags.set(ATTR_CQ_NONE_FLAG);
+    cqattr.cq_attr_use.set(CQ_SIZE);
+    cqattr.cq_attr_use.set(CQ_EQ_NUM);
+    ret = m_adapter->create_cq(cqattr, m_cq);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    tis::attr tis_attr;
+    memset(&tis_attr, 0, sizeof(tis_attr));
+    tis_attr.flags = TIS_ATTR_TRANSPORT_DOMAIN;
+    tis_attr.transport_domain = m_adapter->get_td();
+    ret = m_adapter->create_tis(tis_attr, m_tis);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    // No rate limit
+    qos_attributes qos_attr;
+    memset(&qos_attr, 0, sizeof(qos_attr));
+    qos_attr.qos_type = QOS_TYPE::QOS_PACKET_PACING;
+    sq_attr sqattr = {};
+    sqattr.qos_attrs = &qos_attr;
+    sqattr.qos_attrs_sz = 1;
+    sqattr.wqe_num = depth;
+    sqattr.wqe_sz = SEND_WQE_BB;
+    sqattr.reg_umr = true;
+    ret = m_cq->get_id(sqattr.cqn);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = m_tis->get_tisn(sqattr.tis_num);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = m_adapter->create_pp_sq(sqattr, m_sq);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = m_sq->modify_state(SQ_RDY);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = m_sq->get_id(m_sqn);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = m_sp.init(*m_sq);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    ret = m_cp.init(*m_cq);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    m_cookies.resize(depth);
+    m_wqebbs.resize(depth);
+    log_trace("umr_queue sqn 0x%x depth %u\n", m_sqn, depth);
+    return DPCP_OK;
+}
+
+status umr_queue::rebind(klm_mkey& mk, void* address, size_t entries_num,
+                         const klm_mkey_entry entries[], uint64_t cookie)
+{
+    if (0 == (mk.m_flags & MKEY_UMR_ENABLED) || 0 == entries_num ||
+        entries_num > klm_mkey::UMR_MAX_ENTRIES || nullptr == entries) {
+        return DPCP_ERR_INVALID_PARAM;
+    }
+    size_t length = 0;
+    for (size_t i = 0; i < entries_num; i++) {
+        if (nullptr == entries[i].m_key || 0 == entries[i].m_length ||
+            entries[i].m_length > UINT32_MAX) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        // KSM entity size is fixed by mkey creation
+        if (mk.is_ksm() && entries[i].m_length != (size_t)1 << mk.m_log_entity_sz) {
+            return DPCP_ERR_INVALID_PARAM;
+        }
+        length += entries[i].m_length;
+    }
+    uint32_t klm_num = align((uint32_t)entries_num, 4);
+    uint32_t ds = UMR_HDR_DS_NUM + klm_num;
+    uint32_t wqebb_num = (ds + (SEND_WQE_BB / WQE_DS_SZ) - 1) / (SEND_WQE_BB / WQE_DS_SZ);
+    if (get_outstanding() + wqebb_num > m_sp.get_wqebb_num()) {
+        return DPCP_ERR_NO_MEMORY;
+    }
+    uint32_t mkey_id = 0;
+    status ret = mk.get_id(mkey_id);
+    if (DPCP_OK != ret) {
+        return ret;
+    }
+    uint32_t key_id = 0;
+    std::vector<uint32_t> key_ids(entries_num);
+    for (size_t i = 0; i < entries_num; i++) {
+        ret = entries[i].m_key->get_id(key_id);
+        if (DPCP_OK != ret) {
+            return ret;
+        }
+        key_ids[i] = key_id;
+    }
+
+    uint32_t pi = m_sp.get_pi();
+    wqe_ctrl_seg* cseg = (wqe_ctrl_seg*)m_sp.get_wqe();
+    set_wqe_ctrl_seg(cseg, pi, WQE_OPCODE_UMR, m_sqn, ds, true);
+    // Memory Key to modify
+    cseg->imm = swap_be32(mkey_id);
+
+    umr_ctrl_seg* uctrl = (umr_ctrl_seg*)m_sp.get_ds(sizeof(wqe_ctrl_seg) / WQE_DS_SZ);
+    memset(uctrl, 0, sizeof(*uctrl));
+    uctrl->flags = UMR_CTRL_INLINE;
+    uctrl->klm_octowords = swap_be16((uint16_t)klm_num);
+    uctrl->mkey_mask = swap_be64(UMR_MKEY_MASK_LEN | UMR_MKEY_MASK_START_ADDR);
+
+    // Memory Key Context starts the second WQEBB which may wrap
+    umr_mkey_ctx_seg* mctx = (umr_mkey_ctx_seg*)m_sp.get_wqe(1);
+    memset(mctx, 0, sizeof(*mctx));
+    uint64_t addr = (mk.m_flags & MKEY_ZERO_BASED) ? 0 : (uint64_t)address;
+    mctx->start_addr = swap_be64(addr);
+    mctx->len = swap_be64((uint64_t)length);
+
+    for (uint32_t i = 0; i < klm_num; i++) {
+        klm_seg* klm = (klm_seg*)m_sp.get_ds(UMR_HDR_DS_NUM + i);
+        if (i >= entries_num) {
+            memset(klm, 0, sizeof(*klm));
+            continue;
+        }
+        klm->byte_count = mk.is_ksm() ? 0 : swap_be32((uint32_t)entries[i].m_length);
+        klm->mkey = swap_be32(key_ids[i]);
+        klm->address = swap_be64((uint64_t)entries[i].m_address);
+    }
+    m_cookies[pi & (m_sp.get_wqebb_num() - 1)] = cookie;
+    m_wqebbs[pi & (m_sp.get_wqebb_num() - 1)] = wqebb_num;
+    m_sp.post(wqebb_num);
+    m_sp.flush();
+
+    // Keep mkey description in line with the posted translation
+    mk.m_entries.assign(entries, entries + entries_num);
+    mk.m_mkeys.clear();
+    for (size_t i = 0; i < entries_num; i++) {
+        mk.m_mkeys.push_back(entries[i].m_key);
+    }
+    mk.m_length = length;
+    if (0 == (mk.m_flags & MKEY_ZERO_BASED)) {
+        mk.m_address = address;
+    }
+    log_trace("umr_queue rebind mkey 0x%x entries %zd len %zd pi %u\n", mkey_id, entries_num,
+              length, pi);
+    return DPCP_OK;
+}
+
+status umr_queue::poll(uint64_t* cookies, uint32_t& num)
+{
+    uint32_t max_num = num;
+    status ret = DPCP_OK;
+    cqe64* cqe = nullptr;
+
+    num = 0;
+    while (num < max_num && (cqe = m_cp.peek())) {
+        uint8_t opcode = cqe->op_own >> 4;
+        uint16_t wqe_counter = swap_be16(cqe->wqe_counter);
+        uint32_t idx = wqe_counter & (m_sp.get_wqebb_num() - 1);
+
+        cookies[num++] = m_cookies[idx];
+        // WQEs complete in order, the CQE reports the first WQEBB of the WQE
+        m_sq_ci += (uint16_t)(wqe_counter - (uint16_t)m_sq_ci) + m_wqebbs[idx];
+        m_cp.consume();
+        if (CQE_OPCODE_REQ_ERR == opcode || CQE_OPCODE_RESP_ERR == opcode) {
+            cq_completion comp;
+            cq_poller::decode(*cqe, comp);
+            log_error("umr_queue: UMR WQE %u failed syndrome 0x%x vendor syndrome 0x%x\n",
+                      wqe_counter, comp.syndrome, comp.vendor_syndrome);
+            ret = DPCP_ERR_MODIFY;
+            break;
+        }
+    }
+    if (num) {
+        m_cp.update_dbrec();
+    }
+    return ret;
+}
+
+} // namespace dpcp
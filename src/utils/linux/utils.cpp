@@ -28,11 +28,15 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cerrno>
 #include <cstdint>
 #include <fstream>
-#include "utils.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "utils/os.h"
 
 static const int DPCP_DEFAULT_CACHELINE_SIZE = 64;
+static const int DPCP_MPOL_PREFERRED = 1;
 static const char* DPCP_LINUX_CACHE_SIZE_PATH =
     "/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size";
 
@@ -46,3 +50,37 @@ size_t get_cacheline_size()
     is >> result;
     return result;
 }
+
+void* page_alloc(size_t& sz, size_t page_sz, int numa_node)
+{
+    size_t len = (sz + page_sz - 1) & ~(page_sz - 1);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    if (page_sz > get_page_size()) {
+        flags |= MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= __builtin_ctzll(page_sz) << MAP_HUGE_SHIFT;
+#endif
+    }
+    void* addr = mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (MAP_FAILED == addr) {
+        return nullptr;
+    }
+    if (numa_node >= 0 && numa_node < (int)(sizeof(unsigned long) * 8)) {
+        // Pages are not populated yet, so they are allocated on the node at first touch.
+        // Preferred policy falls back to other nodes when the node is out of memory.
+        // Kernel reads maxnode - 1 bits of the mask, one more is passed to cover the last node.
+        unsigned long nodemask = 1UL << numa_node;
+        if (syscall(SYS_mbind, addr, len, DPCP_MPOL_PREFERRED, &nodemask,
+                    sizeof(nodemask) * 8 + 1, 0)) {
+            log_trace("mbind to NUMA node %d failed errno=%d\n", numa_node, errno);
+        }
+    }
+    sz = len;
+    return addr;
+}
+
+void page_free(void* addr, size_t sz)
+{
+    munmap(addr, sz);
+}
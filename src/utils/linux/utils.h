@@ -42,4 +42,15 @@ inline size_t get_page_size()
 
 size_t get_cacheline_size();
 
+/**
+ * @brief Maps anonymous memory backed by regular or huge pages
+ * @param [in,out] sz        Requested size, rounded up to page size
+ * @param [in] page_sz       Page size, huge pages are used if it exceeds get_page_size()
+ * @param [in] numa_node     Preferred NUMA node, -1 for no preference
+ *
+ * @retval Returns mapped address or nullptr if pages are not available.
+ */
+void* page_alloc(size_t& sz, size_t page_sz, int numa_node);
+void page_free(void* addr, size_t sz);
+
 #endif /* SRC_UTILS_LINUX_UTILS_H_ */
@@ -57,3 +57,29 @@ size_t get_cacheline_size()
     free(buffer);
     return result;
 }
+
+void* page_alloc(size_t& sz, size_t page_sz, int numa_node)
+{
+    DWORD type = MEM_RESERVE | MEM_COMMIT;
+
+    if (page_sz != get_page_size()) {
+        if (page_sz != GetLargePageMinimum()) {
+            return nullptr;
+        }
+        type |= MEM_LARGE_PAGES;
+    }
+    size_t len = (sz + page_sz - 1) & ~(page_sz - 1);
+    void* addr = VirtualAllocExNuma(GetCurrentProcess(), nullptr, len, type, PAGE_READWRITE,
+                                    numa_node >= 0 ? (DWORD)numa_node : NUMA_NO_PREFERRED_NODE);
+    if (nullptr == addr) {
+        return nullptr;
+    }
+    sz = len;
+    return addr;
+}
+
+void page_free(void* addr, size_t sz)
+{
+    NOT_IN_USE(sz);
+    VirtualFree(addr, 0, MEM_RELEASE);
+}
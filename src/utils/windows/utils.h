@@ -78,4 +78,15 @@ inline size_t get_page_size()
 
 size_t get_cacheline_size();
 
+/**
+ * @brief Allocates memory backed by regular or large pages
+ * @param [in,out] sz        Requested size, rounded up to page size
+ * @param [in] page_sz       Page size, only system page and large page sizes are supported
+ * @param [in] numa_node     Preferred NUMA node, -1 for no preference
+ *
+ * @retval Returns allocated address or nullptr if pages are not available.
+ */
+void* page_alloc(size_t& sz, size_t page_sz, int numa_node);
+void page_free(void* addr, size_t sz);
+
 #endif /* SRC_UTILS_WINDOWS_UTILS_H_ */
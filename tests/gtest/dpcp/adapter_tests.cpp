@@ -1140,6 +1140,145 @@ TEST_F(dpcp_adapter, ti_25_create_extern_mkey)
     delete ad;
 }
 
+/**
+ * @test dpcp_adapter.ti_26_create_cq_hugepage
+ * @brief
+ *    Check CQ creation with huge pages ring allocation mode
+ * @details
+ *    Regular pages are used when huge pages are not reserved
+ */
+TEST_F(dpcp_adapter, ti_26_create_cq_hugepage)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    ASSERT_EQ(RING_ALLOC_DEFAULT, ad->get_ring_alloc_mode());
+    ad->set_ring_alloc_mode(RING_ALLOC_HUGEPAGE_2M);
+    ASSERT_EQ(RING_ALLOC_HUGEPAGE_2M, ad->get_ring_alloc_mode());
+
+    uint32_t eqn = 0;
+    ret = ad->query_eqn(eqn);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::bitset<ATTR_CQ_MAX_CNT_FLAG> flags;
+    flags.set(ATTR_CQ_NONE_FLAG);
+    std::bitset<CQ_ATTR_MAX_CNT> cq_attr_use;
+    cq_attr_use.set(CQ_SIZE);
+    cq_attr_use.set(CQ_EQ_NUM);
+    cq_attr attr = {65536, eqn, {0, 0}};
+    attr.flags = flags;
+    attr.cq_attr_use = cq_attr_use;
+    cq* pcq = nullptr;
+    ret = ad->create_cq(attr, pcq);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, pcq);
+
+    void* cq_buf = nullptr;
+    ret = pcq->get_cq_buf(cq_buf);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, cq_buf);
+
+    delete pcq;
+    delete ad;
+}
+
+/**
+ * @test dpcp_adapter.ti_27_numa_placement
+ * @brief
+ *    Check CQ creation on NUMA node and EQ selection by CPU
+ * @details
+ */
+TEST_F(dpcp_adapter, ti_27_numa_placement)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    ASSERT_EQ(-1, ad->get_numa_node());
+    ASSERT_GE(ad->get_device_numa_node(), -1);
+    ad->set_numa_node(0);
+    ASSERT_EQ(0, ad->get_numa_node());
+
+    uint32_t eqn = 0;
+    ret = ad->query_eqn_by_cpu(eqn, 0);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::bitset<ATTR_CQ_MAX_CNT_FLAG> flags;
+    flags.set(ATTR_CQ_NONE_FLAG);
+    std::bitset<CQ_ATTR_MAX_CNT> cq_attr_use;
+    cq_attr_use.set(CQ_SIZE);
+    cq_attr_use.set(CQ_EQ_NUM);
+    cq_attr attr = {4096, eqn, {0, 0}};
+    attr.flags = flags;
+    attr.cq_attr_use = cq_attr_use;
+    cq* pcq = nullptr;
+    ret = ad->create_cq(attr, pcq);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, pcq);
+
+    delete pcq;
+    delete ad;
+}
+
+/**
+ * @test dpcp_adapter.ti_28_umem_arena
+ * @brief
+ *    Check CQs creation with shared UMEM arena
+ * @details
+ *    CQ buffers and DoorBell records of both CQs share UMEM
+ */
+TEST_F(dpcp_adapter, ti_28_umem_arena)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    ASSERT_FALSE(ad->is_umem_arena_enabled());
+    ret = ad->enable_umem_arena();
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_TRUE(ad->is_umem_arena_enabled());
+
+    uint32_t eqn = 0;
+    ret = ad->query_eqn(eqn);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    std::bitset<ATTR_CQ_MAX_CNT_FLAG> flags;
+    flags.set(ATTR_CQ_NONE_FLAG);
+    std::bitset<CQ_ATTR_MAX_CNT> cq_attr_use;
+    cq_attr_use.set(CQ_SIZE);
+    cq_attr_use.set(CQ_EQ_NUM);
+    cq_attr attr = {1024, eqn, {0, 0}};
+    attr.flags = flags;
+    attr.cq_attr_use = cq_attr_use;
+    cq* pcq1 = nullptr;
+    ret = ad->create_cq(attr, pcq1);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, pcq1);
+    cq* pcq2 = nullptr;
+    ret = ad->create_cq(attr, pcq2);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, pcq2);
+
+    void* cq_buf1 = nullptr;
+    void* cq_buf2 = nullptr;
+    ret = pcq1->get_cq_buf(cq_buf1);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = pcq2->get_cq_buf(cq_buf2);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(cq_buf1, cq_buf2);
+
+    delete pcq1;
+    delete pcq2;
+    delete ad;
+}
+
 /**
 * @test dpcp_adapter.DISABLED_perf_100k_dek_modify
 * @brief
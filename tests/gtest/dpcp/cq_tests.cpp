@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2023 NVIDIA CORPORATION & AFFILIATES. All rights reserved.
+ * BSD-3-Clause
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "common/def.h"
+#include "common/log.h"
+#include "common/sys.h"
+#include "common/base.h"
+
+#include "dpcp_base.h"
+
+using namespace dpcp;
+
+static const uint32_t s_cqe_num = 16;
+
+class dpcp_cq : public dpcp_base {
+protected:
+    cqe64 m_cqes[s_cqe_num];
+    uint32_t m_dbrec;
+
+    void SetUp() override
+    {
+        dpcp_base::SetUp();
+        memset(m_cqes, 0, sizeof(m_cqes));
+        // Same pattern as cq::init(), first round ownership bit is 1
+        for (uint32_t i = 0; i < s_cqe_num; i++) {
+            m_cqes[i].op_own = 0xf1;
+        }
+        m_dbrec = 0;
+    }
+
+    // Emulates HW writing CQE number ci
+    void hw_write_cqe(uint32_t ci, uint8_t opcode, uint32_t byte_cnt)
+    {
+        cqe64& cqe = m_cqes[ci & (s_cqe_num - 1)];
+        cqe.byte_cnt = swap_be32(byte_cnt);
+        cqe.wqe_counter = swap_be16((uint16_t)ci);
+        cqe.sop_drop_qpn = swap_be32(0xab000000 | ci);
+        cqe.op_own = (uint8_t)((opcode << 4) | ((ci / s_cqe_num) & CQE_OWNER_MASK));
+    }
+};
+
+/**
+ * @test dpcp_cq.ti_01_poller_init
+ * @brief
+ *    Check cq_poller::init parameters validation
+ * @details
+ */
+TEST_F(dpcp_cq, ti_01_poller_init)
+{
+    cq_poller poller;
+
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, poller.init(nullptr, &m_dbrec, s_cqe_num));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, poller.init(m_cqes, nullptr, s_cqe_num));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, poller.init(m_cqes, &m_dbrec, 12));
+    ASSERT_EQ(DPCP_OK, poller.init(m_cqes, &m_dbrec, s_cqe_num));
+    ASSERT_EQ(nullptr, poller.peek());
+}
+
+/**
+ * @test dpcp_cq.ti_02_poll_burst
+ * @brief
+ *    Check cq_poller::poll decodes CQEs and updates DoorBell record once
+ * @details
+ */
+TEST_F(dpcp_cq, ti_02_poll_burst)
+{
+    cq_poller poller;
+    cq_completion comps[s_cqe_num];
+
+    ASSERT_EQ(DPCP_OK, poller.init(m_cqes, &m_dbrec, s_cqe_num));
+    ASSERT_EQ(0U, poller.poll(comps, s_cqe_num));
+    ASSERT_EQ(0U, m_dbrec);
+
+    for (uint32_t i = 0; i < 3; i++) {
+        hw_write_cqe(i, CQE_OPCODE_RESP_SEND, 100 + i);
+    }
+    ASSERT_EQ(2U, poller.poll(comps, 2));
+    ASSERT_EQ(2U, swap_be32(m_dbrec));
+    ASSERT_EQ(1U, poller.poll(comps, s_cqe_num));
+    ASSERT_EQ(3U, swap_be32(m_dbrec));
+    ASSERT_EQ(CQE_OPCODE_RESP_SEND, comps[0].opcode);
+    ASSERT_EQ(102U, comps[0].byte_cnt);
+    ASSERT_EQ(2U, comps[0].wqe_counter);
+    ASSERT_EQ(2U, comps[0].flow_tag);
+}
+
+/**
+ * @test dpcp_cq.ti_03_poll_wrap
+ * @brief
+ *    Check cq_poller handles ownership bit flip on ring wrap around
+ * @details
+ */
+TEST_F(dpcp_cq, ti_03_poll_wrap)
+{
+    cq_poller poller;
+    cq_completion comps[s_cqe_num];
+    uint32_t ci = 0;
+
+    ASSERT_EQ(DPCP_OK, poller.init(m_cqes, &m_dbrec, s_cqe_num));
+    for (int round = 0; round < 3; round++) {
+        for (uint32_t i = 0; i < s_cqe_num - 2; i++, ci++) {
+            hw_write_cqe(ci, CQE_OPCODE_REQ, ci);
+        }
+        ASSERT_EQ(s_cqe_num - 2, poller.poll(comps, s_cqe_num));
+        ASSERT_EQ(ci - 1, comps[s_cqe_num - 3].byte_cnt);
+        // Stale CQEs of the previous round must not be polled again
+        ASSERT_EQ(0U, poller.poll(comps, s_cqe_num));
+        ASSERT_EQ(ci, poller.get_ci());
+    }
+
+    hw_write_cqe(ci, CQE_OPCODE_REQ_ERR, 0);
+    ((uint8_t*)&m_cqes[ci & (s_cqe_num - 1)])[55] = 0x5;
+    ASSERT_EQ(1U, poller.poll(comps, s_cqe_num));
+    ASSERT_EQ(CQE_OPCODE_REQ_ERR, comps[0].opcode);
+    ASSERT_EQ(0x5, comps[0].syndrome);
+}
+
+/**
+ * @test dpcp_cq.ti_04_poll_compressed
+ * @brief
+ *    Check cq_poller expands compressed CQE session in place
+ * @details
+ */
+TEST_F(dpcp_cq, ti_04_poll_compressed)
+{
+    cq_poller poller;
+    cq_completion comps[s_cqe_num];
+    const uint32_t session_ci = 2;
+    const uint32_t session_cnt = 10;
+
+    ASSERT_EQ(DPCP_OK, poller.init(m_cqes, &m_dbrec, s_cqe_num, CQ_MINI_CQE_FORMAT_HASH));
+    hw_write_cqe(0, CQE_OPCODE_RESP_SEND, 64);
+    hw_write_cqe(1, CQE_OPCODE_RESP_SEND, 64);
+    ASSERT_EQ(2U, poller.poll(comps, s_cqe_num));
+
+    // Mini CQE arrays follow the title and then take each 8th slot
+    mini_cqe8* arr0 = (mini_cqe8*)&m_cqes[session_ci + 1];
+    mini_cqe8* arr1 = (mini_cqe8*)&m_cqes[session_ci + MINI_CQE_ARRAY_SIZE];
+    for (uint32_t i = 0; i < session_cnt; i++) {
+        mini_cqe8& mini = (i < MINI_CQE_ARRAY_SIZE) ? arr0[i] : arr1[i - MINI_CQE_ARRAY_SIZE];
+        mini.byte_cnt = swap_be32(1000 + i);
+        mini.rx_hash_result = swap_be32(0xbeef0000 | i);
+    }
+    hw_write_cqe(session_ci, CQE_OPCODE_RESP_SEND, session_cnt);
+    m_cqes[session_ci].wqe_counter = swap_be16(100);
+    m_cqes[session_ci].op_own |= CQE_FORMAT_COMPRESSED;
+
+    ASSERT_EQ(session_cnt, poller.poll(comps, s_cqe_num));
+    for (uint32_t i = 0; i < session_cnt; i++) {
+        ASSERT_EQ(CQE_OPCODE_RESP_SEND, comps[i].opcode);
+        ASSERT_EQ(1000 + i, comps[i].byte_cnt);
+        ASSERT_EQ(0xbeef0000 | i, comps[i].rss_hash);
+        ASSERT_EQ(100 + i, comps[i].wqe_counter);
+        ASSERT_EQ(2U, comps[i].flow_tag);
+    }
+    ASSERT_EQ(session_ci + session_cnt, swap_be32(m_dbrec));
+    ASSERT_EQ(0U, poller.poll(comps, s_cqe_num));
+}
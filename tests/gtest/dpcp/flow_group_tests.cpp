@@ -428,3 +428,99 @@ TEST_F(dpcp_flow_group, ti_06_create_flow_group_with_meta_register_c_0)
 
     delete adapter_obj;
 }
+
+class flow_rule_ex_sw : public flow_rule_ex {
+public:
+    flow_rule_ex_sw(const flow_rule_attr_ex& attr, std::shared_ptr<const flow_matcher> matcher)
+        : flow_rule_ex(nullptr, attr, std::weak_ptr<const flow_table>(),
+                       std::weak_ptr<const flow_group>(), matcher)
+    {
+    }
+    status create() override
+    {
+        return DPCP_OK;
+    }
+    status modify(const std::vector<std::shared_ptr<flow_action>>&) override
+    {
+        return DPCP_OK;
+    }
+};
+
+/**
+ * @test dpcp_flow_group.ti_07_flow_rule_registry
+ * @brief
+ *    Check lookup, duplicate detection and removal of rules by match value
+ * @details
+ *    Rules are keyed only by fields of the match criteria, and by priority
+ *    in registry of kernel group.
+ */
+TEST_F(dpcp_flow_group, ti_07_flow_rule_registry)
+{
+    const uint16_t num_rules = 1000;
+
+    flow_matcher_attr matcher_attr;
+    matcher_attr.match_criteria_enabled = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    matcher_attr.match_criteria.match_lyr3.dst_ip = 0xFFFFFF00;
+    matcher_attr.match_criteria.match_lyr4.type = match_params_lyr_4_type::UDP;
+    matcher_attr.match_criteria.match_lyr4.dst_port = 0xFFFF;
+    std::shared_ptr<flow_matcher> matcher = std::make_shared<flow_matcher>(matcher_attr);
+
+    flow_rule_registry registry(matcher, false);
+    ASSERT_EQ(DPCP_OK, registry.init(matcher_attr.match_criteria));
+
+    std::vector<std::shared_ptr<flow_rule_ex>> rules;
+    flow_rule_attr_ex fr_attr;
+    fr_attr.match_value.match_lyr3.dst_ip = 0x0a000001;
+    fr_attr.match_value.match_lyr4.type = match_params_lyr_4_type::UDP;
+    for (uint16_t i = 0; i < num_rules; i++) {
+        fr_attr.match_value.match_lyr4.dst_port = i;
+        rules.emplace_back(new flow_rule_ex_sw(fr_attr, matcher));
+        ASSERT_EQ(DPCP_OK, registry.insert(rules.back()));
+    }
+    ASSERT_EQ(num_rules, registry.size());
+
+    // Fields out of the criteria and priority do not make a rule unique.
+    fr_attr.match_value.match_lyr3.dst_ip = 0x0a0000ff;
+    fr_attr.match_value.match_lyr3.src_ip = 0x0b000001;
+    fr_attr.match_value.match_lyr4.dst_port = 7;
+    fr_attr.priority = 1;
+    std::shared_ptr<flow_rule_ex> dup(new flow_rule_ex_sw(fr_attr, matcher));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, registry.insert(dup));
+    ASSERT_EQ(rules[7], registry.find(fr_attr.match_value, 0));
+    ASSERT_EQ(rules[7], registry.find(fr_attr.match_value, 1));
+    ASSERT_FALSE(registry.contains(dup));
+
+    // Registry of kernel group keeps the same match value at different priorities.
+    flow_rule_registry registry_prio(matcher, true);
+    ASSERT_EQ(DPCP_OK, registry_prio.init(matcher_attr.match_criteria));
+    ASSERT_EQ(DPCP_OK, registry_prio.insert(rules[7]));
+    ASSERT_EQ(DPCP_OK, registry_prio.insert(dup));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, registry_prio.insert(dup));
+    ASSERT_EQ(rules[7], registry_prio.find(fr_attr.match_value, 0));
+    ASSERT_EQ(dup, registry_prio.find(fr_attr.match_value, 1));
+    ASSERT_EQ(nullptr, registry_prio.find(fr_attr.match_value, 2));
+    ASSERT_TRUE(registry_prio.erase(dup));
+    ASSERT_EQ(nullptr, registry_prio.find(fr_attr.match_value, 1));
+    ASSERT_TRUE(registry_prio.contains(rules[7]));
+    fr_attr.priority = 0;
+
+    // Remove every other rule, the rest is still found.
+    for (uint16_t i = 0; i < num_rules; i += 2) {
+        ASSERT_TRUE(registry.erase(rules[i]));
+        ASSERT_FALSE(registry.erase(rules[i]));
+    }
+    ASSERT_EQ(num_rules / 2, registry.size());
+    for (uint16_t i = 0; i < num_rules; i++) {
+        fr_attr.match_value.match_lyr4.dst_port = i;
+        std::shared_ptr<flow_rule_ex> found = registry.find(fr_attr.match_value, 0);
+        if (i % 2) {
+            ASSERT_EQ(rules[i], found);
+        } else {
+            ASSERT_EQ(nullptr, found);
+        }
+    }
+
+    // Removed match value can be added again.
+    ASSERT_EQ(DPCP_OK, registry.insert(rules[0]));
+    ASSERT_TRUE(registry.contains(rules[0]));
+}
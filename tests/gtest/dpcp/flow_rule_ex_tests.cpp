@@ -972,3 +972,540 @@ TEST_F(dpcp_flow_rule_ex, ti_06_add_flow_rule_modify_set_modify_copy_fwd_table_r
 
     delete adapter_obj;
 }
+
+/**
+ * @test dpcp_flow_rule_ex.ti_07_add_flow_rules
+ * @brief
+ *    Check flow_group::add_flow_rules
+ * @details
+ *    Batch of rules is created in HW, batch with flow index
+ *    outside of the group fails and leaves no rules.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_07_add_flow_rules)
+{
+    status ret = DPCP_OK;
+    const size_t num_rules = 64;
+
+    // Get adapter.
+    std::unique_ptr<adapter> adapter_obj(OpenAdapter());
+    ASSERT_NE(nullptr, adapter_obj);
+
+    // Set flow table attributes.
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = 10;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    adapter_obj->create_flow_table(ft_attr, ft_obj);
+    ret = ft_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Set flow group attributes.
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = num_rules - 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+    fg_attr.match_criteria.match_lyr3.ip_protocol = 0xFF;
+    fg_attr.match_criteria.match_lyr4.type = match_params_lyr_4_type::UDP;
+    fg_attr.match_criteria.match_lyr4.dst_port = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ret = ft_obj->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Set forward flow table.
+    flow_table_attr ft_attr_fwd = ft_attr;
+    ft_attr_fwd.level = 2;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    adapter_obj->create_flow_table(ft_attr_fwd, ft_fwd_obj);
+    ret = ft_fwd_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    std::shared_ptr<flow_action> fa_fwd(action_gen.create_fwd(dests));
+
+    std::vector<flow_rule_attr_ex> fr_attrs(num_rules);
+    for (size_t i = 0; i < num_rules; i++) {
+        fr_attrs[i].flow_index = i;
+        fr_attrs[i].match_value.match_lyr2.ethertype = 0x800;
+        fr_attrs[i].match_value.match_lyr3.ip_protocol = 0x11;
+        fr_attrs[i].match_value.match_lyr4.type = match_params_lyr_4_type::UDP;
+        fr_attrs[i].match_value.match_lyr4.dst_port = 0xc350 + i;
+        fr_attrs[i].actions.push_back(fa_fwd);
+    }
+
+    std::vector<std::weak_ptr<flow_rule_ex>> fr_objs;
+    ret = fg_obj.lock()->add_flow_rules(fr_attrs.data(), num_rules, fr_objs);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(num_rules, fr_objs.size());
+    for (size_t i = 0; i < num_rules; i++) {
+        match_params_ex match_val;
+        ASSERT_EQ(DPCP_OK, fr_objs[i].lock()->get_match_value(match_val));
+        ASSERT_EQ(fr_attrs[i].match_value.match_lyr4.dst_port, match_val.match_lyr4.dst_port);
+        ret = fg_obj.lock()->remove_flow_rule(fr_objs[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+
+    // Last rule is out of group range.
+    fr_attrs[num_rules - 1].flow_index = num_rules;
+    ret = fg_obj.lock()->add_flow_rules(fr_attrs.data(), num_rules, fr_objs);
+    ASSERT_NE(DPCP_OK, ret);
+    ASSERT_TRUE(fr_objs.empty());
+
+    // Group has no rules left, the whole batch can be placed again.
+    fr_attrs[num_rules - 1].flow_index = num_rules - 1;
+    ret = fg_obj.lock()->add_flow_rules(fr_attrs.data(), num_rules, fr_objs);
+    ASSERT_EQ(DPCP_OK, ret);
+}
+
+#if defined(__linux__)
+/**
+ * @test dpcp_flow_rule_ex.ti_08_kernel_rules_share_matcher
+ * @brief
+ *    Check kernel flow rules of the group share matcher
+ * @details
+ *    Rules with the same priority use one kernel matcher, which is
+ *    released with the last rule.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_08_kernel_rules_share_matcher)
+{
+    status ret = DPCP_OK;
+    const size_t num_rules = 16;
+
+    // Get adapter.
+    std::unique_ptr<adapter> adapter_obj(OpenAdapter());
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> root_table(adapter_obj->get_root_table(flow_table_type::FT_RX));
+    ASSERT_NE(root_table.get(), nullptr);
+
+    // Set flow group attributes.
+    flow_group_attr fg_attr;
+    fg_attr.end_flow_index = 1000;
+    fg_attr.start_flow_index = 0;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+    fg_attr.match_criteria.match_lyr3.ip_protocol = 0xFF;
+    fg_attr.match_criteria.match_lyr4.type = match_params_lyr_4_type::UDP;
+    fg_attr.match_criteria.match_lyr4.dst_port = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ret = root_table->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Set forward flow table.
+    flow_table_attr ft_attr_fwd;
+    ft_attr_fwd.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr_fwd.flags = 0;
+    ft_attr_fwd.level = 100;
+    ft_attr_fwd.log_size = 10;
+    ft_attr_fwd.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr_fwd.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    adapter_obj->create_flow_table(ft_attr_fwd, ft_fwd_obj);
+    ret = ft_fwd_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    std::shared_ptr<flow_action> fa_fwd(action_gen.create_fwd(dests));
+
+    std::vector<std::weak_ptr<flow_rule_ex>> fr_objs;
+    for (size_t i = 0; i < num_rules; i++) {
+        flow_rule_attr_ex fr_attr;
+        fr_attr.priority = 3;
+        fr_attr.match_value.match_lyr2.ethertype = 0x800;
+        fr_attr.match_value.match_lyr3.ip_protocol = 0x11;
+        fr_attr.match_value.match_lyr4.type = match_params_lyr_4_type::UDP;
+        fr_attr.match_value.match_lyr4.dst_port = 0xc350 + i;
+        fr_attr.actions.push_back(fa_fwd);
+
+        std::weak_ptr<flow_rule_ex> fr_obj;
+        ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_obj);
+        ASSERT_EQ(DPCP_OK, ret);
+        ret = fr_obj.lock()->create();
+        ASSERT_EQ(DPCP_OK, ret);
+        fr_objs.push_back(fr_obj);
+    }
+
+    // All rules and this reference hold the same matcher.
+    std::shared_ptr<const flow_group_kernel> group =
+        std::dynamic_pointer_cast<const flow_group_kernel>(fg_obj.lock());
+    ASSERT_NE(nullptr, group);
+    std::shared_ptr<dcmd::flow_matcher> matcher;
+    ret = group->get_dcmd_matcher(adapter_obj->get_ctx(), 3, matcher);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(static_cast<long>(num_rules + 1), matcher.use_count());
+
+    std::weak_ptr<dcmd::flow_matcher> weak_matcher = matcher;
+    matcher.reset();
+    for (auto& fr_obj : fr_objs) {
+        ret = fg_obj.lock()->remove_flow_rule(fr_obj);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    ASSERT_TRUE(weak_matcher.expired());
+}
+#endif
+
+/**
+ * @test dpcp_flow_rule_ex.ti_09_modify_flow_rule
+ * @brief
+ *    Check flow_rule_ex::modify
+ * @details
+ *    Destination and flow tag of created rule are replaced in place.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_09_modify_flow_rule)
+{
+    status ret = DPCP_OK;
+
+    // Get adapter.
+    std::unique_ptr<adapter> adapter_obj(OpenAdapter());
+    ASSERT_NE(nullptr, adapter_obj);
+
+    // Set flow table attributes.
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.flags = 0;
+    ft_attr.level = 1;
+    ft_attr.log_size = 10;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    adapter_obj->create_flow_table(ft_attr, ft_obj);
+    ret = ft_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Set flow group attributes.
+    flow_group_attr fg_attr;
+    fg_attr.start_flow_index = 0;
+    fg_attr.end_flow_index = 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ret = ft_obj->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Set two forward flow tables.
+    flow_table_attr ft_attr_fwd = ft_attr;
+    ft_attr_fwd.level = 2;
+    std::shared_ptr<flow_table> ft_fwd_obj1;
+    adapter_obj->create_flow_table(ft_attr_fwd, ft_fwd_obj1);
+    ret = ft_fwd_obj1->create();
+    ASSERT_EQ(DPCP_OK, ret);
+    std::shared_ptr<flow_table> ft_fwd_obj2;
+    adapter_obj->create_flow_table(ft_attr_fwd, ft_fwd_obj2);
+    ret = ft_fwd_obj2->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests1(1, ft_fwd_obj1.get());
+    std::vector<forwardable_obj*> dests2(1, ft_fwd_obj2.get());
+    std::shared_ptr<flow_action> fa_fwd1(action_gen.create_fwd(dests1));
+    std::shared_ptr<flow_action> fa_fwd2(action_gen.create_fwd(dests2));
+    std::shared_ptr<flow_action> fa_tag(action_gen.create_tag(0x1234));
+
+    flow_rule_attr_ex fr_attr;
+    fr_attr.flow_index = 0;
+    fr_attr.match_value.match_lyr2.ethertype = 0x800;
+    fr_attr.actions.push_back(fa_fwd1);
+
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Rule is not created yet.
+    ret = fr_obj.lock()->modify(fr_attr.actions);
+    ASSERT_EQ(DPCP_ERR_NOT_APPLIED, ret);
+
+    ret = fr_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Same actions, nothing to modify.
+    ret = fr_obj.lock()->modify(fr_attr.actions);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Replace destination.
+    std::vector<std::shared_ptr<flow_action>> actions(1, fa_fwd2);
+    ret = fr_obj.lock()->modify(actions);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Add flow tag.
+    actions.push_back(fa_tag);
+    ret = fr_obj.lock()->modify(actions);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Forward action is mandatory.
+    actions.erase(actions.begin());
+    ret = fr_obj.lock()->modify(actions);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_10_shared_flow_actions
+ * @brief
+ *    Check identical modify and reformat actions share one object
+ * @details
+ */
+TEST_F(dpcp_flow_rule_ex, ti_10_shared_flow_actions)
+{
+    std::unique_ptr<adapter> adapter_obj(OpenAdapter());
+    ASSERT_NE(nullptr, adapter_obj);
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+
+    // Same header from different buffers.
+    uint8_t hdr1[28] = {0};
+    uint8_t hdr2[28] = {0};
+    flow_action_reformat_attr insert_hdr_attr {};
+    insert_hdr_attr.insert.type = flow_action_reformat_type::INSERT_HDR;
+    insert_hdr_attr.insert.start_hdr = dpcp::flow_action_reformat_anchor::MAC_START;
+    insert_hdr_attr.insert.offset = 22;
+    insert_hdr_attr.insert.data_len = sizeof(hdr1);
+    insert_hdr_attr.insert.data = hdr1;
+    std::shared_ptr<flow_action> fa_insert1(action_gen.create_reformat(insert_hdr_attr));
+    ASSERT_NE(nullptr, fa_insert1);
+    insert_hdr_attr.insert.data = hdr2;
+    std::shared_ptr<flow_action> fa_insert2(action_gen.create_reformat(insert_hdr_attr));
+    ASSERT_EQ(fa_insert1, fa_insert2);
+    hdr2[0] = 1;
+    std::shared_ptr<flow_action> fa_insert3(action_gen.create_reformat(insert_hdr_attr));
+    ASSERT_NE(fa_insert1, fa_insert3);
+
+    flow_action_modify_type_attr set_attr {};
+    set_attr.set.type = flow_action_modify_type::SET;
+    set_attr.set.data = 0x800;
+    set_attr.set.field = flow_action_modify_field::OUT_ETHERTYPE;
+    set_attr.set.length = 0x10;
+    set_attr.set.offset = 0;
+    flow_action_modify_attr modify_hdr_attr;
+    modify_hdr_attr.table_type = flow_table_type::FT_RX;
+    modify_hdr_attr.actions.push_back(set_attr);
+    std::shared_ptr<flow_action> fa_modify1(action_gen.create_modify(modify_hdr_attr));
+    std::shared_ptr<flow_action> fa_modify2(action_gen.create_modify(modify_hdr_attr));
+    ASSERT_NE(nullptr, fa_modify1);
+    ASSERT_EQ(fa_modify1, fa_modify2);
+
+    // Released action is not reused.
+    std::weak_ptr<flow_action> weak_modify = fa_modify1;
+    fa_modify1.reset();
+    fa_modify2.reset();
+    ASSERT_TRUE(weak_modify.expired());
+    fa_modify1 = action_gen.create_modify(modify_hdr_attr);
+    ASSERT_NE(nullptr, fa_modify1);
+}
+
+/**
+ * @test dpcp_flow_rule_ex.ti_11_flow_counters
+ * @brief
+ *    Check flow action counter from counter bulk
+ * @details
+ *    Counters of the bulk are attached to rules and read in one query.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_11_flow_counters)
+{
+    status ret = DPCP_OK;
+
+    std::unique_ptr<adapter> adapter_obj(OpenAdapter());
+    ASSERT_NE(nullptr, adapter_obj);
+
+    flow_counter_bulk* bulk = nullptr;
+    ret = adapter_obj->create_flow_counter_bulk(100, bulk);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+    ret = adapter_obj->create_flow_counter_bulk(128, bulk);
+    ASSERT_EQ(DPCP_OK, ret);
+    std::unique_ptr<flow_counter_bulk> bulk_guard(bulk);
+    ASSERT_EQ(128U, bulk->get_size());
+
+    flow_table_attr ft_attr;
+    ft_attr.level = 1;
+    ft_attr.log_size = 4;
+    ft_attr.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_obj;
+    adapter_obj->create_flow_table(ft_attr, ft_obj);
+    ret = ft_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+    flow_table_attr ft_attr_fwd = ft_attr;
+    ft_attr_fwd.level = 2;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    adapter_obj->create_flow_table(ft_attr_fwd, ft_fwd_obj);
+    ret = ft_fwd_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_group_attr fg_attr;
+    fg_attr.num_flows = 2;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+    std::weak_ptr<flow_group> fg_obj;
+    ret = ft_obj->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    ASSERT_EQ(nullptr, action_gen.create_counter(*bulk, 128));
+    std::weak_ptr<flow_rule_ex> fr_objs[2];
+    uint32_t indexes[2];
+    for (uint32_t i = 0; i < 2; i++) {
+        ret = bulk->alloc_counter(indexes[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+        flow_rule_attr_ex fr_attr;
+        fr_attr.flow_index = FLOW_INDEX_AUTO;
+        fr_attr.match_value.match_lyr2.ethertype = 0x800 + i;
+        fr_attr.actions.push_back(action_gen.create_fwd({ft_fwd_obj.get()}));
+        fr_attr.actions.push_back(action_gen.create_counter(*bulk, indexes[i]));
+        ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_objs[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+        ret = fr_objs[i].lock()->create();
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    ASSERT_NE(indexes[0], indexes[1]);
+
+    // Counter is replaced in place.
+    uint32_t index = 0;
+    ret = bulk->alloc_counter(index);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fr_objs[1].lock()->modify(
+        {action_gen.create_fwd({ft_fwd_obj.get()}), action_gen.create_counter(*bulk, index)});
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = bulk->release_counter(indexes[1]);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = bulk->release_counter(indexes[1]);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    std::vector<flow_counter_stats> stats(bulk->get_size());
+    ret = bulk->query(0, bulk->get_size(), stats.data());
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(0U, stats[indexes[0]].packets);
+    ret = bulk->query(1, bulk->get_size(), stats.data());
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+    // Unaligned range is read, but not cleared.
+    ret = bulk->query(1, 2, stats.data());
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(0U, stats[0].packets);
+    ret = bulk->query(1, 4, stats.data(), true);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    // Snapshot is filled by the first refresh.
+    ret = bulk->get_stats(0, 1, stats.data());
+    ASSERT_EQ(DPCP_ERR_NOT_APPLIED, ret);
+    ret = bulk->start_refresh(std::chrono::milliseconds(10));
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = bulk->get_stats(0, bulk->get_size(), stats.data());
+    for (int i = 0; i < 100 && ret != DPCP_OK; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        ret = bulk->get_stats(0, bulk->get_size(), stats.data());
+    }
+    ASSERT_EQ(DPCP_OK, ret);
+    bulk->stop_refresh();
+}
+
+#if defined(__linux__)
+/**
+ * @test dpcp_flow_rule_ex.ti_12_kernel_rules_same_match
+ * @brief
+ *    Check kernel flow rules with the same match value
+ * @details
+ *    Rules of the group differing only by priority are all added, created and
+ *    found by priority, rule with the same match value and priority is refused.
+ */
+TEST_F(dpcp_flow_rule_ex, ti_12_kernel_rules_same_match)
+{
+    status ret = DPCP_OK;
+    const uint16_t priorities[] = {2, 3};
+
+    // Get adapter.
+    std::unique_ptr<adapter> adapter_obj(OpenAdapter());
+    ASSERT_NE(nullptr, adapter_obj);
+
+    std::shared_ptr<flow_table> root_table(adapter_obj->get_root_table(flow_table_type::FT_RX));
+    ASSERT_NE(root_table.get(), nullptr);
+
+    // Set flow group attributes.
+    flow_group_attr fg_attr;
+    fg_attr.end_flow_index = 1000;
+    fg_attr.start_flow_index = 0;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+    fg_attr.match_criteria.match_lyr3.ip_protocol = 0xFF;
+    fg_attr.match_criteria.match_lyr4.type = match_params_lyr_4_type::UDP;
+    fg_attr.match_criteria.match_lyr4.dst_port = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_obj;
+    ret = root_table->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Set forward flow table.
+    flow_table_attr ft_attr_fwd;
+    ft_attr_fwd.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr_fwd.flags = 0;
+    ft_attr_fwd.level = 100;
+    ft_attr_fwd.log_size = 10;
+    ft_attr_fwd.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr_fwd.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_fwd_obj;
+    adapter_obj->create_flow_table(ft_attr_fwd, ft_fwd_obj);
+    ret = ft_fwd_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& action_gen = adapter_obj->get_flow_action_generator();
+    std::vector<forwardable_obj*> dests;
+    dests.push_back(ft_fwd_obj.get());
+    std::shared_ptr<flow_action> fa_fwd(action_gen.create_fwd(dests));
+
+    flow_rule_attr_ex fr_attr;
+    fr_attr.match_value.match_lyr2.ethertype = 0x800;
+    fr_attr.match_value.match_lyr3.ip_protocol = 0x11;
+    fr_attr.match_value.match_lyr4.type = match_params_lyr_4_type::UDP;
+    fr_attr.match_value.match_lyr4.dst_port = 0xc350;
+    fr_attr.actions.push_back(fa_fwd);
+
+    std::vector<std::weak_ptr<flow_rule_ex>> fr_objs;
+    for (uint16_t priority : priorities) {
+        fr_attr.priority = priority;
+        std::weak_ptr<flow_rule_ex> fr_obj;
+        ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_obj);
+        ASSERT_EQ(DPCP_OK, ret);
+        ret = fr_obj.lock()->create();
+        ASSERT_EQ(DPCP_OK, ret);
+        fr_objs.push_back(fr_obj);
+    }
+    std::weak_ptr<flow_rule_ex> fr_dup;
+    ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_dup);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    for (size_t i = 0; i < fr_objs.size(); i++) {
+        std::weak_ptr<flow_rule_ex> found;
+        ret = fg_obj.lock()->find_flow_rule(fr_attr.match_value, found, priorities[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+        ASSERT_EQ(fr_objs[i].lock(), found.lock());
+    }
+
+    uint32_t used = 0;
+    uint32_t size = 0;
+    ret = fg_obj.lock()->get_occupancy(used, size);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(2U, used);
+
+    for (auto& fr_obj : fr_objs) {
+        ret = fg_obj.lock()->remove_flow_rule(fr_obj);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+}
+#endif
@@ -29,6 +29,7 @@
  */
 
 #include <memory>
+#include <poll.h>
 
 #include "common/def.h"
 #include "common/log.h"
@@ -359,3 +360,289 @@ TEST_F(dpcp_flow_table, ti_08_miss_action_fwd02)
     delete adapter_obj;
 }
 
+
+/**
+ * @test dpcp_flow_table.ti_09_index_allocator
+ * @brief
+ *    Check flow index allocation inside a group range
+ * @details
+ */
+TEST_F(dpcp_flow_table, ti_09_index_allocator)
+{
+    index_allocator indexes(100, 4);
+    uint32_t index = 0;
+
+    ASSERT_TRUE(indexes.reserve(101));
+    ASSERT_FALSE(indexes.reserve(101));
+    ASSERT_FALSE(indexes.reserve(99));
+    ASSERT_FALSE(indexes.reserve(104));
+
+    ASSERT_TRUE(indexes.alloc(index));
+    ASSERT_EQ(100U, index);
+    ASSERT_TRUE(indexes.alloc(index));
+    ASSERT_EQ(102U, index);
+    ASSERT_TRUE(indexes.alloc(index));
+    ASSERT_EQ(103U, index);
+    ASSERT_FALSE(indexes.alloc(index));
+    ASSERT_EQ(4U, indexes.get_used());
+
+    // Released index is handed out again.
+    ASSERT_TRUE(indexes.release(102));
+    ASSERT_FALSE(indexes.release(102));
+    ASSERT_EQ(3U, indexes.get_used());
+    ASSERT_TRUE(indexes.alloc(index));
+    ASSERT_EQ(102U, index);
+
+    // Released index reserved explicitly is not handed out twice.
+    ASSERT_TRUE(indexes.release(100));
+    ASSERT_TRUE(indexes.reserve(100));
+    ASSERT_FALSE(indexes.alloc(index));
+    ASSERT_EQ(indexes.get_size(), indexes.get_used());
+
+    // Index released many times is queued once.
+    for (int i = 0; i < 8; i++) {
+        ASSERT_TRUE(indexes.release(101));
+        ASSERT_TRUE(indexes.reserve(101));
+    }
+    ASSERT_TRUE(indexes.release(101));
+    ASSERT_TRUE(indexes.alloc(index));
+    ASSERT_EQ(101U, index);
+    ASSERT_FALSE(indexes.alloc(index));
+}
+
+/**
+ * @test dpcp_flow_table.ti_10_range_allocator
+ * @brief
+ *    Check flow group placement inside a table
+ * @details
+ */
+TEST_F(dpcp_flow_table, ti_10_range_allocator)
+{
+    range_allocator ranges(16);
+    uint32_t start = 0;
+
+    ASSERT_TRUE(ranges.reserve(4, 4));
+    ASSERT_FALSE(ranges.reserve(6, 4));
+    ASSERT_FALSE(ranges.reserve(14, 4));
+
+    // First fit.
+    ASSERT_TRUE(ranges.alloc(4, start));
+    ASSERT_EQ(0U, start);
+    ASSERT_TRUE(ranges.alloc(6, start));
+    ASSERT_EQ(8U, start);
+    ASSERT_FALSE(ranges.alloc(4, start));
+    ASSERT_EQ(14U, ranges.get_used());
+
+    // Released neighbours are merged.
+    ranges.release(0, 4);
+    ranges.release(4, 4);
+    ASSERT_EQ(6U, ranges.get_used());
+    ASSERT_TRUE(ranges.alloc(8, start));
+    ASSERT_EQ(0U, start);
+    ASSERT_EQ(14U, ranges.get_used());
+    ASSERT_EQ(16U, ranges.get_size());
+}
+
+/**
+ * @test dpcp_flow_table.ti_11_auto_placement
+ * @brief
+ *    Check groups and rules placed by flow table and flow group
+ * @details
+ */
+TEST_F(dpcp_flow_table, ti_11_auto_placement)
+{
+    status ret = DPCP_OK;
+
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    flow_table_attr ft_attr;
+    ft_attr.def_miss_action = flow_table_miss_action::FT_MISS_ACTION_DEF;
+    ft_attr.level = 1;
+    ft_attr.log_size = 4;
+    ft_attr.op_mod = flow_table_op_mod::FT_OP_MOD_NORMAL;
+    ft_attr.type = flow_table_type::FT_RX;
+
+    std::shared_ptr<flow_table> ft_obj;
+    ret = adapter_obj->create_flow_table(ft_attr, ft_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = ft_obj->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_group_attr fg_attr;
+    fg_attr.num_flows = 2;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+
+    std::weak_ptr<flow_group> fg_objs[2];
+    uint32_t start = 0;
+    uint32_t end = 0;
+    for (uint32_t i = 0; i < 2; i++) {
+        ret = ft_obj->add_flow_group(fg_attr, fg_objs[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+        ret = fg_objs[i].lock()->create();
+        ASSERT_EQ(DPCP_OK, ret);
+        ret = fg_objs[i].lock()->get_flow_index_range(start, end);
+        ASSERT_EQ(DPCP_OK, ret);
+        ASSERT_EQ(i * 2, start);
+        ASSERT_EQ(i * 2 + 1, end);
+    }
+
+    // Explicit range overlapping a placed group is refused.
+    flow_group_attr fg_attr_fixed = fg_attr;
+    fg_attr_fixed.num_flows = 0;
+    fg_attr_fixed.start_flow_index = 3;
+    fg_attr_fixed.end_flow_index = 4;
+    std::weak_ptr<flow_group> fg_fixed;
+    ret = ft_obj->add_flow_group(fg_attr_fixed, fg_fixed);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    uint32_t used = 0;
+    uint32_t size = 0;
+    ret = ft_obj->get_occupancy(used, size);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(4U, used);
+    ASSERT_EQ(16U, size);
+
+    // Rules of the second group take free indexes of the group.
+    flow_rule_attr_ex fr_attr;
+    fr_attr.flow_index = FLOW_INDEX_AUTO;
+    std::weak_ptr<flow_rule_ex> fr_objs[3];
+    for (uint32_t i = 0; i < 2; i++) {
+        fr_attr.match_value.match_lyr2.ethertype = 0x800 + i;
+        ret = fg_objs[1].lock()->add_flow_rule(fr_attr, fr_objs[i]);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    fr_attr.match_value.match_lyr2.ethertype = 0x802;
+    ret = fg_objs[1].lock()->add_flow_rule(fr_attr, fr_objs[2]);
+    ASSERT_EQ(DPCP_ERR_OUT_OF_RANGE, ret);
+    ret = fg_objs[1].lock()->get_occupancy(used, size);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(2U, used);
+    ASSERT_EQ(2U, size);
+
+    ret = fg_objs[1].lock()->remove_flow_rule(fr_objs[0]);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_objs[1].lock()->add_flow_rule(fr_attr, fr_objs[2]);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Removed group frees its range.
+    ret = ft_obj->remove_flow_group(fg_objs[0]);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = ft_obj->get_occupancy(used, size);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(2U, used);
+
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_flow_table.ti_12_table_switch
+ * @brief
+ *    Check cut-over from active to shadow flow table by parent miss and parent rule.
+ * @details
+ */
+TEST_F(dpcp_flow_table, ti_12_table_switch)
+{
+    status ret = DPCP_OK;
+
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    flow_table_attr ft_attr;
+    ft_attr.level = 2;
+    ft_attr.log_size = 4;
+    ft_attr.type = flow_table_type::FT_RX;
+    flow_table_switch* ft_switch = nullptr;
+    ret = adapter_obj->create_flow_table_switch(ft_attr, ft_switch);
+    ASSERT_EQ(DPCP_OK, ret);
+    std::shared_ptr<flow_table> ft_active = ft_switch->get_active();
+    ASSERT_NE(nullptr, ft_active);
+
+    flow_table_attr parent_attr;
+    parent_attr.level = 1;
+    parent_attr.log_size = 4;
+    parent_attr.type = flow_table_type::FT_RX;
+    std::shared_ptr<flow_table> ft_parent;
+    ret = adapter_obj->create_flow_table(parent_attr, ft_parent);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = ft_parent->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Commit without shadow or parent is refused.
+    ret = ft_switch->commit();
+    ASSERT_EQ(DPCP_ERR_NOT_APPLIED, ret);
+
+    // Switch by parent table miss.
+    ret = ft_switch->set_parent(ft_parent);
+    ASSERT_EQ(DPCP_OK, ret);
+    std::shared_ptr<flow_table> ft_shadow;
+    ret = ft_switch->get_shadow(ft_shadow);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(ft_active, ft_shadow);
+    ret = ft_switch->commit();
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(ft_shadow, ft_switch->get_active());
+    flow_table_attr attr_out;
+    ret = ft_parent->query(attr_out);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(flow_table_miss_action::FT_MISS_ACTION_FWD, attr_out.def_miss_action);
+    ASSERT_EQ(ft_shadow, attr_out.table_miss);
+    ret = ft_parent->set_table_miss(nullptr);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    // Switch by parent rule forward action, retired table destroyed by engine.
+    flow_group_attr fg_attr;
+    fg_attr.num_flows = 1;
+    fg_attr.match_criteria_enable = flow_group_match_criteria_enable::FG_MATCH_OUTER_HDR;
+    fg_attr.match_criteria.match_lyr2.ethertype = 0xFFFF;
+    std::weak_ptr<flow_group> fg_obj;
+    ret = ft_parent->add_flow_group(fg_attr, fg_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fg_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    flow_action_generator& generator = adapter_obj->get_flow_action_generator();
+    flow_rule_attr_ex fr_attr;
+    fr_attr.flow_index = FLOW_INDEX_AUTO;
+    fr_attr.match_value.match_lyr2.ethertype = 0x800;
+    fr_attr.actions.push_back(generator.create_fwd({ft_switch->get_active().get()}));
+    fr_attr.actions.push_back(generator.create_tag(7));
+    std::weak_ptr<flow_rule_ex> fr_obj;
+    ret = fg_obj.lock()->add_flow_rule(fr_attr, fr_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = fr_obj.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = ft_switch->set_parent(fr_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    ret = ft_switch->get_shadow(ft_shadow);
+    ASSERT_EQ(DPCP_OK, ret);
+    std::weak_ptr<flow_group> shadow_fg;
+    ret = ft_shadow->add_flow_group(fg_attr, shadow_fg);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = shadow_fg.lock()->create();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    cmd_engine* engine = nullptr;
+    ret = adapter_obj->create_cmd_engine(1, engine);
+    ASSERT_EQ(DPCP_OK, ret);
+    ft_active.reset();
+    ret = ft_switch->commit(engine, 5);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(ft_shadow, ft_switch->get_active());
+
+    cmd_completion comp;
+    uint32_t num = 1;
+    struct pollfd pfd = {engine->get_fd(), POLLIN, 0};
+    ASSERT_LT(0, ::poll(&pfd, 1, 1000));
+    ret = engine->poll(&comp, num);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(1U, num);
+    ASSERT_EQ(5U, comp.cookie);
+    ASSERT_EQ(DPCP_OK, comp.ret);
+
+    delete engine;
+    delete ft_switch;
+    delete adapter_obj;
+}
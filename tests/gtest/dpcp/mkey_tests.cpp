@@ -792,3 +792,228 @@ TEST_F(dpcp_mkey, ti_em01_create_extern_key)
     delete[] address;
     delete ad;
 }
+
+/**
+ * @test dpcp_mkey.ti_km01_create_klm
+ * @brief
+ *    Check klm_mkey creation over fragmented buffers
+ * @details
+ *    Different entries sizes use KLM, same page sized ones KSM
+ */
+TEST_F(dpcp_mkey, ti_km01_create_klm)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    size_t length = 4 * 4096;
+    uint8_t* buf = (uint8_t*)aligned_alloc(4096, length);
+    ASSERT_NE(nullptr, buf);
+    direct_mkey* dmk = nullptr;
+    ret = ad->create_direct_mkey(buf, length, MKEY_NONE, dmk);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    klm_mkey_entry entries[3] = {
+        {dmk, buf + 3 * 4096, 100}, {dmk, buf + 100, 1000}, {dmk, buf + 4096, 1}};
+    klm_mkey* kmk = nullptr;
+    ret = ad->create_klm_mkey(nullptr, MKEY_ZERO_BASED, 3, entries, kmk);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_FALSE(kmk->is_ksm());
+
+    size_t len = 0;
+    ASSERT_EQ(DPCP_OK, kmk->get_length(len));
+    ASSERT_EQ(1101U, len);
+    size_t num = 0;
+    ASSERT_EQ(DPCP_OK, kmk->get_mkeys_num(num));
+    ASSERT_EQ(3U, num);
+    uint32_t id = 0;
+    ASSERT_EQ(DPCP_OK, kmk->get_id(id));
+    ASSERT_NE(0U, id);
+    delete kmk;
+
+    klm_mkey_entry pages[2] = {{dmk, buf + 2 * 4096, 4096}, {dmk, buf, 4096}};
+    ret = ad->create_klm_mkey(nullptr, MKEY_ZERO_BASED, 2, pages, kmk);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_TRUE(kmk->is_ksm());
+    delete kmk;
+
+    ret = ad->create_klm_mkey(nullptr, MKEY_ZERO_BASED, 0, pages, kmk);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    delete dmk;
+    free(buf);
+    delete ad;
+}
+
+/**
+ * @test dpcp_mkey.ti_km02_umr_rebind
+ * @brief
+ *    Check klm_mkey translation modification by umr_queue
+ * @details
+ */
+TEST_F(dpcp_mkey, ti_km02_umr_rebind)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    adapter_hca_capabilities caps;
+    ret = ad->get_hca_capabilities(caps);
+    ASSERT_EQ(DPCP_OK, ret);
+    if (!caps.reg_umr_sq) {
+        log_trace("UMR on SQ is not supported\n");
+        delete ad;
+        return;
+    }
+
+    size_t length = 4 * 4096;
+    uint8_t* buf = (uint8_t*)aligned_alloc(4096, length);
+    ASSERT_NE(nullptr, buf);
+    direct_mkey* dmk = nullptr;
+    ret = ad->create_direct_mkey(buf, length, MKEY_NONE, dmk);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    klm_mkey_entry entries[2] = {{dmk, buf, 100}, {dmk, buf + 4096, 200}};
+    klm_mkey* kmk = nullptr;
+    ret = ad->create_klm_mkey(nullptr, (mkey_flags)(MKEY_ZERO_BASED | MKEY_UMR_ENABLED), 2,
+                              entries, kmk);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    umr_queue* uq = nullptr;
+    ret = ad->create_umr_queue(8, uq);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+    ret = ad->create_umr_queue(64, uq);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    klm_mkey_entry remap[3] = {
+        {dmk, buf + 3 * 4096, 300}, {dmk, buf + 2 * 4096, 10}, {dmk, buf + 5, 1}};
+    ret = uq->rebind(*kmk, nullptr, 3, remap, 0x1234);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(0U, uq->get_outstanding());
+
+    uint64_t cookie = 0;
+    uint32_t num = 0;
+    for (int i = 0; i < 1000000 && 0 == num; i++) {
+        num = 1;
+        ret = uq->poll(&cookie, num);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    ASSERT_EQ(1U, num);
+    ASSERT_EQ(0x1234U, cookie);
+    ASSERT_EQ(0U, uq->get_outstanding());
+
+    size_t len = 0;
+    ASSERT_EQ(DPCP_OK, kmk->get_length(len));
+    ASSERT_EQ(311U, len);
+
+    delete uq;
+    delete kmk;
+    delete dmk;
+    free(buf);
+    delete ad;
+}
+
+/**
+ * @test dpcp_mkey.ti_it01_interval_tree
+ * @brief
+ *    Check interval_tree overlap and containment lookup
+ * @details
+ *    Doesn't require device
+ */
+TEST_F(dpcp_mkey, ti_it01_interval_tree)
+{
+    interval_tree tree;
+    int data[64];
+    auto any = [](void*) { return true; };
+
+    // [i * 100, i * 100 + 150) ranges overlapping with neighbours
+    for (int i = 0; i < 64; i++) {
+        ASSERT_EQ(DPCP_OK, tree.insert(i * 100, i * 100 + 150, &data[i]));
+    }
+    ASSERT_EQ(64U, tree.size());
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, tree.insert(10, 10, &data[0]));
+
+    ASSERT_EQ(&data[10], tree.find_containing(1010, 1090, any));
+    ASSERT_EQ(&data[11], tree.find_containing(1110, 1240, any));
+    ASSERT_EQ(nullptr, tree.find_containing(1040, 1160, any));
+    ASSERT_EQ(nullptr, tree.find_containing(6390, 6500, any));
+    ASSERT_EQ(&data[11], tree.find_containing(1120, 1140, [&](void* d) { return d != &data[10]; }));
+
+    std::vector<void*> lst;
+    tree.find_overlapping(1120, 1300, lst);
+    ASSERT_EQ(3U, lst.size());
+    ASSERT_EQ(&data[10], lst[0]);
+    ASSERT_EQ(&data[11], lst[1]);
+    ASSERT_EQ(&data[12], lst[2]);
+
+    for (int i = 0; i < 64; i += 2) {
+        ASSERT_EQ(DPCP_OK, tree.erase(i * 100, &data[i]));
+    }
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, tree.erase(0, &data[0]));
+    ASSERT_EQ(32U, tree.size());
+    ASSERT_EQ(nullptr, tree.find_containing(1010, 1090, any));
+    ASSERT_EQ(&data[11], tree.find_containing(1110, 1240, any));
+    lst.clear();
+    tree.find_overlapping(0, 6400, lst);
+    ASSERT_EQ(32U, lst.size());
+}
+
+/**
+ * @test dpcp_mkey.ti_mc01_mkey_cache
+ * @brief
+ *    Check registration cache returns cached direct_mkey and ref_mkey sub-ranges
+ * @details
+ */
+TEST_F(dpcp_mkey, ti_mc01_mkey_cache)
+{
+    adapter* ad = OpenAdapter();
+    ASSERT_NE(nullptr, ad);
+
+    status ret = ad->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    mkey* mk = nullptr;
+    size_t length = 16384;
+    uint8_t* buf = (uint8_t*)aligned_alloc(4096, length);
+    ASSERT_NE(nullptr, buf);
+
+    ret = ad->get_cached_mkey(buf, length, MKEY_NONE, mk);
+    ASSERT_EQ(DPCP_ERR_NO_CONTEXT, ret);
+    ret = ad->enable_mkey_cache(1);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    mkey* mk_full = nullptr;
+    ret = ad->get_cached_mkey(buf, length, MKEY_NONE, mk_full);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, dynamic_cast<direct_mkey*>(mk_full));
+
+    mkey* mk_sub = nullptr;
+    ret = ad->get_cached_mkey(buf + 100, 1000, MKEY_NONE, mk_sub);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, dynamic_cast<ref_mkey*>(mk_sub));
+
+    uint32_t id_full = 0;
+    uint32_t id_sub = 0;
+    ASSERT_EQ(DPCP_OK, mk_full->get_id(id_full));
+    ASSERT_EQ(DPCP_OK, mk_sub->get_id(id_sub));
+    ASSERT_EQ(id_full, id_sub);
+    void* addr = nullptr;
+    ASSERT_EQ(DPCP_OK, mk_sub->get_address(addr));
+    ASSERT_EQ(buf + 100, addr);
+
+    ASSERT_EQ(DPCP_OK, ad->put_cached_mkey(mk_sub));
+    ASSERT_EQ(DPCP_OK, ad->put_cached_mkey(mk_full));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ad->put_cached_mkey(mk_sub));
+    // Unreferenced key is still cached, extra put is refused
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ad->put_cached_mkey(mk_full));
+
+    ret = ad->invalidate_cached_mkeys(buf, length);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    free(buf);
+    delete ad;
+}
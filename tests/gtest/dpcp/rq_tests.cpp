@@ -325,3 +325,86 @@ TEST_F(dpcp_rq, ti_17_create_striding_rq_attr_api)
     delete s_ad;
 }
 
+class dpcp_striding_rq_iterator : public dpcp_base {
+};
+
+/**
+ * @test dpcp_striding_rq_iterator.ti_01_recycle
+ * @brief
+ *    Check striding_rq_iterator reposts WQE only when all its strides are released
+ * @details
+ */
+TEST_F(dpcp_striding_rq_iterator, ti_01_recycle)
+{
+    const uint32_t wqe_num = 4;
+    const uint32_t stride_num = 8;
+    const uint32_t stride_sz = 64;
+    static uint8_t strides_buf[wqe_num * stride_num * stride_sz];
+    uint32_t dbrec = 0;
+    striding_rq_iterator it;
+    striding_rq_pkt pkts[2];
+    cq_completion comp = {};
+
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, it.init(&dbrec, 3, stride_num, stride_sz, strides_buf));
+    ASSERT_EQ(DPCP_OK, it.init(&dbrec, wqe_num, stride_num, stride_sz, strides_buf));
+    ASSERT_EQ(wqe_num, swap_be32(dbrec));
+
+    // Packet of 100 bytes in strides 0-1 of WQE 0
+    comp.opcode = CQE_OPCODE_RESP_SEND;
+    comp.wqe_id = 0;
+    comp.wqe_counter = 0;
+    comp.byte_cnt = (2 << CQE_STRIDES_SHIFT) | 100;
+    ASSERT_TRUE(it.next(comp, pkts[0]));
+    ASSERT_EQ(strides_buf, pkts[0].data);
+    ASSERT_EQ(100U, pkts[0].len);
+
+    // Packet in strides 2-6 of WQE 0
+    comp.wqe_counter = 2;
+    comp.byte_cnt = (5 << CQE_STRIDES_SHIFT) | 300;
+    ASSERT_TRUE(it.next(comp, pkts[1]));
+    ASSERT_EQ(strides_buf + 2 * stride_sz, pkts[1].data);
+    ASSERT_EQ(7U, it.get_held_strides(0));
+
+    // Filler CQE consumes the rest of WQE 0
+    comp.wqe_counter = 7;
+    comp.byte_cnt = CQE_MPRQ_FILLER | (1 << CQE_STRIDES_SHIFT);
+    ASSERT_FALSE(it.next(comp, pkts[0]));
+
+    it.release(pkts[1]);
+    ASSERT_EQ(0U, it.get_reposted());
+    it.release(pkts[0]);
+    ASSERT_EQ(1U, it.get_reposted());
+    ASSERT_EQ(wqe_num + 1, swap_be32(dbrec));
+}
+
+class dpcp_rq_poster : public dpcp_base {
+};
+
+/**
+ * @test dpcp_rq_poster.ti_01_batch
+ * @brief
+ *    Check rq_poster updates DoorBell record once per batch
+ * @details
+ */
+TEST_F(dpcp_rq_poster, ti_01_batch)
+{
+    const uint32_t wqe_num = 4;
+    const uint32_t stride_sz = 32;
+    static uint8_t wq_buf[wqe_num * stride_sz];
+    uint32_t dbrec = 0;
+    rq_poster rp;
+
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, rp.init(wq_buf, wqe_num, 0, &dbrec));
+    ASSERT_EQ(DPCP_OK, rp.init(wq_buf, wqe_num, stride_sz, &dbrec, 2));
+
+    ASSERT_EQ(wq_buf, rp.get_wqe());
+    rp.post();
+    ASSERT_EQ(0U, dbrec);
+    ASSERT_EQ(wq_buf + stride_sz, rp.get_wqe());
+    rp.post();
+    ASSERT_EQ(2U, swap_be32(dbrec));
+    rp.post();
+    rp.flush();
+    ASSERT_EQ(3U, swap_be32(dbrec));
+    ASSERT_EQ(wq_buf, rp.get_wqe(1));
+}
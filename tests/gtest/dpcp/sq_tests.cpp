@@ -35,6 +35,8 @@
 
 #include "dpcp_base.h"
 
+#include <thread>
+
 using namespace dpcp;
 
 static sq_attr s_sqattr;
@@ -304,3 +306,272 @@ TEST_F(dpcp_sq, ti_11_create_modify_pp)
     delete s_tis;
     delete s_ad;
 }
+
+class dpcp_sq_poster : public dpcp_base {
+};
+
+/**
+ * @test dpcp_sq_poster.ti_01_batch
+ * @brief
+ *    Check sq_poster rings DoorBell once per batch with the last WQE control segment
+ * @details
+ */
+TEST_F(dpcp_sq_poster, ti_01_batch)
+{
+    const uint32_t wqebb_num = 8;
+    static uint64_t wq_buf[wqebb_num * SEND_WQE_BB / sizeof(uint64_t)];
+    uint32_t dbrec[2] = {};
+    uint64_t bf_reg = 0;
+    sq_poster sp;
+
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, sp.init(wq_buf, 6, dbrec + 1, &bf_reg, 4));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, sp.init(wq_buf, wqebb_num, dbrec + 1, &bf_reg, 0));
+    ASSERT_EQ(DPCP_OK, sp.init(wq_buf, wqebb_num, dbrec + 1, &bf_reg, 3));
+
+    for (uint64_t i = 0; i < 2; i++) {
+        *(uint64_t*)sp.get_wqe() = i + 1;
+        sp.post();
+    }
+    // WQE of 2 WQEBBs completes the batch
+    *(uint64_t*)sp.get_wqe() = 3;
+    sp.post(2);
+    ASSERT_EQ(0U, sp.get_pending());
+    ASSERT_EQ(4U, swap_be32(dbrec[1]));
+    ASSERT_EQ(3U, bf_reg);
+    ASSERT_EQ(0U, dbrec[0]);
+
+    // Partial batch stays pending until flush
+    *(uint64_t*)sp.get_wqe() = 4;
+    sp.post();
+    ASSERT_EQ(1U, sp.get_pending());
+    ASSERT_EQ(4U, swap_be32(dbrec[1]));
+    sp.flush();
+    ASSERT_EQ(5U, swap_be32(dbrec[1]));
+    ASSERT_EQ(4U, bf_reg);
+    ASSERT_EQ(wq_buf + 5 * SEND_WQE_BB / sizeof(uint64_t), sp.get_wqe());
+
+    // Wrap around the ring
+    for (uint64_t i = 0; i < 3; i++) {
+        sp.post();
+    }
+    ASSERT_EQ(wq_buf, sp.get_wqe());
+}
+
+/**
+ * @test dpcp_sq_poster.ti_02_flush_timeout
+ * @brief
+ *    Check flush_expired() rings DoorBell for stale partial batch only
+ * @details
+ */
+TEST_F(dpcp_sq_poster, ti_02_flush_timeout)
+{
+    const uint32_t wqebb_num = 8;
+    static uint64_t wq_buf[wqebb_num * SEND_WQE_BB / sizeof(uint64_t)];
+    uint32_t dbrec = 0;
+    uint64_t bf_reg = 0;
+    sq_poster sp;
+
+    ASSERT_EQ(DPCP_OK, sp.init(wq_buf, wqebb_num, &dbrec, &bf_reg, 4, 1000));
+    sp.flush_expired();
+    ASSERT_EQ(0U, dbrec);
+
+    sp.post();
+    sp.flush_expired();
+    ASSERT_EQ(1U, sp.get_pending());
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    sp.flush_expired();
+    ASSERT_EQ(0U, sp.get_pending());
+    ASSERT_EQ(1U, swap_be32(dbrec));
+}
+
+/**
+ * @test dpcp_sq_poster.ti_03_eth_wqe
+ * @brief
+ *    Check eth_wqe_builder layout with inline L2 header, checksum and VLAN insertion
+ * @details
+ */
+TEST_F(dpcp_sq_poster, ti_03_eth_wqe)
+{
+    const uint32_t wqebb_num = 4;
+    static uint64_t wq_buf[wqebb_num * SEND_WQE_BB / sizeof(uint64_t)];
+    uint32_t dbrec = 0;
+    uint64_t bf_reg = 0;
+    sq_poster sp;
+    eth_wqe_builder<ETH_WQE_INLINE_L2 | ETH_WQE_CSUM | ETH_WQE_VLAN_INSERT> vlan_wqe;
+    eth_wqe_builder<ETH_WQE_INLINE_L2> plain_wqe;
+    uint8_t pkt[64];
+    eth_wqe_sge sge[2] = {{(uintptr_t)pkt, sizeof(pkt), 0x11}, {0x1000, 100, 0x22}};
+    eth_wqe_desc desc = {sge, 2, 0x123, true};
+
+    for (uint32_t i = 0; i < sizeof(pkt); i++) {
+        pkt[i] = (uint8_t)i;
+    }
+    ASSERT_EQ(DPCP_OK, sp.init(wq_buf, wqebb_num, &dbrec, &bf_reg));
+    vlan_wqe.init(0x55);
+    plain_wqe.init(0x55);
+    ASSERT_EQ(2U, vlan_wqe.get_max_wqebb_num(2));
+
+    // ctrl, eth, inline header and 2 data segments
+    ASSERT_EQ(2U, vlan_wqe.post(sp, desc));
+    wqe_ctrl_seg* cseg = (wqe_ctrl_seg*)wq_buf;
+    wqe_eth_seg* eseg = (wqe_eth_seg*)(cseg + 1);
+    uint8_t* inl = (uint8_t*)(eseg + 1);
+    wqe_data_seg* dseg = (wqe_data_seg*)(inl + WQE_DS_SZ);
+    ASSERT_EQ((uint32_t)WQE_OPCODE_SEND, swap_be32(cseg->opmod_idx_opcode));
+    ASSERT_EQ((0x55U << 8) | 5, swap_be32(cseg->qpn_ds));
+    ASSERT_EQ(WQE_CTRL_CQ_UPDATE, cseg->fm_ce_se);
+    ASSERT_EQ(WQE_ETH_L3_CSUM | WQE_ETH_L4_CSUM, eseg->cs_flags);
+    ASSERT_EQ(WQE_ETH_INLINE_HDR_SZ, swap_be16(eseg->inline_hdr_sz));
+    ASSERT_EQ(0, memcmp(eseg->inline_hdr, pkt, 2));
+    ASSERT_EQ(0, memcmp(inl, pkt + 2, 10));
+    ASSERT_EQ(0x81, inl[10]);
+    ASSERT_EQ(0x00, inl[11]);
+    ASSERT_EQ(0x01, inl[12]);
+    ASSERT_EQ(0x23, inl[13]);
+    ASSERT_EQ(0, memcmp(inl + 14, pkt + 12, 2));
+    ASSERT_EQ(sizeof(pkt) - 14, swap_be32(dseg[0].byte_count));
+    ASSERT_EQ((uintptr_t)(pkt + 14), swap_be64(dseg[0].addr));
+    ASSERT_EQ(0x11U, swap_be32(dseg[0].lkey));
+    ASSERT_EQ(100U, swap_be32(dseg[1].byte_count));
+    ASSERT_EQ(0x22U, swap_be32(dseg[1].lkey));
+
+    // Header only packet in the last WQEBB of the ring
+    sp.post();
+    sge[0].len = WQE_ETH_INLINE_HDR_SZ;
+    desc.sge_num = 1;
+    desc.signal = false;
+    ASSERT_EQ(1U, plain_wqe.post(sp, desc));
+    cseg = (wqe_ctrl_seg*)(wq_buf + 3 * SEND_WQE_BB / sizeof(uint64_t));
+    eseg = (wqe_eth_seg*)(cseg + 1);
+    ASSERT_EQ((3U << 8) | WQE_OPCODE_SEND, swap_be32(cseg->opmod_idx_opcode));
+    ASSERT_EQ((0x55U << 8) | 3, swap_be32(cseg->qpn_ds));
+    ASSERT_EQ(0, eseg->cs_flags);
+    ASSERT_EQ(0, memcmp((uint8_t*)(eseg + 1), pkt + 2, WQE_DS_SZ));
+
+    sge[0].len = WQE_ETH_INLINE_HDR_SZ - 1;
+    ASSERT_EQ(0U, plain_wqe.post(sp, desc));
+}
+
+/**
+ * @test dpcp_sq_poster.ti_04_empw
+ * @brief
+ *    Check empw_session packs inlined and pointed packets and splits on limits
+ * @details
+ */
+TEST_F(dpcp_sq_poster, ti_04_empw)
+{
+    const uint32_t wqebb_num = 4;
+    static uint64_t wq_buf[wqebb_num * SEND_WQE_BB / sizeof(uint64_t)];
+    uint32_t dbrec = 0;
+    uint64_t bf_reg = 0;
+    sq_poster sp;
+    empw_session empw;
+    uint8_t pkt[40];
+    eth_wqe_sge small = {(uintptr_t)pkt, 20, 0x11};
+    eth_wqe_sge big = {0x1000, 1000, 0x22};
+
+    for (uint32_t i = 0; i < sizeof(pkt); i++) {
+        pkt[i] = (uint8_t)i;
+    }
+    ASSERT_EQ(DPCP_OK, sp.init(wq_buf, wqebb_num, &dbrec, &bf_reg, 8));
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, empw.init(0x55, 0, 64, true));
+    ASSERT_EQ(DPCP_OK, empw.init(0x55, 3, 64, true));
+    ASSERT_EQ(0U, empw.close(sp));
+
+    // ctrl, eth, 2 DS of inlined packet, 1 DS of pointer
+    ASSERT_TRUE(empw.add(sp, small));
+    ASSERT_TRUE(empw.add(sp, big));
+    ASSERT_TRUE(empw.is_open());
+    ASSERT_EQ(0U, sp.get_pi());
+    ASSERT_EQ(2U, empw.close(sp, true));
+    ASSERT_EQ(2U, sp.get_pi());
+
+    wqe_ctrl_seg* cseg = (wqe_ctrl_seg*)wq_buf;
+    wqe_eth_seg* eseg = (wqe_eth_seg*)(cseg + 1);
+    uint8_t* inl = (uint8_t*)(eseg + 1);
+    wqe_data_seg* dseg = (wqe_data_seg*)(inl + 2 * WQE_DS_SZ);
+    ASSERT_EQ((uint32_t)WQE_OPCODE_ENHANCED_MPSW, swap_be32(cseg->opmod_idx_opcode));
+    ASSERT_EQ((0x55U << 8) | 5, swap_be32(cseg->qpn_ds));
+    ASSERT_EQ(WQE_CTRL_CQ_UPDATE, cseg->fm_ce_se);
+    ASSERT_EQ(WQE_ETH_L3_CSUM | WQE_ETH_L4_CSUM, eseg->cs_flags);
+    ASSERT_EQ(0, eseg->inline_hdr_sz);
+    ASSERT_EQ(20U | (1U << 31), swap_be32(*(uint32_t*)inl));
+    ASSERT_EQ(0, memcmp(inl + 4, pkt, 20));
+    ASSERT_EQ(1000U, swap_be32(dseg->byte_count));
+    ASSERT_EQ(0x22U, swap_be32(dseg->lkey));
+    ASSERT_EQ(0x1000U, swap_be64(dseg->addr));
+
+    // Ring end leaves 8 DS: two inlined packets fill it, third opens new session
+    small.len = sizeof(pkt);
+    ASSERT_TRUE(empw.add(sp, small));
+    ASSERT_TRUE(empw.add(sp, small));
+    ASSERT_TRUE(empw.add(sp, small));
+    ASSERT_EQ(4U, sp.get_pi());
+    cseg = (wqe_ctrl_seg*)(wq_buf + 2 * SEND_WQE_BB / sizeof(uint64_t));
+    ASSERT_EQ((2U << 8) | WQE_OPCODE_ENHANCED_MPSW, swap_be32(cseg->opmod_idx_opcode));
+    ASSERT_EQ((0x55U << 8) | 8, swap_be32(cseg->qpn_ds));
+
+    // Max packets per session
+    ASSERT_TRUE(empw.add(sp, big));
+    ASSERT_TRUE(empw.add(sp, big));
+    ASSERT_EQ(4U, sp.get_pi());
+    ASSERT_TRUE(empw.add(sp, big));
+    ASSERT_EQ(6U, sp.get_pi());
+    ASSERT_EQ(1U, empw.close(sp));
+    ASSERT_EQ(7U, sp.get_pi());
+}
+
+/**
+ * @test dpcp_sq_poster.ti_05_lso
+ * @brief
+ *    Check lso_wqe_builder inlines headers across the ring end and enforces LSO limit
+ * @details
+ */
+TEST_F(dpcp_sq_poster, ti_05_lso)
+{
+    const uint32_t wqebb_num = 4;
+    static uint64_t wq_buf[wqebb_num * SEND_WQE_BB / sizeof(uint64_t)];
+    uint32_t dbrec = 0;
+    uint64_t bf_reg = 0;
+    sq_poster sp;
+    lso_wqe_builder lso;
+    uint8_t hdr[66];
+    eth_wqe_sge sge[2] = {{0x1000, 60000, 0x11}, {0x20000, 6000, 0x22}};
+    lso_wqe_desc desc = {hdr, sizeof(hdr), 1448, sge, 2, true};
+
+    for (uint32_t i = 0; i < sizeof(hdr); i++) {
+        hdr[i] = (uint8_t)i;
+    }
+    ASSERT_EQ(DPCP_OK, sp.init(wq_buf, wqebb_num, &dbrec, &bf_reg));
+    ASSERT_EQ(DPCP_ERR_NO_SUPPORT, lso.init(0x55, 0));
+    ASSERT_EQ(DPCP_OK, lso.init(0x55, 16));
+    ASSERT_EQ(65536U, lso.get_max_msg_sz());
+    ASSERT_EQ(2U, lso.get_wqebb_num(sizeof(hdr), 2));
+
+    // Message exceeds 64KB limit
+    ASSERT_EQ(0U, lso.post(sp, desc));
+
+    // ctrl, eth, 4 DS of headers, 2 data segments, WQE wraps the ring
+    sge[1].len = 1000;
+    sp.post(3);
+    ASSERT_EQ(2U, lso.post(sp, desc));
+    ASSERT_EQ(5U, sp.get_pi());
+
+    wqe_ctrl_seg* cseg = (wqe_ctrl_seg*)(wq_buf + 3 * SEND_WQE_BB / sizeof(uint64_t));
+    wqe_eth_seg* eseg = (wqe_eth_seg*)(cseg + 1);
+    uint8_t* inl = (uint8_t*)(eseg + 1);
+    wqe_data_seg* dseg = (wqe_data_seg*)wq_buf;
+    ASSERT_EQ((3U << 8) | WQE_OPCODE_TSO, swap_be32(cseg->opmod_idx_opcode));
+    ASSERT_EQ((0x55U << 8) | 8, swap_be32(cseg->qpn_ds));
+    ASSERT_EQ(1448, swap_be16(eseg->mss));
+    ASSERT_EQ(sizeof(hdr), swap_be16(eseg->inline_hdr_sz));
+    ASSERT_EQ(WQE_ETH_L3_CSUM | WQE_ETH_L4_CSUM, eseg->cs_flags);
+    ASSERT_EQ(0, memcmp(eseg->inline_hdr, hdr, 2));
+    ASSERT_EQ(0, memcmp(inl, hdr + 2, 2 * WQE_DS_SZ));
+    ASSERT_EQ(0, memcmp(wq_buf, hdr + 2 + 2 * WQE_DS_SZ, sizeof(hdr) - 2 - 2 * WQE_DS_SZ));
+    dseg += 2;
+    ASSERT_EQ(60000U, swap_be32(dseg[0].byte_count));
+    ASSERT_EQ(0x1000U, swap_be64(dseg[0].addr));
+    ASSERT_EQ(1000U, swap_be32(dseg[1].byte_count));
+    ASSERT_EQ(0x22U, swap_be32(dseg[1].lkey));
+}
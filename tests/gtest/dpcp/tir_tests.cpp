@@ -28,6 +28,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <poll.h>
+
 #include "common/def.h"
 #include "common/log.h"
 #include "common/sys.h"
@@ -491,3 +493,384 @@ TEST_F(dpcp_tir, ti_09_create_nvmeotcp)
     ASSERT_EQ(tir_attr.nvmeotcp.crc_en, crc_en ? 1U : 0U);
     ASSERT_EQ(tir_attr.nvmeotcp.zerocopy_en, zerocopy_en ? 1U : 0U);
 }
+
+/**
+ * @test dpcp_tir.ti_10_create_async
+ * @brief
+ *    Check tir::create_async and obj::query_async methods
+ * @details
+ *    TIRs are created by workers of cmd_engine and queried over
+ *    DevX async channel, completions are harvested after poll() on fd.
+ */
+TEST_F(dpcp_tir, ti_10_create_async)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    uint32_t tdn = adapter_obj->get_td();
+    ASSERT_NE(0U, tdn);
+
+    striding_rq* srq_obj = open_str_rq(adapter_obj, m_rqp);
+    ASSERT_NE(nullptr, srq_obj);
+
+    uint32_t rqn = 0;
+    ret = srq_obj->get_id(rqn);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    cmd_engine* engine = nullptr;
+    ret = adapter_obj->create_cmd_engine(2, engine);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(nullptr, engine);
+    ASSERT_LE(0, engine->get_fd());
+
+    const uint32_t num_tirs = 8;
+    std::vector<std::unique_ptr<tir>> tirs;
+    struct tir::attr tir_attr;
+    memset(&tir_attr, 0, sizeof(tir_attr));
+    tir_attr.flags = TIR_ATTR_INLINE_RQN | TIR_ATTR_TRANSPORT_DOMAIN;
+    tir_attr.inline_rqn = rqn;
+    tir_attr.transport_domain = tdn;
+    for (uint32_t i = 0; i < num_tirs; i++) {
+        tirs.emplace_back(new tir(adapter_obj->get_ctx()));
+        ret = tirs.back()->create_async(tir_attr, *engine, i);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    ASSERT_GE(num_tirs, engine->get_outstanding());
+
+    cmd_completion comps[num_tirs];
+    std::vector<bool> done(num_tirs, false);
+    uint32_t polled = 0;
+    struct pollfd pfd = {engine->get_fd(), POLLIN, 0};
+    while (polled < num_tirs) {
+        ASSERT_LT(0, ::poll(&pfd, 1, 1000));
+        uint32_t num = num_tirs;
+        ret = engine->poll(comps, num);
+        ASSERT_EQ(DPCP_OK, ret);
+        for (uint32_t i = 0; i < num; i++) {
+            ASSERT_EQ(DPCP_OK, comps[i].ret);
+            ASSERT_GT(num_tirs, comps[i].cookie);
+            done[comps[i].cookie] = true;
+        }
+        polled += num;
+    }
+    ASSERT_EQ(0U, engine->get_outstanding());
+    for (uint32_t i = 0; i < num_tirs; i++) {
+        ASSERT_TRUE(done[i]);
+        ASSERT_NE(0U, tirs[i]->get_tirn());
+    }
+
+    uint32_t in[DEVX_ST_SZ_DW(query_tir_in)] = {0};
+    uint32_t out[DEVX_ST_SZ_DW(query_tir_out)] = {0};
+    DEVX_SET(query_tir_in, in, opcode, MLX5_CMD_OP_QUERY_TIR);
+    DEVX_SET(query_tir_in, in, tirn, tirs[0]->get_tirn());
+    ret = tirs[0]->query_async(in, sizeof(in), out, sizeof(out), *engine, 100);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    uint32_t num = 0;
+    while (0 == num) {
+        ASSERT_LT(0, ::poll(&pfd, 1, 1000));
+        num = 1;
+        ret = engine->poll(comps, num);
+        ASSERT_EQ(DPCP_OK, ret);
+    }
+    ASSERT_EQ(100U, comps[0].cookie);
+    ASSERT_EQ(DPCP_OK, comps[0].ret);
+    void* tir_ctx = DEVX_ADDR_OF(query_tir_out, out, tir_context);
+    ASSERT_EQ(rqn, DEVX_GET(tirc, tir_ctx, inline_rqn));
+    ASSERT_EQ(tdn, DEVX_GET(tirc, tir_ctx, transport_domain));
+
+    delete engine;
+    tirs.clear();
+    delete srq_obj;
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_tir.ti_11_create_rss
+ * @brief
+ *    Check TIR spreading packets by Toeplitz hash over RQT
+ * @details
+ *
+ */
+TEST_F(dpcp_tir, ti_11_create_rss)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    uint32_t tdn = adapter_obj->get_td();
+    ASSERT_NE(0U, tdn);
+
+    const uint32_t num_rqs = 4;
+    std::vector<std::unique_ptr<striding_rq>> srqs;
+    std::vector<uint32_t> rqns;
+    for (uint32_t i = 0; i < num_rqs; i++) {
+        srqs.emplace_back(open_str_rq(adapter_obj, m_rqp));
+        ASSERT_NE(nullptr, srqs.back());
+        uint32_t rqn = 0;
+        ret = srqs.back()->get_id(rqn);
+        ASSERT_EQ(DPCP_OK, ret);
+        rqns.push_back(rqn);
+    }
+
+    rqt* rqt_obj = nullptr;
+    ret = adapter_obj->create_rqt(rqns, rqt_obj, num_rqs * 2);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_NE(0U, rqt_obj->get_rqtn());
+    ASSERT_EQ(num_rqs * 2, rqt_obj->get_max_size());
+
+    std::vector<uint32_t> rqns_out;
+    ret = rqt_obj->query(rqns_out);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rqns, rqns_out);
+
+    struct tir::attr tir_attr;
+    memset(&tir_attr, 0, sizeof(tir_attr));
+    tir_attr.flags = TIR_ATTR_RSS | TIR_ATTR_TRANSPORT_DOMAIN;
+    tir_attr.transport_domain = tdn;
+    tir_attr.rss.indirect_table = rqt_obj->get_rqtn();
+    tir_attr.rss.hash_fn = TIR_HASH_FN_TOEPLITZ;
+    tir_attr.rss.l3_prot_type = TIR_HASH_L3_IPV4;
+    tir_attr.rss.l4_prot_type = TIR_HASH_L4_UDP;
+    tir_attr.rss.selected_fields = TIR_HASH_FIELD_SRC_IP | TIR_HASH_FIELD_DST_IP |
+        TIR_HASH_FIELD_L4_SPORT | TIR_HASH_FIELD_L4_DPORT;
+    for (uint32_t i = 0; i < TIR_TOEPLITZ_KEY_SIZE; i++) {
+        tir_attr.rss.toeplitz_key[i] = i;
+    }
+    tir* tir_obj = nullptr;
+    ret = adapter_obj->create_tir(tir_attr, tir_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+
+    struct tir::attr tir_attr_out;
+    ret = tir_obj->query(tir_attr_out);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_TRUE(tir_attr_out.flags & TIR_ATTR_RSS);
+    ASSERT_EQ(rqt_obj->get_rqtn(), tir_attr_out.rss.indirect_table);
+    ASSERT_EQ(tir_attr.rss.selected_fields, tir_attr_out.rss.selected_fields);
+    ASSERT_EQ(0, memcmp(tir_attr.rss.toeplitz_key, tir_attr_out.rss.toeplitz_key,
+                        sizeof(tir_attr.rss.toeplitz_key)));
+
+    // Grow the table without touching the TIR.
+    rqns.insert(rqns.end(), rqns.begin(), rqns.end());
+    ret = rqt_obj->modify(rqns);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = rqt_obj->query(rqns_out);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rqns, rqns_out);
+    rqns.push_back(rqns[0]);
+    ret = rqt_obj->modify(rqns);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    delete tir_obj;
+    delete rqt_obj;
+    srqs.clear();
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_tir.ti_12_rss_table
+ * @brief
+ *    Check RSS table rebalancing buckets between RQs
+ * @details
+ *
+ */
+TEST_F(dpcp_tir, ti_12_rss_table)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const uint32_t num_rqs = 4;
+    const uint32_t num_buckets = 512;
+    std::vector<std::unique_ptr<striding_rq>> srqs;
+    std::vector<uint32_t> rqns;
+    for (uint32_t i = 0; i < num_rqs; i++) {
+        srqs.emplace_back(open_str_rq(adapter_obj, m_rqp));
+        ASSERT_NE(nullptr, srqs.back());
+        uint32_t rqn = 0;
+        ret = srqs.back()->get_id(rqn);
+        ASSERT_EQ(DPCP_OK, ret);
+        rqns.push_back(rqn);
+    }
+
+    rss_table* table = nullptr;
+    ret = adapter_obj->create_rss_table(rqns, 100, table);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+    ret = adapter_obj->create_rss_table(rqns, num_buckets, table);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(num_buckets, table->get_size());
+    ASSERT_EQ(rqns[1], table->get_bucket_rqn(1));
+
+    // Make the first RQ hot.
+    for (uint32_t i = 0; i < num_buckets; i += num_rqs) {
+        table->add_load(i, 100);
+    }
+    table->add_load(1, 10);
+    std::vector<uint64_t> loads;
+    table->get_rq_loads(loads);
+    ASSERT_EQ(100U * num_buckets / num_rqs, loads[0]);
+    ASSERT_EQ(10U, loads[1]);
+
+    uint32_t moved = 0;
+    ret = table->rebalance(num_buckets, moved);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_LT(0U, moved);
+    std::vector<uint64_t> loads_out;
+    table->get_rq_loads(loads_out);
+    ASSERT_GT(loads[0], loads_out[0]);
+    ASSERT_LT(loads_out[0] - loads_out[3], 200U);
+
+    std::vector<uint32_t> rqns_out;
+    ret = table->get_rqt().query(rqns_out);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(num_buckets, rqns_out.size());
+    for (uint32_t i = 0; i < num_buckets; i++) {
+        ASSERT_EQ(table->get_bucket_rqn(i), rqns_out[i]);
+    }
+
+    std::vector<rss_bucket_move> moves = {{0, rqns[2]}, {5, rqns[3]}};
+    ret = table->move_buckets(moves);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rqns[2], table->get_bucket_rqn(0));
+    ASSERT_EQ(rqns[3], table->get_bucket_rqn(5));
+    moves = {{num_buckets, rqns[0]}};
+    ret = table->move_buckets(moves);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    table->reset_loads();
+    ASSERT_EQ(0U, table->get_bucket_load(0));
+
+    delete table;
+    srqs.clear();
+    delete adapter_obj;
+}
+
+/**
+ * @test dpcp_tir.ti_13_toeplitz_hash
+ * @brief
+ *    Check software Toeplitz hash against RSS verification vectors
+ * @details
+ *
+ */
+TEST_F(dpcp_tir, ti_13_toeplitz_hash)
+{
+    const uint8_t key[TIR_TOEPLITZ_KEY_SIZE] = {
+        0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2, 0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3,
+        0x8f, 0xb0, 0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4, 0x77, 0xcb, 0x2d, 0xa3,
+        0x80, 0x30, 0xf2, 0x0c, 0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa};
+    const uint8_t tuple[12] = {66, 9, 149, 187, 161, 142, 100, 80, 0x0a, 0xea, 0x06, 0xe6};
+    const uint32_t all_fields = TIR_HASH_FIELD_SRC_IP | TIR_HASH_FIELD_DST_IP |
+        TIR_HASH_FIELD_L4_SPORT | TIR_HASH_FIELD_L4_DPORT;
+
+    toeplitz_hash th;
+    status ret = th.init(key, 4);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+    ret = th.init(key);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(36U, th.get_max_len());
+
+    ASSERT_EQ(0x51ccc178U, toeplitz_hash::hash_generic(key, sizeof(key), tuple, 12));
+    ASSERT_EQ(0x323e8fc2U, toeplitz_hash::hash_generic(key, sizeof(key), tuple, 8));
+    ASSERT_EQ(0x51ccc178U, th.hash_lut(tuple, 12));
+    ASSERT_EQ(0x323e8fc2U, th.hash_lut(tuple, 8));
+    ASSERT_EQ(0x51ccc178U, th.hash(tuple, 12));
+    ASSERT_EQ(0x323e8fc2U, th.hash(tuple, 8));
+
+    uint32_t src_ip = htonl(0xc75c6f02); // 199.92.111.2
+    uint32_t dst_ip = htonl(0x41458c53); // 65.69.140.83
+    ASSERT_EQ(0xc626b0eaU, th.hash_ipv4(src_ip, dst_ip, htons(14230), htons(4739), all_fields));
+    ASSERT_EQ(0xd718262aU,
+              th.hash_ipv4(src_ip, dst_ip, 0, 0, TIR_HASH_FIELD_SRC_IP | TIR_HASH_FIELD_DST_IP));
+
+    // Accelerated and table paths agree for every length
+    uint8_t data[36];
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 37 + 11);
+    }
+    for (size_t len = 0; len <= sizeof(data); len++) {
+        uint32_t expected = toeplitz_hash::hash_generic(key, sizeof(key), data, len);
+        ASSERT_EQ(expected, th.hash_lut(data, len));
+        ASSERT_EQ(expected, th.hash(data, len));
+    }
+
+    uint8_t sym_key[TIR_TOEPLITZ_KEY_SIZE];
+    toeplitz_hash::make_symmetric_key(sym_key);
+    ret = th.init(sym_key);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(th.hash_ipv4(src_ip, dst_ip, htons(14230), htons(4739), all_fields),
+              th.hash_ipv4(dst_ip, src_ip, htons(4739), htons(14230), all_fields));
+    uint8_t src_ip6[16];
+    uint8_t dst_ip6[16];
+    memcpy(src_ip6, data, 16);
+    memcpy(dst_ip6, data + 16, 16);
+    ASSERT_EQ(th.hash_ipv6(src_ip6, dst_ip6, htons(80), htons(5000), all_fields),
+              th.hash_ipv6(dst_ip6, src_ip6, htons(5000), htons(80), all_fields));
+}
+
+/**
+ * @test dpcp_tir.ti_14_rqt_size
+ * @brief
+ *    Check RQT size is rounded up to a power of 2
+ * @details
+ *    RQ numbers are repeated up to the table size.
+ */
+TEST_F(dpcp_tir, ti_14_rqt_size)
+{
+    adapter* adapter_obj = OpenAdapter();
+    ASSERT_NE(nullptr, adapter_obj);
+
+    status ret = adapter_obj->open();
+    ASSERT_EQ(DPCP_OK, ret);
+
+    const uint32_t num_rqs = 3;
+    std::vector<std::unique_ptr<striding_rq>> srqs;
+    std::vector<uint32_t> rqns;
+    for (uint32_t i = 0; i < num_rqs; i++) {
+        srqs.emplace_back(open_str_rq(adapter_obj, m_rqp));
+        ASSERT_NE(nullptr, srqs.back());
+        uint32_t rqn = 0;
+        ret = srqs.back()->get_id(rqn);
+        ASSERT_EQ(DPCP_OK, ret);
+        rqns.push_back(rqn);
+    }
+
+    rqt* rqt_obj = nullptr;
+    ret = adapter_obj->create_rqt(rqns, rqt_obj, RQT_MAX_SIZE + 1);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    ret = adapter_obj->create_rqt(rqns, rqt_obj);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(4U, rqt_obj->get_max_size());
+
+    std::vector<uint32_t> rqns_out;
+    ret = rqt_obj->query(rqns_out);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(4U, rqns_out.size());
+    for (uint32_t i = 0; i < rqns_out.size(); i++) {
+        ASSERT_EQ(rqns[i % num_rqs], rqns_out[i]);
+    }
+
+    // Two RQs fill the table without repeating.
+    rqns.pop_back();
+    ret = rqt_obj->modify(rqns);
+    ASSERT_EQ(DPCP_OK, ret);
+    ret = rqt_obj->query(rqns_out);
+    ASSERT_EQ(DPCP_OK, ret);
+    ASSERT_EQ(rqns, rqns_out);
+
+    rqns.insert(rqns.end(), rqns.begin(), rqns.end());
+    rqns.push_back(rqns[0]);
+    ret = rqt_obj->modify(rqns);
+    ASSERT_EQ(DPCP_ERR_INVALID_PARAM, ret);
+
+    delete rqt_obj;
+    srqs.clear();
+    delete adapter_obj;
+}